@@ -283,6 +283,11 @@ def _add_output_arguments(parser: argparse.ArgumentParser) -> None:
         type=_directory_exists,
         help="Save generated models to this directory.",
     )
+    output_arguments.add_argument(
+        "--stream-issues",
+        action="store_true",
+        help="Write issues to separate `issues@*.json` files instead of with the models.",
+    )
 
 
 def _add_binary_arguments(parser: argparse.ArgumentParser) -> None:
@@ -333,6 +338,12 @@ def _add_configuration_arguments(parser: argparse.ArgumentParser) -> None:
         default=None,
         help="A `;`-separated list of directories that should be excluded from indexed source files.",
     )
+    configuration_arguments.add_argument(
+        "--source-index-path",
+        type=str,
+        default=None,
+        help="Path to a file used to persist the source index across runs. Only new or modified source files are indexed again.",
+    )
     configuration_arguments.add_argument(
         "--proguard-configuration-paths",
         type=_separated_paths_exist,
@@ -401,6 +412,29 @@ def _add_analysis_arguments(parser: argparse.ArgumentParser) -> None:
         type=int,
         help="Specify number of seconds as a bound. If the analysis of a method takes longer than this then make the method obscure (default taint-in-taint-out).",
     )
+    analysis_arguments.add_argument(
+        "--rules-filter",
+        nargs="+",
+        type=int,
+        help="Only report issues for the given rule codes. Methods that cannot carry taint for these rules are not analyzed.",
+    )
+    analysis_arguments.add_argument(
+        "--memory-limit",
+        type=float,
+        help="Memory available to the analysis, in GB (default: total physical memory). The analysis reduces its precision when getting close to this limit.",
+    )
+    analysis_arguments.add_argument(
+        "--daemon-socket",
+        type=str,
+        default=None,
+        help="Keep the program in memory and serve analysis requests on the given unix domain socket instead of analyzing once.",
+    )
+    analysis_arguments.add_argument(
+        "--preprocessing-snapshot-directory",
+        type=_directory_exists,
+        default=None,
+        help="Cache the class hierarchies, overrides and types in the given directory and restore them on later runs on the same inputs.",
+    )
 
 
 def _add_metadata_arguments(parser: argparse.ArgumentParser) -> None:
@@ -463,6 +497,23 @@ def _add_debug_arguments(parser: argparse.ArgumentParser) -> None:
         action="store_true",
         help="Dump a list of the method signatures in `methods.json`.",
     )
+    debug_arguments.add_argument(
+        "--replay-snapshot-method",
+        action="append",
+        metavar="PATTERN",
+        help="Save the inputs of the analysis of the given methods in the `replay` output directory.",
+    )
+    debug_arguments.add_argument(
+        "--replay-snapshot-slow-methods",
+        action="store_true",
+        help="Save the inputs of the analysis of slow methods in the `replay` output directory.",
+    )
+    debug_arguments.add_argument(
+        "--replay-snapshot",
+        type=_path_exists,
+        default=None,
+        help="Only re-run the analysis of the method saved in the given replay snapshot.",
+    )
 
 
 def _get_command_options(
@@ -507,10 +558,17 @@ def _get_command_options(
         options.append("--source-exclude-directories")
         options.append(arguments.source_exclude_directories)
 
+    if arguments.source_index_path:
+        options.append("--source-index-path")
+        options.append(arguments.source_index_path)
+
     if arguments.generated_models_directory:
         options.append("--generated-models-directory")
         options.append(arguments.generated_models_directory)
 
+    if arguments.stream_issues:
+        options.append("--stream-issues")
+
     if arguments.sequential:
         options.append("--sequential")
     if arguments.skip_source_indexing:
@@ -524,6 +582,20 @@ def _get_command_options(
     if arguments.maximum_method_analysis_time is not None:
         options.append("--maximum-method-analysis-time")
         options.append(str(arguments.maximum_method_analysis_time))
+    if arguments.rules_filter:
+        options.append("--rules-filter")
+        options.extend(str(code) for code in arguments.rules_filter)
+    if arguments.memory_limit is not None:
+        options.append("--memory-limit")
+        options.append(str(arguments.memory_limit))
+    if arguments.daemon_socket:
+        options.append("--daemon-socket")
+        options.append(os.path.abspath(arguments.daemon_socket))
+    if arguments.preprocessing_snapshot_directory:
+        options.append("--preprocessing-snapshot-directory")
+        options.append(
+            os.path.abspath(arguments.preprocessing_snapshot_directory)
+        )
 
     if arguments.job_id:
         options.append("--job-id")
@@ -550,6 +622,14 @@ def _get_command_options(
         options.append("--dump-dependencies")
     if arguments.dump_methods:
         options.append("--dump-methods")
+    if arguments.replay_snapshot_method:
+        for method in arguments.replay_snapshot_method:
+            options.append("--replay-snapshot-method=%s" % method.strip())
+    if arguments.replay_snapshot_slow_methods:
+        options.append("--replay-snapshot-slow-methods")
+    if arguments.replay_snapshot:
+        options.append("--replay-snapshot")
+        options.append(arguments.replay_snapshot)
 
     return options
 
@@ -275,7 +275,7 @@ class AbstractTreeDomain final
       widen_with_internal(
           other,
           Elements::bottom(),
-          /* max_height */ Heuristics::kAbstractTreeWideningHeight);
+          /* max_height */ Heuristics::abstract_tree_widening_height());
     }
 
     mt_expensive_assert(previous.leq(*this) && other.leq(*this));
@@ -259,6 +259,15 @@ class AccessPathTreeDomain final
     });
   }
 
+  /* Collapse the trees to the given maximum height. */
+  void collapse_deeper_than(std::size_t height) {
+    map_.map([=](const AbstractTreeDomainT& tree) {
+      auto copy = tree;
+      copy.collapse_deeper_than(height);
+      return copy;
+    });
+  }
+
   friend std::ostream& operator<<(
       std::ostream& out,
       const AccessPathTreeDomain& tree) {
@@ -35,12 +35,15 @@ std::vector<Model> ArtificialMethods::models(Context& context) const {
 
   {
     auto* method = context.methods->get(array_allocation_method_);
-    auto model = Model(method, context);
-    model.add_mode(Model::Mode::SkipAnalysis, context);
-    model.add_sink(
-        AccessPath(Root(Root::Kind::Argument, 0)),
-        Frame::leaf(array_allocation_kind_));
-    models.push_back(model);
+    models.push_back(Model(
+        method,
+        context,
+        Model::Mode::SkipAnalysis,
+        /* generations */ {},
+        /* parameter_sources */ {},
+        /* sinks */
+        {{AccessPath(Root(Root::Kind::Argument, 0)),
+          Frame::leaf(array_allocation_kind_)}}));
   }
 
   return models;
@@ -5,6 +5,8 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <memory>
+
 #include <Show.h>
 #include <Walkers.h>
 
@@ -123,4 +125,24 @@ Json::Value ClassHierarchies::to_json() const {
   return value;
 }
 
+std::unique_ptr<ClassHierarchies> ClassHierarchies::from_json(
+    const Json::Value& value) {
+  // The constructor is private, hence `std::make_unique` cannot be used.
+  auto class_hierarchies =
+      std::unique_ptr<ClassHierarchies>(new ClassHierarchies());
+
+  const auto& extends_value = JsonValidation::object(value, "extends");
+  for (auto iterator = extends_value.begin(); iterator != extends_value.end();
+       ++iterator) {
+    const auto* klass = JsonValidation::dex_type(Json::Value(iterator.name()));
+    auto extends = std::make_unique<std::unordered_set<const DexType*>>();
+    for (const auto& extend : JsonValidation::null_or_array(*iterator)) {
+      extends->insert(JsonValidation::dex_type(extend));
+    }
+    class_hierarchies->extends_.emplace(klass, std::move(extends));
+  }
+
+  return class_hierarchies;
+}
+
 } // namespace marianatrench
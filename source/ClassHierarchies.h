@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <memory>
 #include <unordered_set>
 
 #include <json/json.h>
@@ -35,7 +36,12 @@ class ClassHierarchies final {
 
   Json::Value to_json() const;
 
+  /* Restore class hierarchies from the output of `to_json`. */
+  static std::unique_ptr<ClassHierarchies> from_json(const Json::Value& value);
+
  private:
+  ClassHierarchies() = default;
+
   UniquePointerConcurrentMap<const DexType*, std::unordered_set<const DexType*>>
       extends_;
   std::unordered_set<const DexType*> empty_type_set_;
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <limits>
+
+#include <mariana-trench/Assert.h>
+#include <mariana-trench/CollapsedTaint.h>
+
+namespace marianatrench {
+
+namespace {
+
+bool requires_callsite_materialization(const Frame& frame) {
+  return frame.is_crtex_producer_declaration() ||
+      (frame.via_type_of_ports().is_value() &&
+       !frame.via_type_of_ports().elements().empty()) ||
+      (frame.via_value_of_ports().is_value() &&
+       !frame.via_value_of_ports().elements().empty());
+}
+
+} // namespace
+
+CollapsedTaint::CollapsedTaint(
+    const Taint& taint,
+    int maximum_source_sink_distance)
+    : maximum_source_sink_distance_(maximum_source_sink_distance) {
+  FramesByKind frames_by_kind;
+  for (const auto& frame : taint.frames_iterator()) {
+    frames_by_kind[frame.kind()].push_back(std::cref(frame));
+  }
+  collapse(frames_by_kind);
+}
+
+CollapsedTaint::CollapsedTaint(
+    const Frame* begin,
+    const Frame* end,
+    int maximum_source_sink_distance)
+    : maximum_source_sink_distance_(maximum_source_sink_distance) {
+  FramesByKind frames_by_kind;
+  for (const auto* frame = begin; frame != end; ++frame) {
+    frames_by_kind[frame->kind()].push_back(std::cref(*frame));
+  }
+  collapse(frames_by_kind);
+}
+
+void CollapsedTaint::collapse(const FramesByKind& frames_by_kind) {
+  for (const auto& [kind, frames] : frames_by_kind) {
+    bool materialize = std::any_of(
+        frames.begin(), frames.end(), [](const Frame& frame) {
+          return requires_callsite_materialization(frame);
+        });
+    if (materialize) {
+      for (const Frame& frame : frames) {
+        uncollapsed_.add(frame);
+      }
+      continue;
+    }
+
+    // See `CallPositionFrames::propagate_frames`.
+    int distance = std::numeric_limits<int>::max();
+    auto origins = MethodSet::bottom();
+    auto field_origins = FieldSet::bottom();
+    auto inferred_features = FeatureMayAlwaysSet::bottom();
+
+    for (const Frame& frame : frames) {
+      if (frame.distance() >= maximum_source_sink_distance) {
+        continue;
+      }
+
+      distance = std::min(distance, frame.distance() + 1);
+      origins.join_with(frame.origins());
+      field_origins.join_with(frame.field_origins());
+
+      // Note: This merges user features with existing inferred features.
+      inferred_features.join_with(frame.features());
+    }
+
+    if (distance == std::numeric_limits<int>::max()) {
+      continue;
+    }
+
+    mt_assert(distance <= maximum_source_sink_distance);
+    frames_.push_back(CollapsedFrame{
+        kind,
+        distance,
+        std::move(origins),
+        std::move(field_origins),
+        std::move(inferred_features)});
+  }
+}
+
+Taint CollapsedTaint::propagate(
+    const Method* callee,
+    const AccessPath& callee_port,
+    const Position* call_position,
+    const FeatureMayAlwaysSet& extra_features,
+    Context& context,
+    const std::vector<const DexType * MT_NULLABLE>& source_register_types,
+    const std::vector<std::optional<std::string>>& source_constant_arguments)
+    const {
+  Taint result;
+
+  if (!uncollapsed_.is_bottom()) {
+    result = uncollapsed_.propagate(
+        callee,
+        callee_port,
+        call_position,
+        maximum_source_sink_distance_,
+        extra_features,
+        context,
+        source_register_types,
+        source_constant_arguments);
+  }
+
+  for (const auto& collapsed : frames_) {
+    auto frame = Frame(
+        collapsed.kind,
+        callee_port,
+        callee,
+        /* field_callee */ nullptr,
+        call_position,
+        collapsed.distance,
+        collapsed.origins,
+        collapsed.field_origins,
+        collapsed.inferred_features,
+        /* locally_inferred_features */ FeatureMayAlwaysSet::bottom(),
+        /* user_features */ FeatureSet::bottom(),
+        /* via_type_of_ports */ {},
+        /* via_value_of_ports */ {},
+        /* local_positions */ {},
+        /* canonical_names */ {});
+    if (!extra_features.empty()) {
+      frame.add_inferred_features(extra_features);
+    }
+    result.add(frame);
+  }
+
+  return result;
+}
+
+} // namespace marianatrench
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <mariana-trench/Access.h>
+#include <mariana-trench/Compiler.h>
+#include <mariana-trench/Context.h>
+#include <mariana-trench/FeatureMayAlwaysSet.h>
+#include <mariana-trench/FieldSet.h>
+#include <mariana-trench/Kind.h>
+#include <mariana-trench/Method.h>
+#include <mariana-trench/MethodSet.h>
+#include <mariana-trench/Position.h>
+#include <mariana-trench/Taint.h>
+
+namespace marianatrench {
+
+/**
+ * A caller-independent summary of the taint on a single port of a callee.
+ *
+ * When propagating taint to a call site, all frames with the same kind are
+ * collapsed into a single frame. The distance, origins, field origins and
+ * features of that frame only depend on the callee, so we compute them once
+ * per model instead of once per call site. `propagate` then only stamps in the
+ * call-site specific parts (call position and extra features).
+ *
+ * Frames that require call-site specific materialization (i.e via-type-of,
+ * via-value-of or crtex producer declarations) are kept as-is and go through
+ * `Taint::propagate`, together with all frames sharing their kind.
+ */
+class CollapsedTaint final {
+ private:
+  struct CollapsedFrame {
+    const Kind* kind;
+    int distance;
+    MethodSet origins;
+    FieldSet field_origins;
+    FeatureMayAlwaysSet inferred_features;
+  };
+
+  using FramesByKind = std::unordered_map<
+      const Kind*,
+      std::vector<std::reference_wrapper<const Frame>>>;
+
+ public:
+  /* Create the empty collapsed taint. */
+  CollapsedTaint() : maximum_source_sink_distance_(0) {}
+
+  explicit CollapsedTaint(const Taint& taint, int maximum_source_sink_distance);
+
+  /* Collapse the frames in `[begin, end)`, see `FrozenModel`. */
+  explicit CollapsedTaint(
+      const Frame* begin,
+      const Frame* end,
+      int maximum_source_sink_distance);
+
+  CollapsedTaint(const CollapsedTaint&) = default;
+  CollapsedTaint(CollapsedTaint&&) = default;
+  CollapsedTaint& operator=(const CollapsedTaint&) = default;
+  CollapsedTaint& operator=(CollapsedTaint&&) = default;
+  ~CollapsedTaint() = default;
+
+  bool empty() const {
+    return frames_.empty() && uncollapsed_.is_bottom();
+  }
+
+  /* Number of collapsed (i.e, one per kind) frames. */
+  std::size_t size() const {
+    return frames_.size();
+  }
+
+  /* Whether some frames need to be materialized at each call site. */
+  bool needs_materialization() const {
+    return !uncollapsed_.is_bottom();
+  }
+
+  /**
+   * Propagate the taint from the callee to the caller.
+   *
+   * This is equivalent to `Taint::propagate` on the original taint.
+   */
+  Taint propagate(
+      const Method* callee,
+      const AccessPath& callee_port,
+      const Position* call_position,
+      const FeatureMayAlwaysSet& extra_features,
+      Context& context,
+      const std::vector<const DexType * MT_NULLABLE>& source_register_types,
+      const std::vector<std::optional<std::string>>& source_constant_arguments)
+      const;
+
+ private:
+  void collapse(const FramesByKind& frames_by_kind);
+
+ private:
+  std::vector<CollapsedFrame> frames_;
+  Taint uncollapsed_;
+  int maximum_source_sink_distance_;
+};
+
+} // namespace marianatrench
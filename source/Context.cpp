@@ -14,6 +14,7 @@
 #include <mariana-trench/Features.h>
 #include <mariana-trench/FieldCache.h>
 #include <mariana-trench/Fields.h>
+#include <mariana-trench/IssueStore.h>
 #include <mariana-trench/Kinds.h>
 #include <mariana-trench/Methods.h>
 #include <mariana-trench/Options.h>
@@ -23,6 +24,7 @@
 #include <mariana-trench/Scheduler.h>
 #include <mariana-trench/Statistics.h>
 #include <mariana-trench/Types.h>
+#include <mariana-trench/UnusedKinds.h>
 
 namespace marianatrench {
 
@@ -29,8 +29,10 @@ class FieldCache;
 class Overrides;
 class CallGraph;
 class Rules;
+class UnusedKinds;
 class Dependencies;
 class Scheduler;
+class IssueStore;
 
 /**
  * Mariana Trench global context.
@@ -60,8 +62,10 @@ class Context final {
   std::unique_ptr<Overrides> overrides;
   std::unique_ptr<CallGraph> call_graph;
   std::unique_ptr<Rules> rules;
+  std::unique_ptr<UnusedKinds> unused_kinds;
   std::unique_ptr<Dependencies> dependencies;
   std::unique_ptr<Scheduler> scheduler;
+  std::unique_ptr<IssueStore> issue_store;
 };
 
 } // namespace marianatrench
@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include <mariana-trench/Daemon.h>
+#include <mariana-trench/JsonValidation.h>
+#include <mariana-trench/Log.h>
+
+namespace marianatrench {
+
+namespace {
+
+std::runtime_error system_error(const std::string& operation) {
+  return std::runtime_error(
+      fmt::format("Daemon: {} failed: {}", operation, std::strerror(errno)));
+}
+
+/* The client did not send a complete request in time. */
+class ReadTimeout final : public std::runtime_error {
+ public:
+  ReadTimeout() : std::runtime_error("Daemon: read timed out") {}
+};
+
+/**
+ * Read a line from the connection. The timeout bounds the whole request, so
+ * that a client sending one byte at a time cannot hold the daemon either.
+ */
+std::string read_line(int connection, std::chrono::milliseconds timeout) {
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  std::string line;
+  char buffer[4096];
+  while (true) {
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now());
+    if (remaining.count() <= 0) {
+      throw ReadTimeout();
+    }
+    struct pollfd descriptor = {connection, POLLIN, 0};
+    auto ready = ::poll(&descriptor, 1, static_cast<int>(remaining.count()));
+    if (ready < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw system_error("poll");
+    }
+    if (ready == 0) {
+      throw ReadTimeout();
+    }
+
+    auto size = ::read(connection, buffer, sizeof(buffer));
+    if (size < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw system_error("read");
+    }
+    if (size == 0) {
+      return line;
+    }
+    line.append(buffer, size);
+    auto newline = line.find('\n');
+    if (newline != std::string::npos) {
+      line.resize(newline);
+      return line;
+    }
+  }
+}
+
+void write_line(int connection, const Json::Value& value) {
+  std::string line = JsonValidation::to_styled_string(value);
+  // Responses are a single line.
+  line.erase(std::remove(line.begin(), line.end(), '\n'), line.end());
+  line.push_back('\n');
+
+  std::size_t written = 0;
+  while (written < line.size()) {
+    // Do not raise SIGPIPE if the client went away.
+    auto size = ::send(
+        connection,
+        line.data() + written,
+        line.size() - written,
+        MSG_NOSIGNAL);
+    if (size < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw system_error("send");
+    }
+    written += size;
+  }
+}
+
+Json::Value error_response(const std::string& message) {
+  auto response = Json::Value(Json::objectValue);
+  response["status"] = "error";
+  response["message"] = message;
+  return response;
+}
+
+} // namespace
+
+Daemon::Daemon(
+    std::string socket_path,
+    std::chrono::milliseconds read_timeout)
+    : socket_path_(std::move(socket_path)),
+      read_timeout_(read_timeout),
+      socket_(-1) {
+  struct sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (socket_path_.size() >= sizeof(address.sun_path)) {
+    throw std::invalid_argument(
+        fmt::format("Daemon: socket path `{}` is too long.", socket_path_));
+  }
+  std::strncpy(
+      address.sun_path, socket_path_.c_str(), sizeof(address.sun_path) - 1);
+
+  socket_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (socket_ < 0) {
+    throw system_error("socket");
+  }
+
+  // Remove the socket of a previous daemon that did not shut down properly,
+  // but never anything else that happens to live at the given path.
+  struct stat status;
+  if (::lstat(socket_path_.c_str(), &status) == 0) {
+    if (!S_ISSOCK(status.st_mode)) {
+      ::close(socket_);
+      throw std::invalid_argument(fmt::format(
+          "Daemon: `{}` already exists and is not a socket.", socket_path_));
+    }
+    ::unlink(socket_path_.c_str());
+  } else if (errno != ENOENT) {
+    auto error = system_error("lstat");
+    ::close(socket_);
+    throw error;
+  }
+  if (::bind(
+          socket_,
+          reinterpret_cast<struct sockaddr*>(&address),
+          sizeof(address)) < 0) {
+    auto error = system_error("bind");
+    ::close(socket_);
+    throw error;
+  }
+  // Requests run arbitrary analyses, do not let other users connect.
+  if (::chmod(socket_path_.c_str(), S_IRUSR | S_IWUSR) < 0) {
+    auto error = system_error("chmod");
+    ::close(socket_);
+    ::unlink(socket_path_.c_str());
+    throw error;
+  }
+  if (::listen(socket_, /* backlog */ 16) < 0) {
+    auto error = system_error("listen");
+    ::close(socket_);
+    ::unlink(socket_path_.c_str());
+    throw error;
+  }
+}
+
+Daemon::~Daemon() {
+  ::close(socket_);
+  ::unlink(socket_path_.c_str());
+}
+
+void Daemon::serve(const Handler& handler) {
+  LOG(1, "Listening on `{}`...", socket_path_);
+
+  while (true) {
+    int connection = ::accept(socket_, nullptr, nullptr);
+    if (connection < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw system_error("accept");
+    }
+
+    bool shutdown = false;
+    try {
+      auto request =
+          JsonValidation::parse_json(read_line(connection, read_timeout_));
+      JsonValidation::validate_object(request);
+
+      Json::Value response;
+      if (request.isMember("command") &&
+          JsonValidation::string(request, "command") == "shutdown") {
+        LOG(1, "Shutting down.");
+        response = Json::Value(Json::objectValue);
+        response["status"] = "ok";
+        shutdown = true;
+      } else {
+        try {
+          response = handler(request);
+        } catch (const std::exception& exception) {
+          ERROR(1, "Request failed: {}", exception.what());
+          response = error_response(exception.what());
+        }
+      }
+      write_line(connection, response);
+    } catch (const ReadTimeout&) {
+      WARNING(
+          1,
+          "Dropping client that did not send a request within {}ms.",
+          read_timeout_.count());
+    } catch (const std::exception& exception) {
+      // Invalid request or the client went away, keep serving.
+      ERROR(1, "Unable to process request: {}", exception.what());
+      try {
+        write_line(connection, error_response(exception.what()));
+      } catch (const std::exception&) {
+      }
+    }
+    ::close(connection);
+
+    if (shutdown) {
+      return;
+    }
+  }
+}
+
+} // namespace marianatrench
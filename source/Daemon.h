@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <string>
+
+#include <json/json.h>
+
+namespace marianatrench {
+
+/**
+ * A server listening on a unix domain socket, used to keep the analyzed
+ * program in memory between runs.
+ *
+ * Clients connect, send a single json object terminated by a newline and
+ * receive a single json object terminated by a newline. A request of the form
+ * `{"command": "shutdown"}` stops the server. Other requests are forwarded to
+ * the handler. If the handler throws, the response is
+ * `{"status": "error", "message": ...}`.
+ *
+ * The socket is only accessible to the current user. Clients that do not send
+ * a complete request within the read timeout are dropped without a response.
+ */
+class Daemon final {
+ public:
+  using Handler = std::function<Json::Value(const Json::Value& request)>;
+
+  static constexpr std::chrono::milliseconds kDefaultReadTimeout =
+      std::chrono::seconds(30);
+
+  explicit Daemon(
+      std::string socket_path,
+      std::chrono::milliseconds read_timeout = kDefaultReadTimeout);
+
+  Daemon(const Daemon&) = delete;
+  Daemon(Daemon&&) = delete;
+  Daemon& operator=(const Daemon&) = delete;
+  Daemon& operator=(Daemon&&) = delete;
+  ~Daemon();
+
+  /* Handle requests, one at a time, until a shutdown request is received. */
+  void serve(const Handler& handler);
+
+ private:
+  std::string socket_path_;
+  std::chrono::milliseconds read_timeout_;
+  int socket_;
+};
+
+} // namespace marianatrench
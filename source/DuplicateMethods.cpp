@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <functional>
+#include <sstream>
+#include <vector>
+
+#include <ConcurrentContainers.h>
+#include <ControlFlow.h>
+#include <IRCode.h>
+#include <IRInstruction.h>
+#include <Show.h>
+#include <SpartaWorkQueue.h>
+
+#include <mariana-trench/CallGraph.h>
+#include <mariana-trench/DuplicateMethods.h>
+#include <mariana-trench/Log.h>
+#include <mariana-trench/Methods.h>
+
+namespace marianatrench {
+
+namespace {
+
+class CanonicalWriter final {
+ public:
+  explicit CanonicalWriter(const DexType* declaring_class)
+      : declaring_class_(declaring_class) {}
+
+  void write_type(const DexType* MT_NULLABLE type) {
+    if (type == nullptr) {
+      out_ << "<null>";
+    } else if (type == declaring_class_) {
+      out_ << "<this-class>";
+    } else {
+      out_ << show(type);
+    }
+    out_ << ';';
+  }
+
+  /* Write the type, even if it is the declaring class. */
+  void write_exact_type(const DexType* type) {
+    out_ << show(type) << ';';
+  }
+
+  template <typename T>
+  void write(const T& value) {
+    out_ << value << ';';
+  }
+
+  std::string str() const {
+    return out_.str();
+  }
+
+ private:
+  const DexType* declaring_class_;
+  std::ostringstream out_;
+};
+
+} // namespace
+
+DuplicateMethods::DuplicateMethods(
+    const Context& context,
+    const Registry& registry) {
+  // Bucket the methods by the hash of their canonical form first, to avoid
+  // keeping the canonical form of every method in memory.
+  ConcurrentMap<std::size_t, std::vector<const Method*>> buckets;
+  auto queue = sparta::work_queue<const Method*>(
+      [&](const Method* method) {
+        auto form = canonical_form(context, registry, method);
+        if (!form) {
+          return;
+        }
+        buckets.update(
+            std::hash<std::string>()(*form),
+            [method](
+                std::size_t /* hash */,
+                std::vector<const Method*>& methods,
+                bool /* exists */) { methods.push_back(method); });
+      },
+      sparta::parallel::default_num_threads());
+  for (const auto* method : *context.methods) {
+    queue.add_item(method);
+  }
+  queue.run_all();
+
+  for (const auto& [hash, methods] : buckets) {
+    if (methods.size() < 2) {
+      continue;
+    }
+
+    // Rule out hash collisions.
+    std::unordered_map<std::string, const Method*> representatives;
+    for (const auto* method : methods) {
+      auto [representative, inserted] = representatives.emplace(
+          *canonical_form(context, registry, method), method);
+      if (!inserted) {
+        representatives_.emplace(method, representative->second);
+        has_duplicates_.insert(representative->second);
+        LOG(5,
+            "Method `{}` is a duplicate of `{}`.",
+            method->show(),
+            representative->second->show());
+      }
+    }
+  }
+}
+
+const Method* MT_NULLABLE
+DuplicateMethods::representative(const Method* method) const {
+  auto found = representatives_.find(method);
+  return found != representatives_.end() ? found->second : nullptr;
+}
+
+std::optional<Model> DuplicateMethods::share(
+    Context& context,
+    const Method* method,
+    const Model& old_model,
+    const Model& representative_old_model,
+    const Model& representative_new_model) {
+  // Note that models are compared modulo their method.
+  if (old_model != representative_old_model) {
+    return std::nullopt;
+  }
+  if (!representative_new_model.generations().is_bottom() ||
+      !representative_new_model.parameter_sources().is_bottom() ||
+      !representative_new_model.sinks().is_bottom() ||
+      !representative_new_model.issues().is_bottom()) {
+    return std::nullopt;
+  }
+  return representative_new_model.instantiate(method, context);
+}
+
+std::optional<std::string> DuplicateMethods::canonical_form(
+    const Context& context,
+    const Registry& registry,
+    const Method* method) {
+  const auto* code = method->get_code();
+  if (code == nullptr || !code->cfg_built() ||
+      !method->parameter_type_overrides().empty() ||
+      !context.call_graph->artificial_callees(method).empty()) {
+    return std::nullopt;
+  }
+
+  CanonicalWriter writer(method->get_class());
+  writer.write(method->is_static());
+  writer.write_type(method->return_type());
+  for (ParameterPosition position = 0;
+       position < method->number_of_parameters();
+       position++) {
+    writer.write_type(method->parameter_type(position));
+  }
+
+  for (const auto* block : code->cfg().blocks()) {
+    writer.write("block");
+    writer.write(block->id());
+
+    for (const auto& entry : InstructionIterable(block)) {
+      const auto* instruction = entry.insn;
+      if (instruction->has_data()) {
+        return std::nullopt;
+      }
+
+      writer.write(static_cast<int>(instruction->opcode()));
+      if (instruction->has_dest()) {
+        writer.write(instruction->dest());
+      }
+      for (auto source : instruction->srcs()) {
+        writer.write(source);
+      }
+      if (instruction->has_literal()) {
+        writer.write(instruction->get_literal());
+      }
+      if (instruction->has_string()) {
+        writer.write(instruction->get_string()->str());
+      }
+      if (instruction->has_type()) {
+        // The type of a cast becomes a `via-cast` feature, hence it must be
+        // exact. Type checks are kept exact as well since they usually
+        // guard casts.
+        if (instruction->opcode() == OPCODE_CHECK_CAST ||
+            instruction->opcode() == OPCODE_INSTANCE_OF) {
+          writer.write_exact_type(instruction->get_type());
+        } else {
+          writer.write_type(instruction->get_type());
+        }
+      }
+      if (instruction->has_field()) {
+        // Only the field name matters for memory locations, unless there is
+        // a model for the field.
+        writer.write(instruction->get_field()->get_name()->str());
+        writer.write_type(instruction->get_field()->get_type());
+        const auto* field =
+            context.call_graph->resolved_field_access(method, instruction);
+        if (field != nullptr && !registry.get(field).empty()) {
+          writer.write(field->show());
+        }
+      }
+      if (instruction->has_method()) {
+        auto call_target = context.call_graph->callee(method, instruction);
+        const auto* callee = call_target.resolved_base_callee();
+        if (callee == nullptr) {
+          return std::nullopt;
+        }
+        writer.write(callee->show());
+        writer.write(call_target.is_virtual());
+        // Overrides of a virtual call are filtered by the receiver type, hence
+        // it must be exact.
+        if (call_target.receiver_type() != nullptr) {
+          writer.write_exact_type(call_target.receiver_type());
+        } else {
+          writer.write_type(nullptr);
+        }
+      }
+    }
+
+    for (const auto* edge : block->succs()) {
+      writer.write(static_cast<int>(edge->type()));
+      writer.write(edge->target()->id());
+      if (edge->case_key()) {
+        writer.write(*edge->case_key());
+      }
+      if (edge->throw_info() != nullptr) {
+        writer.write_type(edge->throw_info()->catch_type);
+        writer.write(edge->throw_info()->index);
+      }
+    }
+  }
+
+  return writer.str();
+}
+
+} // namespace marianatrench
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <mariana-trench/Compiler.h>
+#include <mariana-trench/Context.h>
+#include <mariana-trench/Method.h>
+#include <mariana-trench/Model.h>
+#include <mariana-trench/Registry.h>
+
+namespace marianatrench {
+
+/**
+ * Groups of methods with the same code, modulo the declaring class.
+ *
+ * Generated code (lambdas, synthetic accessors, factories, merged classes)
+ * contains many methods that only differ by their declaring class. We compute
+ * a canonical form of each method, where references to the declaring class
+ * are replaced by a placeholder and calls and field accesses are replaced by
+ * what they resolve to. Methods with the same canonical form and the same
+ * previous model are analyzed once per iteration: see `share`.
+ */
+class DuplicateMethods final {
+ public:
+  explicit DuplicateMethods(const Context& context, const Registry& registry);
+
+  DuplicateMethods(const DuplicateMethods&) = delete;
+  DuplicateMethods(DuplicateMethods&&) = delete;
+  DuplicateMethods& operator=(const DuplicateMethods&) = delete;
+  DuplicateMethods& operator=(DuplicateMethods&&) = delete;
+  ~DuplicateMethods() = default;
+
+  /**
+   * Return the method analyzed in place of the given method, or nullptr if
+   * the given method is not a duplicate.
+   */
+  const Method* MT_NULLABLE representative(const Method* method) const;
+
+  /* Return true if the given method is the representative of a duplicate. */
+  bool has_duplicates(const Method* method) const {
+    return has_duplicates_.count(method) > 0;
+  }
+
+  /* Number of methods that are a duplicate of another method. */
+  std::size_t size() const {
+    return representatives_.size();
+  }
+
+  /**
+   * Return the model of `method` given the analysis of its representative,
+   * or nullopt if the result cannot be shared.
+   *
+   * Taint and issues contain positions within the analyzed method, hence
+   * only results made of propagations, sanitizers and modes are shared.
+   */
+  static std::optional<Model> share(
+      Context& context,
+      const Method* method,
+      const Model& old_model,
+      const Model& representative_old_model,
+      const Model& representative_new_model);
+
+  /* Return the canonical form of the given method, if it has one. */
+  static std::optional<std::string> canonical_form(
+      const Context& context,
+      const Registry& registry,
+      const Method* method);
+
+ private:
+  std::unordered_map<const Method*, const Method*> representatives_;
+  std::unordered_set<const Method*> has_duplicates_;
+};
+
+} // namespace marianatrench
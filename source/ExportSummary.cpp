@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <mariana-trench/Assert.h>
+#include <mariana-trench/ClassProperties.h>
+#include <mariana-trench/ExportSummary.h>
+#include <mariana-trench/Options.h>
+
+namespace marianatrench {
+
+namespace {
+
+std::vector<std::pair<AccessPath, CollapsedTaint>> collapse_taint_tree(
+    const TaintAccessPathTree& tree,
+    int maximum_source_sink_distance) {
+  std::vector<std::pair<AccessPath, CollapsedTaint>> result;
+  tree.visit([&](const AccessPath& port, const Taint& taint) {
+    auto collapsed = CollapsedTaint(taint, maximum_source_sink_distance);
+    if (!collapsed.empty()) {
+      result.emplace_back(port, std::move(collapsed));
+    }
+  });
+  return result;
+}
+
+std::vector<std::pair<AccessPath, CollapsedTaint>> collapse_frames(
+    const std::vector<std::pair<AccessPath, std::size_t>>& ports,
+    const std::vector<Frame>& frames,
+    int maximum_source_sink_distance) {
+  std::vector<std::pair<AccessPath, CollapsedTaint>> result;
+  std::size_t begin = 0;
+  for (const auto& [port, end] : ports) {
+    auto collapsed = CollapsedTaint(
+        frames.data() + begin,
+        frames.data() + end,
+        maximum_source_sink_distance);
+    if (!collapsed.empty()) {
+      result.emplace_back(port, std::move(collapsed));
+    }
+    begin = end;
+  }
+  return result;
+}
+
+TaintAccessPathTree propagate_taint_tree(
+    const std::vector<std::pair<AccessPath, CollapsedTaint>>& ports,
+    const Method* callee,
+    const Position* call_position,
+    const FeatureMayAlwaysSet& extra_features,
+    Context& context,
+    const std::vector<const DexType * MT_NULLABLE>& source_register_types,
+    const std::vector<std::optional<std::string>>& source_constant_arguments) {
+  TaintAccessPathTree result;
+  for (const auto& [callee_port, collapsed] : ports) {
+    result.write(
+        callee_port,
+        collapsed.propagate(
+            callee,
+            callee_port,
+            call_position,
+            extra_features,
+            context,
+            source_register_types,
+            source_constant_arguments),
+        UpdateKind::Weak);
+  }
+  return result;
+}
+
+} // namespace
+
+ExportSummary::ExportSummary(const Model& model, Context& context)
+    : method_(model.method()),
+      model_without_taint_(model.at_callsite_without_taint()) {
+  auto maximum_source_sink_distance =
+      context.options->maximum_source_sink_distance();
+  generations_ =
+      collapse_taint_tree(model.generations(), maximum_source_sink_distance);
+  sinks_ = collapse_taint_tree(model.sinks(), maximum_source_sink_distance);
+}
+
+ExportSummary::ExportSummary(const FrozenModel& model, Context& context)
+    : method_(model.method()),
+      model_without_taint_(
+          model.model_without_taint_.at_callsite_without_taint()) {
+  auto maximum_source_sink_distance =
+      context.options->maximum_source_sink_distance();
+  generations_ = collapse_frames(
+      model.generations_.ports,
+      model.generations_.frames,
+      maximum_source_sink_distance);
+  sinks_ = collapse_frames(
+      model.sinks_.ports, model.sinks_.frames, maximum_source_sink_distance);
+}
+
+Model ExportSummary::at_callsite(
+    const Method* caller,
+    const Position* call_position,
+    Context& context,
+    const std::vector<const DexType * MT_NULLABLE>& source_register_types,
+    const std::vector<std::optional<std::string>>& source_constant_arguments)
+    const {
+  const auto* callee = method_;
+  auto model = model_without_taint_;
+
+  // Add special features that cannot be done in model generators.
+  mt_assert(context.features != nullptr);
+  auto extra_features = context.class_properties->propagate_features(
+      caller, callee, *context.features);
+
+  model.set_generations(propagate_taint_tree(
+      generations_,
+      callee,
+      call_position,
+      extra_features,
+      context,
+      source_register_types,
+      source_constant_arguments));
+  model.set_sinks(propagate_taint_tree(
+      sinks_,
+      callee,
+      call_position,
+      extra_features,
+      context,
+      source_register_types,
+      source_constant_arguments));
+
+  return model;
+}
+
+} // namespace marianatrench
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <mariana-trench/Access.h>
+#include <mariana-trench/CollapsedTaint.h>
+#include <mariana-trench/Compiler.h>
+#include <mariana-trench/Context.h>
+#include <mariana-trench/FrozenModel.h>
+#include <mariana-trench/Method.h>
+#include <mariana-trench/Model.h>
+#include <mariana-trench/Position.h>
+
+namespace marianatrench {
+
+/**
+ * An `ExportSummary` is the form of a model that is exported to callers.
+ *
+ * Everything `Model::at_callsite` computes that does not depend on the call
+ * site is precomputed once per model, i.e the modes, propagations and
+ * `inline_as`, as well as the generations and sinks collapsed per port and
+ * kind (see `CollapsedTaint`). Instantiating the summary at a call site only
+ * stamps in the call position, the class property features and the
+ * via-type-of/via-value-of features.
+ *
+ * The registry keeps the summary of models that are still changing. Summaries
+ * of frozen models are built from the frozen frames when needed.
+ */
+class ExportSummary final {
+ public:
+  explicit ExportSummary(const Model& model, Context& context);
+
+  /* This is equivalent to `ExportSummary(model.thaw(), context)`. */
+  explicit ExportSummary(const FrozenModel& model, Context& context);
+
+  ExportSummary(const ExportSummary&) = default;
+  ExportSummary(ExportSummary&&) = default;
+  ExportSummary& operator=(const ExportSummary&) = default;
+  ExportSummary& operator=(ExportSummary&&) = default;
+  ~ExportSummary() = default;
+
+  const Method* MT_NULLABLE method() const {
+    return method_;
+  }
+
+  /**
+   * Return the callee model for the given callsite.
+   *
+   * This is equivalent to `Model::at_callsite` on the original model.
+   */
+  Model at_callsite(
+      const Method* caller,
+      const Position* call_position,
+      Context& context,
+      const std::vector<const DexType * MT_NULLABLE>& source_register_types,
+      const std::vector<std::optional<std::string>>& source_constant_arguments)
+      const;
+
+ private:
+  const Method* MT_NULLABLE method_;
+  Model model_without_taint_;
+  std::vector<std::pair<AccessPath, CollapsedTaint>> generations_;
+  std::vector<std::pair<AccessPath, CollapsedTaint>> sinks_;
+};
+
+} // namespace marianatrench
@@ -12,6 +12,7 @@
 #include <mariana-trench/FieldModel.h>
 #include <mariana-trench/Log.h>
 #include <mariana-trench/Positions.h>
+#include <mariana-trench/UnusedKinds.h>
 
 namespace marianatrench {
 
@@ -160,11 +161,17 @@ FieldModel FieldModel::from_json(
 
   for (auto source_value :
        JsonValidation::null_or_array(value, /* field */ "sources")) {
-    model.add_source(Frame::from_json(source_value, context));
+    auto source = Frame::from_json(source_value, context);
+    if (!UnusedKinds::should_drop(context, source.kind())) {
+      model.add_source(source);
+    }
   }
   for (auto sink_value :
        JsonValidation::null_or_array(value, /* field */ "sinks")) {
-    model.add_sink(Frame::from_json(sink_value, context));
+    auto sink = Frame::from_json(sink_value, context);
+    if (!UnusedKinds::should_drop(context, sink.kind())) {
+      model.add_sink(sink);
+    }
   }
   return model;
 }
@@ -0,0 +1,400 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <mariana-trench/Assert.h>
+
+namespace marianatrench {
+
+/**
+ * A hash set using open addressing with a flat array of slots, in the style
+ * of Swiss tables.
+ *
+ * Each slot has a control byte which is either empty, deleted, or holds 7
+ * bits of the hash of the value. Slots are probed by groups of 16: the
+ * control bytes of a group are compared against the hash at once (using SSE2
+ * when available), so most failed lookups never touch the values. Small sets
+ * use a single, partially filled, group.
+ *
+ * This implements the subset of the `std::unordered_set` interface used by
+ * the abstract domains. Unlike `std::unordered_set`, iterators and references
+ * are invalidated by any insertion.
+ */
+template <typename Value, typename Hash, typename Equal>
+class FlatHashSet final {
+ private:
+  using Control = std::int8_t;
+
+  static constexpr std::size_t k_group_size = 16;
+  static constexpr std::size_t k_minimum_capacity = 4;
+  static constexpr Control k_empty = -128;
+  static constexpr Control k_deleted = -2;
+
+  /* Bitmask of the positions in a group matching a given control byte. */
+  using Mask = std::uint32_t;
+
+ public:
+  class ConstIterator final {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Value;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Value*;
+    using reference = const Value&;
+
+    ConstIterator() = default;
+
+    ConstIterator(const FlatHashSet* set, std::size_t index)
+        : set_(set), index_(index) {}
+
+    reference operator*() const {
+      return set_->slots_[index_];
+    }
+
+    pointer operator->() const {
+      return &set_->slots_[index_];
+    }
+
+    ConstIterator& operator++() {
+      index_ = set_->next_full(index_ + 1);
+      return *this;
+    }
+
+    ConstIterator operator++(int) {
+      ConstIterator result = *this;
+      ++(*this);
+      return result;
+    }
+
+    bool operator==(const ConstIterator& other) const {
+      return index_ == other.index_;
+    }
+
+    bool operator!=(const ConstIterator& other) const {
+      return index_ != other.index_;
+    }
+
+   private:
+    const FlatHashSet* set_ = nullptr;
+    std::size_t index_ = 0;
+
+    friend class FlatHashSet;
+  };
+
+  using iterator = ConstIterator;
+  using const_iterator = ConstIterator;
+  using value_type = Value;
+  using size_type = std::size_t;
+
+ public:
+  FlatHashSet() = default;
+
+  FlatHashSet(const FlatHashSet& other) {
+    copy_from(other);
+  }
+
+  FlatHashSet(FlatHashSet&& other) noexcept {
+    move_from(std::move(other));
+  }
+
+  FlatHashSet& operator=(const FlatHashSet& other) {
+    if (this != &other) {
+      destroy();
+      copy_from(other);
+    }
+    return *this;
+  }
+
+  FlatHashSet& operator=(FlatHashSet&& other) noexcept {
+    if (this != &other) {
+      destroy();
+      move_from(std::move(other));
+    }
+    return *this;
+  }
+
+  ~FlatHashSet() {
+    destroy();
+  }
+
+  std::size_t size() const {
+    return size_;
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  ConstIterator begin() const {
+    return ConstIterator(this, next_full(0));
+  }
+
+  ConstIterator end() const {
+    return ConstIterator(this, capacity_);
+  }
+
+  ConstIterator cbegin() const {
+    return begin();
+  }
+
+  ConstIterator cend() const {
+    return end();
+  }
+
+  void clear() {
+    destroy();
+  }
+
+  ConstIterator find(const Value& value) const {
+    if (capacity_ == 0) {
+      return end();
+    }
+
+    auto hash = mix(Hash()(value));
+    auto control = static_cast<Control>(hash & 0x7f);
+    auto group = (hash >> 7) & group_mask();
+    for (std::size_t probe = 1;; probe++) {
+      const auto* controls = &controls_[group * k_group_size];
+      for (auto mask = match(controls, control); mask != 0;
+           mask &= mask - 1) {
+        auto index = group * k_group_size + lowest_bit(mask);
+        if (Equal()(slots_[index], value)) {
+          return ConstIterator(this, index);
+        }
+      }
+      if (match(controls, k_empty) != 0) {
+        return end();
+      }
+      // Triangular probing visits all groups since their number is a power
+      // of two.
+      group = (group + probe) & group_mask();
+    }
+  }
+
+  std::pair<ConstIterator, bool> insert(const Value& value) {
+    return insert_value(value);
+  }
+
+  std::pair<ConstIterator, bool> insert(Value&& value) {
+    return insert_value(std::move(value));
+  }
+
+  template <typename... Args>
+  std::pair<ConstIterator, bool> emplace(Args&&... args) {
+    return insert_value(Value(std::forward<Args>(args)...));
+  }
+
+  /* Remove the value at the given position and return the next position. */
+  ConstIterator erase(ConstIterator iterator) {
+    auto index = iterator.index_;
+    mt_assert(index < capacity_ && controls_[index] >= 0);
+    slots_[index].~Value();
+    size_--;
+
+    // Probing stops at groups with an empty slot, so the slot can be marked
+    // as empty if its group already has one. Note that the padding of small
+    // sets is empty.
+    const auto* controls = &controls_[index / k_group_size * k_group_size];
+    if (match(controls, k_empty) != 0) {
+      controls_[index] = k_empty;
+    } else {
+      controls_[index] = k_deleted;
+      deleted_++;
+    }
+    return ConstIterator(this, next_full(index + 1));
+  }
+
+ private:
+  static std::size_t mix(std::size_t hash) {
+    // Group hashes are often poorly distributed (e.g, pointers), while both
+    // the low and the high bits are used here.
+    hash ^= hash >> 32;
+    hash *= 0x9e3779b97f4a7c15ull;
+    return hash ^ (hash >> 29);
+  }
+
+  static std::size_t lowest_bit(Mask mask) {
+    return __builtin_ctz(mask);
+  }
+
+  static Mask match(const Control* controls, Control control) {
+#if defined(__SSE2__)
+    auto group =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(controls));
+    return static_cast<Mask>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(control), group)));
+#else
+    Mask mask = 0;
+    for (std::size_t index = 0; index < k_group_size; index++) {
+      if (controls[index] == control) {
+        mask |= Mask(1) << index;
+      }
+    }
+    return mask;
+#endif
+  }
+
+  /* Number of control bytes, including the padding of small sets. */
+  static std::size_t number_controls(std::size_t capacity) {
+    return std::max(capacity, k_group_size);
+  }
+
+  std::size_t group_mask() const {
+    return capacity_ <= k_group_size ? 0 : capacity_ / k_group_size - 1;
+  }
+
+  /* Return the first empty or deleted slot for the given hash. */
+  std::size_t find_free_slot(std::size_t hash) const {
+    // Exclude the padding of small sets.
+    auto valid = capacity_ < k_group_size ? (Mask(1) << capacity_) - 1
+                                          : ~Mask(0);
+    auto group = (hash >> 7) & group_mask();
+    for (std::size_t probe = 1;; probe++) {
+      const auto* controls = &controls_[group * k_group_size];
+      auto mask =
+          (match(controls, k_empty) | match(controls, k_deleted)) & valid;
+      if (mask != 0) {
+        return group * k_group_size + lowest_bit(mask);
+      }
+      group = (group + probe) & group_mask();
+    }
+  }
+
+  template <typename V>
+  std::pair<ConstIterator, bool> insert_value(V&& value) {
+    auto found = find(value);
+    if (found != end()) {
+      return {found, false};
+    }
+
+    // Keep the load factor (including deleted slots) under 7/8.
+    if ((size_ + deleted_ + 1) * 8 > capacity_ * 7) {
+      // Only grow if deleted slots are not enough to make room.
+      auto capacity = std::max(capacity_, k_minimum_capacity);
+      if ((size_ + 1) * 16 > capacity * 7) {
+        capacity *= 2;
+      }
+      rehash(capacity);
+    }
+
+    auto hash = mix(Hash()(value));
+    auto index = find_free_slot(hash);
+    if (controls_[index] == k_deleted) {
+      deleted_--;
+    }
+    controls_[index] = static_cast<Control>(hash & 0x7f);
+    new (&slots_[index]) Value(std::forward<V>(value));
+    size_++;
+    return {ConstIterator(this, index), true};
+  }
+
+  void rehash(std::size_t capacity) {
+    auto old_controls = std::move(controls_);
+    auto* old_slots = slots_;
+    auto old_capacity = capacity_;
+
+    allocate(capacity);
+    for (std::size_t index = 0; index < old_capacity; index++) {
+      if (old_controls[index] < 0) {
+        continue;
+      }
+      auto hash = mix(Hash()(old_slots[index]));
+      auto new_index = find_free_slot(hash);
+      controls_[new_index] = static_cast<Control>(hash & 0x7f);
+      new (&slots_[new_index]) Value(std::move(old_slots[index]));
+      old_slots[index].~Value();
+    }
+
+    if (old_capacity != 0) {
+      std::allocator<Value>().deallocate(old_slots, old_capacity);
+    }
+  }
+
+  /* Allocate empty slots for the given capacity, keeping the size. */
+  void allocate(std::size_t capacity) {
+    mt_assert((capacity & (capacity - 1)) == 0);
+    auto number_controls = FlatHashSet::number_controls(capacity);
+    controls_ = std::unique_ptr<Control[]>(new Control[number_controls]);
+    std::memset(controls_.get(), k_empty, number_controls);
+    slots_ = std::allocator<Value>().allocate(capacity);
+    capacity_ = capacity;
+    deleted_ = 0;
+  }
+
+  std::size_t next_full(std::size_t index) const {
+    while (index < capacity_ && controls_[index] < 0) {
+      index++;
+    }
+    return index;
+  }
+
+  void copy_from(const FlatHashSet& other) {
+    if (other.capacity_ == 0) {
+      return;
+    }
+
+    allocate(other.capacity_);
+    std::memcpy(
+        controls_.get(), other.controls_.get(), number_controls(capacity_));
+    for (std::size_t index = 0; index < capacity_; index++) {
+      if (controls_[index] >= 0) {
+        new (&slots_[index]) Value(other.slots_[index]);
+      }
+    }
+    size_ = other.size_;
+    deleted_ = other.deleted_;
+  }
+
+  void move_from(FlatHashSet&& other) {
+    controls_ = std::move(other.controls_);
+    slots_ = std::exchange(other.slots_, nullptr);
+    capacity_ = std::exchange(other.capacity_, 0);
+    size_ = std::exchange(other.size_, 0);
+    deleted_ = std::exchange(other.deleted_, 0);
+  }
+
+  void destroy() {
+    if (capacity_ == 0) {
+      return;
+    }
+
+    for (std::size_t index = 0; index < capacity_; index++) {
+      if (controls_[index] >= 0) {
+        slots_[index].~Value();
+      }
+    }
+    std::allocator<Value>().deallocate(slots_, capacity_);
+    controls_ = nullptr;
+    slots_ = nullptr;
+    capacity_ = 0;
+    size_ = 0;
+    deleted_ = 0;
+  }
+
+ private:
+  std::unique_ptr<Control[]> controls_;
+  Value* slots_ = nullptr;
+  std::size_t capacity_ = 0;
+  std::size_t size_ = 0;
+  std::size_t deleted_ = 0;
+};
+
+} // namespace marianatrench
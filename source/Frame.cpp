@@ -5,6 +5,8 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <atomic>
+
 #include <boost/functional/hash.hpp>
 #include "mariana-trench/Constants.h"
 
@@ -16,16 +18,87 @@
 
 namespace marianatrench {
 
+namespace {
+
+// Versions are reserved by blocks, to avoid contention between threads.
+constexpr std::uint64_t k_version_block_size = 1 << 16;
+
+// Version 0 is used for bottom.
+std::atomic<std::uint64_t> next_version_block(1);
+
+} // namespace
+
+const Frame::Extension& Frame::Extension::empty_extension() {
+  static const Extension extension{};
+  return extension;
+}
+
+bool Frame::Extension::empty() const {
+  return equals(empty_extension());
+}
+
+bool Frame::Extension::leq(const Extension& other) const {
+  return field_origins.leq(other.field_origins) &&
+      user_features.leq(other.user_features) &&
+      via_type_of_ports.leq(other.via_type_of_ports) &&
+      via_value_of_ports.leq(other.via_value_of_ports) &&
+      canonical_names.leq(other.canonical_names);
+}
+
+bool Frame::Extension::equals(const Extension& other) const {
+  return field_origins == other.field_origins &&
+      user_features == other.user_features &&
+      via_type_of_ports == other.via_type_of_ports &&
+      via_value_of_ports == other.via_value_of_ports &&
+      canonical_names == other.canonical_names;
+}
+
+void Frame::Extension::join_with(const Extension& other) {
+  field_origins.join_with(other.field_origins);
+  user_features.join_with(other.user_features);
+  via_type_of_ports.join_with(other.via_type_of_ports);
+  via_value_of_ports.join_with(other.via_value_of_ports);
+  canonical_names.join_with(other.canonical_names);
+}
+
+const Frame::Extension& Frame::extension() const {
+  return extension_ != nullptr ? *extension_ : Extension::empty_extension();
+}
+
+std::shared_ptr<const Frame::Extension> Frame::make_extension(
+    Extension extension) {
+  if (extension.empty()) {
+    return nullptr;
+  }
+  return std::make_shared<const Extension>(std::move(extension));
+}
+
+std::uint64_t Frame::make_version() {
+  thread_local std::uint64_t next_version = 0;
+  thread_local std::uint64_t end_version = 0;
+  if (next_version == end_version) {
+    next_version = next_version_block.fetch_add(
+        k_version_block_size, std::memory_order_relaxed);
+    end_version = next_version + k_version_block_size;
+  }
+  return next_version++;
+}
+
 void Frame::set_origins(const MethodSet& origins) {
   origins_ = origins;
+  version_ = make_version();
 }
 
 void Frame::set_field_origins(const FieldSet& field_origins) {
-  field_origins_ = field_origins;
+  auto extension = this->extension();
+  extension.field_origins = field_origins;
+  extension_ = make_extension(std::move(extension));
+  version_ = make_version();
 }
 
 void Frame::add_inferred_features(const FeatureMayAlwaysSet& features) {
   locally_inferred_features_.add(features);
+  version_ = make_version();
 }
 
 FeatureMayAlwaysSet Frame::features() const {
@@ -33,21 +106,23 @@ FeatureMayAlwaysSet Frame::features() const {
   features.add(locally_inferred_features_);
 
   if (features.is_bottom()) {
-    return FeatureMayAlwaysSet::make_always(user_features_);
+    return FeatureMayAlwaysSet::make_always(user_features());
   }
 
-  features.add_always(user_features_);
+  features.add_always(user_features());
   mt_assert(!features.is_bottom());
   return features;
 }
 
 void Frame::add_local_position(const Position* position) {
   local_positions_.add(position);
+  version_ = make_version();
 }
 
 void Frame::set_local_positions(LocalPositionSet positions) {
   mt_assert(!positions.is_bottom());
   local_positions_ = std::move(positions);
+  version_ = make_version();
 }
 
 bool Frame::leq(const Frame& other) const {
@@ -55,20 +130,19 @@ bool Frame::leq(const Frame& other) const {
     return true;
   } else if (other.is_bottom()) {
     return false;
+  } else if (version_ == other.version_) {
+    return true;
   } else {
     return kind_ == other.kind_ &&
         (is_artificial_source() ? callee_port_.leq(other.callee_port_)
                                 : callee_port_ == other.callee_port_) &&
         callee_ == other.callee_ && call_position_ == other.call_position_ &&
         distance_ >= other.distance_ && origins_.leq(other.origins_) &&
-        field_origins_.leq(other.field_origins_) &&
         inferred_features_.leq(other.inferred_features_) &&
         locally_inferred_features_.leq(other.locally_inferred_features_) &&
-        user_features_.leq(other.user_features_) &&
-        via_type_of_ports_.leq(other.via_type_of_ports_) &&
-        via_value_of_ports_.leq(other.via_value_of_ports_) &&
         local_positions_.leq(other.local_positions_) &&
-        canonical_names_.leq(other.canonical_names_);
+        (extension_ == other.extension_ ||
+         extension().leq(other.extension()));
   }
 }
 
@@ -77,18 +151,17 @@ bool Frame::equals(const Frame& other) const {
     return other.is_bottom();
   } else if (other.is_bottom()) {
     return false;
+  } else if (version_ == other.version_) {
+    return true;
   } else {
     return kind_ == other.kind_ && callee_port_ == other.callee_port_ &&
         callee_ == other.callee_ && call_position_ == other.call_position_ &&
         distance_ == other.distance_ && origins_ == other.origins_ &&
-        field_origins_ == other.field_origins_ &&
         inferred_features_ == other.inferred_features_ &&
         locally_inferred_features_ == other.locally_inferred_features_ &&
-        user_features_ == other.user_features_ &&
-        via_type_of_ports_ == other.via_type_of_ports_ &&
-        via_value_of_ports_ == other.via_value_of_ports_ &&
         local_positions_ == other.local_positions_ &&
-        canonical_names_ == other.canonical_names_;
+        (extension_ == other.extension_ ||
+         extension().equals(other.extension()));
   }
 }
 
@@ -97,13 +170,19 @@ void Frame::join_with(const Frame& other) {
 
   if (is_bottom()) {
     *this = other;
-  } else if (other.is_bottom()) {
+  } else if (other.is_bottom() || version_ == other.version_) {
     return;
   } else {
     mt_assert(kind_ == other.kind_);
     mt_assert(callee_ == other.callee_);
     mt_assert(call_position_ == other.call_position_);
 
+    // This is the common case in later iterations of the fixpoint. Checking
+    // it first avoids updating the sub-domains, and preserves the version.
+    if (other.leq(*this)) {
+      return;
+    }
+
     if (is_artificial_source()) {
       callee_port_.join_with(other.callee_port_);
     } else {
@@ -112,14 +191,21 @@ void Frame::join_with(const Frame& other) {
 
     distance_ = std::min(distance_, other.distance_);
     origins_.join_with(other.origins_);
-    field_origins_.join_with(other.field_origins_);
     inferred_features_.join_with(other.inferred_features_);
     locally_inferred_features_.join_with(other.locally_inferred_features_);
-    user_features_.join_with(other.user_features_);
-    via_type_of_ports_.join_with(other.via_type_of_ports_);
-    via_value_of_ports_.join_with(other.via_value_of_ports_);
     local_positions_.join_with(other.local_positions_);
-    canonical_names_.join_with(other.canonical_names_);
+
+    // An empty extension is the identity of the join.
+    if (extension_ == nullptr) {
+      extension_ = other.extension_;
+    } else if (
+        other.extension_ != nullptr && extension_ != other.extension_ &&
+        !other.extension_->leq(*extension_)) {
+      auto extension = *extension_;
+      extension.join_with(*other.extension_);
+      extension_ = make_extension(std::move(extension));
+    }
+    version_ = make_version();
   }
 
   mt_expensive_assert(previous.leq(*this) && other.leq(*this));
@@ -163,11 +249,13 @@ Frame Frame::artificial_source(AccessPath access_path) {
 
 void Frame::callee_port_append(Path::Element path_element) {
   callee_port_.append(path_element);
+  version_ = make_version();
 }
 
 Frame Frame::with_kind(const Kind* kind) const {
   Frame new_frame(*this);
   new_frame.kind_ = kind;
+  new_frame.version_ = make_version();
   return new_frame;
 }
 
@@ -275,6 +363,10 @@ Frame Frame::from_json(const Json::Value& value, Context& context) {
 
   JsonValidation::null_or_array(value, /* field */ "origins");
   auto origins = MethodSet::from_json(value["origins"], context);
+  if (value.isMember("collapsed_origins") &&
+      JsonValidation::boolean(value, /* field */ "collapsed_origins")) {
+    origins.set_to_top();
+  }
 
   JsonValidation::null_or_array(value, /* field */ "field_origins");
   auto field_origins = FieldSet::from_json(value["field_origins"], context);
@@ -416,34 +508,40 @@ Json::Value Frame::to_json() const {
     value["distance"] = Json::Value(distance_);
   }
 
-  if (!origins_.empty()) {
+  if (origins_.is_top()) {
+    // Keep `origins` a list, for consumers of the output.
+    value["origins"] = Json::Value(Json::arrayValue);
+    value["collapsed_origins"] = Json::Value(true);
+  } else if (!origins_.empty()) {
     value["origins"] = origins_.to_json();
   }
 
-  if (!field_origins_.empty()) {
-    value["field_origins"] = field_origins_.to_json();
+  const auto& extension = this->extension();
+  if (!extension.field_origins.empty()) {
+    value["field_origins"] = extension.field_origins.to_json();
   }
 
   JsonValidation::update_object(value, features().to_json());
 
   auto all_local_features = locally_inferred_features();
-  all_local_features.add_always(user_features_);
+  all_local_features.add_always(extension.user_features);
   if (!all_local_features.is_bottom() && !all_local_features.empty()) {
     value["local_features"] = all_local_features.to_json();
   }
 
-  if (via_type_of_ports_.is_value() && !via_type_of_ports_.elements().empty()) {
+  if (extension.via_type_of_ports.is_value() &&
+      !extension.via_type_of_ports.elements().empty()) {
     auto ports = Json::Value(Json::arrayValue);
-    for (const auto& root : via_type_of_ports_.elements()) {
+    for (const auto& root : extension.via_type_of_ports.elements()) {
       ports.append(root.to_json());
     }
     value["via_type_of"] = ports;
   }
 
-  if (via_value_of_ports_.is_value() &&
-      !via_value_of_ports_.elements().empty()) {
+  if (extension.via_value_of_ports.is_value() &&
+      !extension.via_value_of_ports.elements().empty()) {
     auto ports = Json::Value(Json::arrayValue);
-    for (const auto& root : via_value_of_ports_.elements()) {
+    for (const auto& root : extension.via_value_of_ports.elements()) {
       ports.append(root.to_json());
     }
     value["via_value_of"] = ports;
@@ -453,9 +551,10 @@ Json::Value Frame::to_json() const {
     value["local_positions"] = local_positions_.to_json();
   }
 
-  if (canonical_names_.is_value() && !canonical_names_.elements().empty()) {
+  if (extension.canonical_names.is_value() &&
+      !extension.canonical_names.elements().empty()) {
     auto canonical_names = Json::Value(Json::arrayValue);
-    for (const auto& canonical_name : canonical_names_.elements()) {
+    for (const auto& canonical_name : extension.canonical_names.elements()) {
       canonical_names.append(canonical_name.to_json());
     }
     value["canonical_names"] = canonical_names;
@@ -504,8 +603,8 @@ std::ostream& operator<<(std::ostream& out, const Frame& frame) {
   if (!frame.origins_.empty()) {
     out << ", origins=" << frame.origins_;
   }
-  if (!frame.field_origins_.empty()) {
-    out << ", field_origins=" << frame.field_origins_;
+  if (!frame.field_origins().empty()) {
+    out << ", field_origins=" << frame.field_origins();
   }
   if (!frame.inferred_features_.empty()) {
     out << ", inferred_features=" << frame.inferred_features_;
@@ -513,23 +612,23 @@ std::ostream& operator<<(std::ostream& out, const Frame& frame) {
   if (!frame.locally_inferred_features_.empty()) {
     out << ", locally_inferred_features=" << frame.locally_inferred_features_;
   }
-  if (!frame.user_features_.empty()) {
-    out << ", user_features=" << frame.user_features_;
+  if (!frame.user_features().empty()) {
+    out << ", user_features=" << frame.user_features();
   }
-  if (frame.via_type_of_ports_.is_value() &&
-      !frame.via_type_of_ports_.elements().empty()) {
-    out << ", via_type_of_ports=" << frame.via_type_of_ports_;
+  if (frame.via_type_of_ports().is_value() &&
+      !frame.via_type_of_ports().elements().empty()) {
+    out << ", via_type_of_ports=" << frame.via_type_of_ports();
   }
-  if (frame.via_value_of_ports_.is_value() &&
-      !frame.via_value_of_ports_.elements().empty()) {
-    out << ", via_value_of_ports=" << frame.via_value_of_ports_;
+  if (frame.via_value_of_ports().is_value() &&
+      !frame.via_value_of_ports().elements().empty()) {
+    out << ", via_value_of_ports=" << frame.via_value_of_ports();
   }
   if (!frame.local_positions_.empty()) {
     out << ", local_positions=" << frame.local_positions_;
   }
-  if (frame.canonical_names_.is_value() &&
-      !frame.canonical_names_.elements().empty()) {
-    out << ", canonical_names=" << frame.canonical_names_;
+  if (frame.canonical_names().is_value() &&
+      !frame.canonical_names().elements().empty()) {
+    out << ", canonical_names=" << frame.canonical_names();
   }
   return out << ")";
 }
@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <ostream>
 
@@ -90,6 +92,16 @@ using CanonicalNameSetAbstractDomain =
  * format is defined using placeholders. See `CanonicalName`.
  *
  * For artificial sources, the callee port is used as the origin of the source.
+ *
+ * `field_origins`, `user_features`, `via_type_of_ports`, `via_value_of_ports`
+ * and `canonical_names` are rarely set. They are stored out-of-line, in an
+ * extension shared between copies, which is `nullptr` when they are all empty.
+ * This keeps the frame small.
+ *
+ * Each frame also carries a `version`, which is renewed whenever the frame is
+ * created or modified, and preserved by copies. Frames with the same version
+ * are identical, which lets `leq`, `equals` and `join_with` skip comparing
+ * sub-domains in the common case of comparing a frame with a copy of itself.
  */
 class Frame final : public sparta::AbstractDomain<Frame> {
  public:
@@ -99,7 +111,8 @@ class Frame final : public sparta::AbstractDomain<Frame> {
         callee_port_(Root(Root::Kind::Leaf)),
         callee_(nullptr),
         call_position_(nullptr),
-        distance_(0) {}
+        distance_(0),
+        version_(0) {}
 
   explicit Frame(
       const Kind* kind,
@@ -124,14 +137,16 @@ class Frame final : public sparta::AbstractDomain<Frame> {
         call_position_(call_position),
         distance_(distance),
         origins_(std::move(origins)),
-        field_origins_(std::move(field_origins)),
         inferred_features_(std::move(inferred_features)),
         locally_inferred_features_(std::move(locally_inferred_features)),
-        user_features_(std::move(user_features)),
-        via_type_of_ports_(std::move(via_type_of_ports)),
-        via_value_of_ports_(std::move(via_value_of_ports)),
         local_positions_(std::move(local_positions)),
-        canonical_names_(std::move(canonical_names)) {
+        extension_(make_extension(Extension{
+            std::move(field_origins),
+            std::move(user_features),
+            std::move(via_type_of_ports),
+            std::move(via_value_of_ports),
+            std::move(canonical_names)})),
+        version_(make_version()) {
     mt_assert(kind_ != nullptr);
     mt_assert(distance_ >= 0);
     mt_assert(!local_positions_.is_bottom());
@@ -230,15 +245,15 @@ class Frame final : public sparta::AbstractDomain<Frame> {
   }
 
   const RootSetAbstractDomain& via_type_of_ports() const {
-    return via_type_of_ports_;
+    return extension().via_type_of_ports;
   }
 
   const RootSetAbstractDomain& via_value_of_ports() const {
-    return via_value_of_ports_;
+    return extension().via_value_of_ports;
   }
 
   const CanonicalNameSetAbstractDomain& canonical_names() const {
-    return canonical_names_;
+    return extension().canonical_names;
   }
 
   void set_origins(const MethodSet& origins);
@@ -249,7 +264,7 @@ class Frame final : public sparta::AbstractDomain<Frame> {
   }
 
   const FieldSet& field_origins() const {
-    return field_origins_;
+    return extension().field_origins;
   }
 
   /**
@@ -267,7 +282,7 @@ class Frame final : public sparta::AbstractDomain<Frame> {
   }
 
   const FeatureSet& user_features() const {
-    return user_features_;
+    return extension().user_features;
   }
 
   FeatureMayAlwaysSet features() const;
@@ -363,6 +378,32 @@ class Frame final : public sparta::AbstractDomain<Frame> {
 
   friend std::ostream& operator<<(std::ostream& out, const Frame& frame);
 
+ private:
+  /* Fields that are rarely set, see `extension_`. */
+  struct Extension {
+    FieldSet field_origins;
+    FeatureSet user_features;
+    RootSetAbstractDomain via_type_of_ports;
+    RootSetAbstractDomain via_value_of_ports;
+    CanonicalNameSetAbstractDomain canonical_names;
+
+    static const Extension& empty_extension();
+
+    bool empty() const;
+    bool leq(const Extension& other) const;
+    bool equals(const Extension& other) const;
+    void join_with(const Extension& other);
+  };
+
+  /* Return the extension, or an empty extension if there is none. */
+  const Extension& extension() const;
+
+  /* Return `nullptr` if the given extension is empty. */
+  static std::shared_ptr<const Extension> make_extension(Extension extension);
+
+  /* Return a new, unique, version. */
+  static std::uint64_t make_version();
+
  private:
   const Kind* MT_NULLABLE kind_;
   AccessPath callee_port_;
@@ -371,14 +412,12 @@ class Frame final : public sparta::AbstractDomain<Frame> {
   const Position* MT_NULLABLE call_position_;
   int distance_;
   MethodSet origins_;
-  FieldSet field_origins_;
   FeatureMayAlwaysSet inferred_features_;
   FeatureMayAlwaysSet locally_inferred_features_;
-  FeatureSet user_features_;
-  RootSetAbstractDomain via_type_of_ports_;
-  RootSetAbstractDomain via_value_of_ports_;
   LocalPositionSet local_positions_;
-  CanonicalNameSetAbstractDomain canonical_names_;
+  // Extensions are immutable, since they are shared between copies.
+  std::shared_ptr<const Extension> MT_NULLABLE extension_;
+  std::uint64_t version_;
 };
 
 } // namespace marianatrench
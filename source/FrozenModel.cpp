@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <mariana-trench/FrozenModel.h>
+
+namespace marianatrench {
+
+FrozenModel::FrozenModel(const Model& model)
+    : model_without_taint_(model),
+      generations_(freeze(model.generations())),
+      parameter_sources_(freeze(model.parameter_sources())),
+      sinks_(freeze(model.sinks())) {
+  model_without_taint_.set_generations({});
+  model_without_taint_.set_parameter_sources({});
+  model_without_taint_.set_sinks({});
+}
+
+std::size_t FrozenModel::frames_size() const {
+  return generations_.frames.size() + parameter_sources_.frames.size() +
+      sinks_.frames.size();
+}
+
+Model FrozenModel::thaw() const {
+  auto model = model_without_taint_;
+  model.set_generations(thaw(generations_));
+  model.set_parameter_sources(thaw(parameter_sources_));
+  model.set_sinks(thaw(sinks_));
+  return model;
+}
+
+Json::Value FrozenModel::to_json(Context& context) const {
+  return thaw().to_json(context);
+}
+
+FrozenModel::FrozenTaintTree FrozenModel::freeze(
+    const TaintAccessPathTree& tree) {
+  FrozenTaintTree result;
+  tree.visit([&](const AccessPath& port, const Taint& taint) {
+    for (const auto& frame : taint.frames_iterator()) {
+      result.frames.push_back(frame);
+    }
+    result.ports.emplace_back(port, result.frames.size());
+  });
+  result.ports.shrink_to_fit();
+  result.frames.shrink_to_fit();
+  return result;
+}
+
+TaintAccessPathTree FrozenModel::thaw(const FrozenTaintTree& tree) {
+  // Elements of a tree do not include their ancestors, hence writing them back
+  // in tree order rebuilds the exact same tree.
+  TaintAccessPathTree result;
+  std::size_t begin = 0;
+  for (const auto& [port, end] : tree.ports) {
+    Taint taint;
+    for (auto index = begin; index < end; index++) {
+      taint.add(tree.frames[index]);
+    }
+    result.write(port, std::move(taint), UpdateKind::Weak);
+    begin = end;
+  }
+  return result;
+}
+
+} // namespace marianatrench
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <json/json.h>
+
+#include <mariana-trench/Access.h>
+#include <mariana-trench/Compiler.h>
+#include <mariana-trench/Context.h>
+#include <mariana-trench/Frame.h>
+#include <mariana-trench/IssueSet.h>
+#include <mariana-trench/Method.h>
+#include <mariana-trench/Model.h>
+#include <mariana-trench/TaintTree.h>
+
+namespace marianatrench {
+
+/**
+ * A `FrozenModel` is a read-only, compact form of a model that is no longer
+ * changing.
+ *
+ * The generations, parameter sources and sinks usually make up most of the
+ * memory of a model, because of the per-node overhead of the access path trees
+ * and taint partitions. A frozen model stores their frames in a flat array,
+ * grouped per port in tree order. Everything else is kept as a regular model.
+ *
+ * Call sites never thaw frozen models: their `ExportSummary` is collapsed
+ * straight from the flat frames, and it is not kept once the model is frozen.
+ * Writes go through `thaw`, which rebuilds the original model.
+ */
+class FrozenModel final {
+ private:
+  struct FrozenTaintTree {
+    /* Ports of the tree, with the end offset of their frames in `frames`. */
+    std::vector<std::pair<AccessPath, std::size_t>> ports;
+    std::vector<Frame> frames;
+  };
+
+ public:
+  explicit FrozenModel(const Model& model);
+
+  FrozenModel(const FrozenModel&) = default;
+  FrozenModel(FrozenModel&&) = default;
+  FrozenModel& operator=(const FrozenModel&) = default;
+  FrozenModel& operator=(FrozenModel&&) = default;
+  ~FrozenModel() = default;
+
+  const Method* MT_NULLABLE method() const {
+    return model_without_taint_.method();
+  }
+
+  bool skip_analysis() const {
+    return model_without_taint_.skip_analysis();
+  }
+
+  const IssueSet& issues() const {
+    return model_without_taint_.issues();
+  }
+
+  /* Issues are not part of the frozen taint, hence they can be replaced. */
+  void set_issues(IssueSet issues) {
+    model_without_taint_.set_issues(std::move(issues));
+  }
+
+  /* Number of generation, parameter source and sink frames. */
+  std::size_t frames_size() const;
+
+  /* Rebuild the original model. */
+  Model thaw() const;
+
+  /* This is equivalent to `Model::to_json` on the original model. */
+  Json::Value to_json(Context& context) const;
+
+ private:
+  static FrozenTaintTree freeze(const TaintAccessPathTree& tree);
+  static TaintAccessPathTree thaw(const FrozenTaintTree& tree);
+
+  friend class ExportSummary;
+
+ private:
+  Model model_without_taint_;
+  FrozenTaintTree generations_;
+  FrozenTaintTree parameter_sources_;
+  FrozenTaintTree sinks_;
+};
+
+} // namespace marianatrench
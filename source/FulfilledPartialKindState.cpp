@@ -5,25 +5,28 @@
  * LICENSE file in the root directory of this source tree.
  */
 
-#include <mariana-trench/FulfilledPartialKindState.h>
 #include <optional>
 
+#include <mariana-trench/Assert.h>
+#include <mariana-trench/FulfilledPartialKindState.h>
+
 namespace marianatrench {
 
 std::optional<Taint> FulfilledPartialKindState::fulfill_kind(
-    const PartialKind* kind,
-    const MultiSourceMultiSinkRule* rule,
+    const PartialKindRule* partial_kind_rule,
     const FeatureMayAlwaysSet& features,
     MethodContext* context,
     const Taint& sink) {
-  const auto* counterpart = get_fulfilled_counterpart(kind, rule);
+  const auto* counterpart =
+      get_fulfilled_counterpart(context, partial_kind_rule);
   if (counterpart) {
     // If both partial sinks for the callsite have been fulfilled, the rule
     // is satisfied. Make this a triggered sink and create the sink flow
     // (FrameSet) for the issue. Include the features from both flows (using
     // .add, NOT .join).
-    const auto* triggered_kind = context->kinds.get_triggered(kind, rule);
-    auto sink_features = get_features(counterpart, rule);
+    const auto* kind = partial_kind_rule->kind;
+    const auto* triggered_kind = partial_kind_rule->triggered_kind;
+    auto sink_features = get_features(counterpart);
     sink_features.add(features);
 
     auto issue_sink = sink.transform_kind_with_features(
@@ -34,44 +37,60 @@ std::optional<Taint> FulfilledPartialKindState::fulfill_kind(
           return std::vector<const Kind*>{triggered_kind};
         },
         [&](const Kind* /* new_sink_kind */) { return sink_features; });
-    erase(counterpart, rule);
+    fulfilled_[counterpart->id] = std::nullopt;
     return issue_sink;
   }
 
-  add_fulfilled_kind(kind, rule, features);
+  if (fulfilled_.empty()) {
+    fulfilled_.resize(context->rules.number_partial_kind_rules());
+  }
+  mt_assert(partial_kind_rule->id < fulfilled_.size());
+  auto& fulfilled = fulfilled_[partial_kind_rule->id];
+  if (!fulfilled) {
+    fulfilled = features;
+  }
   return std::nullopt;
 }
 
-const PartialKind* MT_NULLABLE
+const Rules::PartialKindRule* MT_NULLABLE
 FulfilledPartialKindState::get_fulfilled_counterpart(
-    const PartialKind* unfulfilled_kind,
-    const MultiSourceMultiSinkRule* rule) const {
-  for (const auto& [kind, rules_map] : map_) {
-    if (unfulfilled_kind->is_counterpart(kind) &&
-        rules_map.find(rule) != rules_map.end()) {
-      return kind;
-    }
+    MethodContext* context,
+    const PartialKindRule* unfulfilled) const {
+  if (!is_fulfilled(unfulfilled->counterpart_id)) {
+    return nullptr;
   }
 
-  return nullptr;
+  return &context->rules.partial_kind_rule(unfulfilled->counterpart_id);
 }
 
 FeatureMayAlwaysSet FulfilledPartialKindState::get_features(
-    const PartialKind* kind,
-    const MultiSourceMultiSinkRule* rule) const {
-  return map_.at(kind).at(rule);
+    const PartialKindRule* partial_kind_rule) const {
+  mt_assert(is_fulfilled(partial_kind_rule->id));
+  return *fulfilled_[partial_kind_rule->id];
+}
+
+FeatureMayAlwaysSet FulfilledPartialKindState::get_counterpart_features(
+    MethodContext* context,
+    const TriggeredPartialKind* triggered_kind) const {
+  const auto* partial_kind_rule =
+      context->rules.partial_kind_rule(triggered_kind);
+  mt_assert(partial_kind_rule != nullptr);
+  mt_assert(is_fulfilled(partial_kind_rule->counterpart_id));
+  return *fulfilled_[partial_kind_rule->counterpart_id];
 }
 
 std::vector<const Kind*> FulfilledPartialKindState::make_triggered_counterparts(
     MethodContext* context,
     const PartialKind* unfulfilled_kind) const {
   std::vector<const Kind*> result;
-  for (const auto& [kind, rules_map] : map_) {
-    if (unfulfilled_kind->is_counterpart(kind)) {
-      for (const auto& [rule, _features] : rules_map) {
-        result.emplace_back(
-            context->kinds.get_triggered(unfulfilled_kind, rule));
-      }
+  if (fulfilled_.empty()) {
+    return result;
+  }
+
+  for (const auto* partial_kind_rule :
+       context->rules.partial_kind_rules(unfulfilled_kind)) {
+    if (is_fulfilled(partial_kind_rule->counterpart_id)) {
+      result.push_back(partial_kind_rule->triggered_kind);
     }
   }
 
@@ -80,30 +99,4 @@ std::vector<const Kind*> FulfilledPartialKindState::make_triggered_counterparts(
   return result;
 }
 
-void FulfilledPartialKindState::add_fulfilled_kind(
-    const PartialKind* kind,
-    const MultiSourceMultiSinkRule* rule,
-    const FeatureMayAlwaysSet& features) {
-  auto rules_map = map_.find(kind);
-  if (rules_map == map_.end()) {
-    map_.emplace(kind, RuleMap{{rule, features}});
-    return;
-  }
-  rules_map->second.emplace(rule, features);
-}
-
-void FulfilledPartialKindState::erase(
-    const PartialKind* kind,
-    const MultiSourceMultiSinkRule* rule) {
-  auto rules_map = map_.find(kind);
-  if (rules_map == map_.end()) {
-    return;
-  }
-
-  rules_map->second.erase(rule);
-  if (rules_map->second.empty()) {
-    map_.erase(kind);
-  }
-}
-
 } // namespace marianatrench
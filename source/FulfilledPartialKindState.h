@@ -7,11 +7,13 @@
 
 #pragma once
 
-#include <unordered_map>
+#include <optional>
+#include <vector>
 
 #include <mariana-trench/FeatureMayAlwaysSet.h>
 #include <mariana-trench/MethodContext.h>
 #include <mariana-trench/MultiSourceMultiSinkRule.h>
+#include <mariana-trench/Rules.h>
 #include <mariana-trench/TriggeredPartialKind.h>
 
 namespace marianatrench {
@@ -20,11 +22,14 @@ namespace marianatrench {
  * Represents the state of a fulfilled partial kind (sink).
  * Used by `Transfer` to track the state of partially-fulfilled
  * `MultiSourceMultiSink` rules.
+ *
+ * Pairs of (partial kind, rule) are identified by their dense identifier in
+ * `Rules`, hence the state is a flat array. It is only allocated once a partial
+ * kind is fulfilled, which is rare.
  */
 class FulfilledPartialKindState final {
  private:
-  using Value = FeatureMayAlwaysSet;
-  using RuleMap = std::unordered_map<const MultiSourceMultiSinkRule*, Value>;
+  using PartialKindRule = Rules::PartialKindRule;
 
  public:
   FulfilledPartialKindState() = default;
@@ -35,8 +40,9 @@ class FulfilledPartialKindState final {
   FulfilledPartialKindState& operator=(FulfilledPartialKindState&&) = delete;
 
   /**
-   * Called when sink `kind` is fulfilled under `rule`, i.e. has a matching
-   * source flow into the sink as defined by the rule.
+   * Called when sink `partial_kind_rule.kind` is fulfilled under
+   * `partial_kind_rule.rule`, i.e. has a matching source flow into the sink as
+   * defined by the rule.
    *
    * `features` is the combined set of features from the source and sink flow
    * of the fulfilled rule.
@@ -48,27 +54,33 @@ class FulfilledPartialKindState final {
    * fulfilled.
    */
   std::optional<Taint> fulfill_kind(
-      const PartialKind* kind,
-      const MultiSourceMultiSinkRule* rule,
+      const PartialKindRule* partial_kind_rule,
       const FeatureMayAlwaysSet& features,
       MethodContext* context,
       const Taint& sink);
 
   /**
-   * Given an `unfufilled_kind`, check if its counterpart flow has been
-   * fulfilled under the given rule. Returns the `PartialKind` of the fulfilled
-   * counterpart, or nullptr if the counterpart was not fulfilled.
+   * Given an unfulfilled partial kind and rule, check if its counterpart flow
+   * has been fulfilled under the same rule. Returns the counterpart, or nullptr
+   * if the counterpart was not fulfilled.
    */
-  const PartialKind* MT_NULLABLE get_fulfilled_counterpart(
-      const PartialKind* unfulfilled_kind,
-      const MultiSourceMultiSinkRule* rule) const;
+  const PartialKindRule* MT_NULLABLE get_fulfilled_counterpart(
+      MethodContext* context,
+      const PartialKindRule* unfulfilled) const;
 
   /**
-   * Returns features of the flow where `kind` was fulfilled under `rule`.
+   * Returns features of the flow where the given partial kind was fulfilled.
    */
   FeatureMayAlwaysSet get_features(
-      const PartialKind* kind,
-      const MultiSourceMultiSinkRule* rule) const;
+      const PartialKindRule* partial_kind_rule) const;
+
+  /**
+   * Returns features of the fulfilled counterpart that produced the given
+   * triggered kind (see `make_triggered_counterparts`).
+   */
+  FeatureMayAlwaysSet get_counterpart_features(
+      MethodContext* context,
+      const TriggeredPartialKind* triggered_kind) const;
 
   /**
    * Given an `unfulfilled_kind`, create its `TriggeredPartialKind`s from any
@@ -80,13 +92,12 @@ class FulfilledPartialKindState final {
       const PartialKind* unfulfilled_kind) const;
 
  private:
-  void add_fulfilled_kind(
-      const PartialKind* kind,
-      const MultiSourceMultiSinkRule* rule,
-      const FeatureMayAlwaysSet& features);
-  void erase(const PartialKind* kind, const MultiSourceMultiSinkRule* rule);
+  bool is_fulfilled(std::size_t id) const {
+    return id < fulfilled_.size() && fulfilled_[id].has_value();
+  }
 
-  std::unordered_map<const PartialKind*, RuleMap> map_;
+  // Features of the fulfilled flow, indexed by `PartialKindRule::id`.
+  std::vector<std::optional<FeatureMayAlwaysSet>> fulfilled_;
 };
 
 } // namespace marianatrench
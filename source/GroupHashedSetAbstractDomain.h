@@ -17,6 +17,7 @@
 #include <AbstractDomain.h>
 
 #include <mariana-trench/Assert.h>
+#include <mariana-trench/FlatHashSet.h>
 
 namespace marianatrench {
 
@@ -63,12 +64,27 @@ struct GroupDifference {
   }
 };
 
+/* Store the elements in a node-based `std::unordered_set`. */
+struct UnorderedSetStorage {
+  template <typename Value, typename Hash, typename Equal>
+  using Set = std::unordered_set<Value, Hash, Equal>;
+};
+
+/* Store the elements in a flat open-addressing `FlatHashSet`. */
+struct FlatSetStorage {
+  template <typename Value, typename Hash, typename Equal>
+  using Set = FlatHashSet<Value, Hash, Equal>;
+};
+
 } // namespace detail
 
 /**
  * A powerset abstract domain with grouping implemented using hash tables.
  *
  * `GroupHash` and `GroupEqual` describe how elements are grouped together.
+ * The group hash of each element is computed once and stored alongside it.
+ *
+ * `Storage` describes the underlying hash table, see `detail::*Storage`.
  *
  * The implementation is mostly based on `sparta::HashedSetAbstractDomain`.
  */
@@ -76,13 +92,15 @@ template <
     typename Element,
     typename GroupHash,
     typename GroupEqual,
-    typename GroupDifference = detail::GroupDifference<Element>>
+    typename GroupDifference = detail::GroupDifference<Element>,
+    typename Storage = detail::UnorderedSetStorage>
 class GroupHashedSetAbstractDomain final
     : public sparta::AbstractDomain<GroupHashedSetAbstractDomain<
           Element,
           GroupHash,
           GroupEqual,
-          GroupDifference>> {
+          GroupDifference,
+          Storage>> {
  public:
   static_assert(std::is_same_v<
                 decltype(GroupHash()(std::declval<const Element>())),
@@ -99,18 +117,45 @@ class GroupHashedSetAbstractDomain final
                 void>);
 
  private:
-  using MutableElement = detail::MutableValue<Element>;
+  /* A mutable element along with its group hash. */
+  class MutableElement {
+   public:
+    explicit MutableElement(const Element& element)
+        : hash_(GroupHash()(element)), value_(element) {}
+    MutableElement(const MutableElement&) = default;
+    MutableElement(MutableElement&&) = default;
+    MutableElement& operator=(const MutableElement&) = default;
+    MutableElement& operator=(MutableElement&&) = default;
+    ~MutableElement() = default;
+
+    std::size_t hash() const {
+      return hash_;
+    }
+
+    const Element& get() const {
+      return value_.get();
+    }
+
+    Element& get_unsafe() const {
+      return value_.get_unsafe();
+    }
+
+   private:
+    std::size_t hash_;
+    detail::MutableValue<Element> value_;
+  };
 
   struct MutableElementHash {
     std::size_t operator()(const MutableElement& element) const {
-      return GroupHash()(element.get());
+      return element.hash();
     }
   };
 
   struct MutableElementEqual {
     bool operator()(const MutableElement& left, const MutableElement& right)
         const {
-      return GroupEqual()(left.get(), right.get());
+      return left.hash() == right.hash() &&
+          GroupEqual()(left.get(), right.get());
     }
   };
 
@@ -120,8 +165,8 @@ class GroupHashedSetAbstractDomain final
     }
   };
 
-  using Set = std::
-      unordered_set<MutableElement, MutableElementHash, MutableElementEqual>;
+  using Set = typename Storage::
+      template Set<MutableElement, MutableElementHash, MutableElementEqual>;
 
   using ConstIterator =
       boost::transform_iterator<ExposeElement, typename Set::const_iterator>;
@@ -212,7 +257,7 @@ class GroupHashedSetAbstractDomain final
       return;
     }
 
-    auto result = set_.emplace(element);
+    auto result = set_.emplace(MutableElement(element));
     if (!result.second) {
       // This is safe as long as `join_with` does not change the grouping
       result.first->get_unsafe().join_with(element);
@@ -318,13 +363,13 @@ class GroupHashedSetAbstractDomain final
     for (auto iterator = set_.begin(), end = set_.end(); iterator != end;) {
       // This is safe as long as `f` does not change the grouping.
       const MutableElement& mutable_element = *iterator;
-      auto previous_hash = MutableElementHash()(mutable_element);
       f(mutable_element.get_unsafe());
       if (mutable_element.get().is_bottom()) {
         iterator = set_.erase(iterator);
       } else {
-        auto current_hash = MutableElementHash()(mutable_element);
-        mt_assert_log(current_hash == previous_hash, "group hash has changed");
+        auto current_hash = GroupHash()(mutable_element.get());
+        mt_assert_log(
+            current_hash == mutable_element.hash(), "group hash has changed");
         ++iterator;
       }
     }
@@ -358,4 +403,21 @@ class GroupHashedSetAbstractDomain final
   Set set_;
 };
 
+/**
+ * Same as `GroupHashedSetAbstractDomain`, using a flat open-addressing hash
+ * table. This is faster for small and medium sets, at the cost of iterators
+ * being invalidated by insertions.
+ */
+template <
+    typename Element,
+    typename GroupHash,
+    typename GroupEqual,
+    typename GroupDifference = detail::GroupDifference<Element>>
+using FlatGroupHashedSetAbstractDomain = GroupHashedSetAbstractDomain<
+    Element,
+    GroupHash,
+    GroupEqual,
+    GroupDifference,
+    detail::FlatSetStorage>;
+
 } // namespace marianatrench
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <atomic>
+
+#include <mariana-trench/Assert.h>
+#include <mariana-trench/Heuristics.h>
+
+namespace marianatrench {
+
+static_assert(
+    Heuristics::kPrecisionLevels.size() ==
+    Heuristics::kPrecisionLevelMemoryThresholds.size() + 1);
+
+namespace {
+
+std::atomic<std::size_t> current_precision_level(0);
+
+// Zero means that there is no maximum.
+std::atomic<std::size_t> current_max_number_origins(0);
+std::atomic<std::size_t> collapsed_origins(0);
+
+} // namespace
+
+std::size_t Heuristics::precision_level_for_memory_usage(double memory_usage) {
+  std::size_t level = 0;
+  for (double threshold : kPrecisionLevelMemoryThresholds) {
+    if (memory_usage >= threshold) {
+      level++;
+    }
+  }
+  return level;
+}
+
+std::size_t Heuristics::precision_level() {
+  return current_precision_level.load(std::memory_order_relaxed);
+}
+
+void Heuristics::set_precision_level(std::size_t level) {
+  mt_assert(level < kPrecisionLevels.size());
+  current_precision_level.store(level, std::memory_order_relaxed);
+}
+
+std::optional<std::size_t> Heuristics::max_number_origins() {
+  auto maximum = current_max_number_origins.load(std::memory_order_relaxed);
+  if (maximum == 0) {
+    return std::nullopt;
+  }
+  return maximum;
+}
+
+void Heuristics::set_max_number_origins(std::optional<std::size_t> maximum) {
+  mt_assert(!maximum || *maximum > 0);
+  current_max_number_origins.store(
+      maximum.value_or(0), std::memory_order_relaxed);
+  collapsed_origins.store(0, std::memory_order_relaxed);
+}
+
+std::size_t Heuristics::number_collapsed_origins() {
+  return collapsed_origins.load(std::memory_order_relaxed);
+}
+
+void Heuristics::record_collapsed_origins() {
+  collapsed_origins.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace marianatrench
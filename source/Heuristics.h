@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <optional>
 
@@ -69,7 +70,28 @@ class Heuristics {
   constexpr static std::size_t kPropagationMaxPathSize = 2;
 
   /**
-   * Maximum number of global iterations before we abort.
+   * Analyzing a method for longer than this (in seconds) prints a warning.
+   */
+  constexpr static double kSlowMethodAnalysisTime = 10.0;
+
+  /**
+   * Number of times the model of a method can grow before it gets widened
+   * aggressively after each change. See `Model::approximate_unstable`.
+   */
+  constexpr static std::size_t kMaxNumberModelChangesBeforeWidening = 20;
+
+  /**
+   * Number of times the model of a method can grow before it also gets the
+   * `taint-in-taint-out` and `add-via-obscure-feature` modes. The method is
+   * still analyzed. Since widened models have a finite height, the global
+   * fixpoint terminates.
+   */
+  constexpr static std::size_t kMaxNumberModelChanges = 40;
+
+  /**
+   * Maximum number of global iterations. This is a last resort, the bound on
+   * model changes should stabilize all methods well before. Methods that are
+   * still scheduled are frozen with their current model.
    */
   constexpr static std::size_t kMaxNumberIterations = 150;
 
@@ -78,10 +100,85 @@ class Heuristics {
    */
   constexpr static std::size_t kMaxNumberLocalPositions = 20;
 
+  /**
+   * Suggested maximum number of origins per frame, for `--max-number-origins`.
+   */
+  constexpr static std::size_t kMaxNumberOrigins = 100;
+
   /**
    * Maximum depth of dependency graph traversal to find class properties.
    */
   constexpr static std::size_t kMaxDepthClassProperties = 10;
+
+  /**
+   * Limits that can be tightened at runtime when the analysis runs low on
+   * memory. See `kPrecisionLevels`.
+   */
+  struct PrecisionLimits {
+    std::size_t abstract_tree_widening_height;
+    std::size_t model_tree_max_leaves;
+    /* Do not join overrides at call sites above this number of overrides. */
+    std::optional<std::size_t> join_override_threshold;
+  };
+
+  /**
+   * Precision levels, from the most precise (i.e, the default) to the least
+   * precise.
+   *
+   * Level 0 uses the limits above. The join override threshold is applied
+   * during model generation at that level, hence there is no threshold
+   * during the global fixpoint.
+   */
+  constexpr static std::array<PrecisionLimits, 4> kPrecisionLevels = {{
+      {kAbstractTreeWideningHeight, kModelTreeMaxLeaves, std::nullopt},
+      {3, 10, 20},
+      {2, 5, 10},
+      {1, 2, 5},
+  }};
+
+  /**
+   * Memory usage, as a fraction of the memory limit, above which the analysis
+   * moves to the next precision level.
+   */
+  constexpr static std::array<double, 3> kPrecisionLevelMemoryThresholds = {
+      0.7,
+      0.8,
+      0.9};
+
+  /* Returns the precision level for the given fraction of memory used. */
+  static std::size_t precision_level_for_memory_usage(double memory_usage);
+
+  /* Current precision level, shared by all threads. */
+  static std::size_t precision_level();
+  static void set_precision_level(std::size_t level);
+
+  static const PrecisionLimits& precision_limits() {
+    return kPrecisionLevels[precision_level()];
+  }
+
+  static std::size_t abstract_tree_widening_height() {
+    return precision_limits().abstract_tree_widening_height;
+  }
+
+  static std::size_t model_tree_max_leaves() {
+    return precision_limits().model_tree_max_leaves;
+  }
+
+  static std::optional<std::size_t> join_override_threshold() {
+    return precision_limits().join_override_threshold;
+  }
+
+  /**
+   * Maximum number of origins per frame, shared by all threads. When reaching
+   * the maximum, origins are collapsed into top. There is no maximum by
+   * default, see `--max-number-origins`.
+   */
+  static std::optional<std::size_t> max_number_origins();
+  static void set_max_number_origins(std::optional<std::size_t> maximum);
+
+  /* Number of origin sets collapsed into top since the maximum was set. */
+  static std::size_t number_collapsed_origins();
+  static void record_collapsed_origins();
 };
 
 } // namespace marianatrench
@@ -5,12 +5,13 @@
  * LICENSE file in the root directory of this source tree.
  */
 
-#include <fstream>
+#include <boost/functional/hash.hpp>
 
 #include <DexUtil.h>
 #include <SpartaWorkQueue.h>
 
 #include <mariana-trench/Highlights.h>
+#include <mariana-trench/IssueStore.h>
 #include <mariana-trench/Log.h>
 #include <mariana-trench/Methods.h>
 #include <mariana-trench/Options.h>
@@ -24,6 +25,25 @@ using Bounds = Highlights::Bounds;
 using FileLines = Highlights::FileLines;
 enum class FrameType { Source, Sink };
 
+/**
+ * The callee and callee port of a non-leaf frame.
+ *
+ * We do not keep pointers to frames since models returned by the registry
+ * might not share their frames with it, e.g when the model is frozen.
+ */
+using CalleePort = std::pair<const Method*, AccessPath>;
+
+struct CalleePortHash {
+  std::size_t operator()(const CalleePort& callee_port) const {
+    std::size_t seed = 0;
+    boost::hash_combine(seed, callee_port.first);
+    boost::hash_combine(seed, std::hash<AccessPath>()(callee_port.second));
+    return seed;
+  }
+};
+
+using CalleePortSet = ConcurrentSet<CalleePort, CalleePortHash>;
+
 /*
  * Given a line and column that is assumed not to be a whitespace's position,
  * returns a Bounds object describing the location of the next non-whitespace
@@ -35,7 +55,7 @@ std::optional<Bounds> get_next_non_whitespace_position(
     std::size_t current_column) {
   current_column++;
   while (lines.has_line_number(current_line_number)) {
-    const auto& line = lines.line(current_line_number);
+    auto line = lines.line(current_line_number);
     while (current_column < line.length()) {
       if (!std::isspace(line[current_column])) {
         return Bounds(
@@ -51,7 +71,7 @@ std::optional<Bounds> get_next_non_whitespace_position(
   return std::nullopt;
 }
 
-Bounds remove_surrounding_whitespace(Bounds bounds, const std::string& line) {
+Bounds remove_surrounding_whitespace(Bounds bounds, std::string_view line) {
   auto new_start = bounds.start;
   auto new_end = bounds.end;
   while (new_start < bounds.end && std::isspace(line[new_start])) {
@@ -134,7 +154,7 @@ Bounds get_argument_bounds(
 }
 
 Bounds get_callee_this_parameter_bounds(
-    const std::string& line,
+    std::string_view line,
     const Bounds& callee_name_bounds) {
   auto callee_start = callee_name_bounds.start;
   if (callee_start - 1 < 0 || line[callee_start - 1] != '.') {
@@ -287,22 +307,21 @@ IssueSet augment_issue_positions(
 void get_frames_files_to_methods(
     ConcurrentMap<const std::string*, std::unordered_set<const Method*>>&
         issue_files_to_methods,
-    const ConcurrentSet<const Frame*>& frames,
+    const CalleePortSet& frames,
     const Context& context,
     const Registry& registry,
     FrameType frame_type) {
-  auto frames_to_check = std::make_unique<ConcurrentSet<const Frame*>>(frames);
-  auto seen_frames = std::make_unique<ConcurrentSet<const Frame*>>(frames);
+  auto frames_to_check = std::make_unique<CalleePortSet>(frames);
+  auto seen_frames = std::make_unique<CalleePortSet>(frames);
 
   while (frames_to_check->size() != 0) {
-    auto new_frames_to_check = std::make_unique<ConcurrentSet<const Frame*>>();
-    auto queue = sparta::work_queue<const Frame*>([&](const Frame* frame) {
-      const auto* callee = frame->callee();
+    auto new_frames_to_check = std::make_unique<CalleePortSet>();
+    auto queue = sparta::work_queue<CalleePort>([&](const CalleePort& frame) {
+      const auto& [callee, callee_port] = frame;
       if (!callee) {
         return;
       }
       auto callee_model = registry.get(callee);
-      const auto& callee_port = frame->callee_port();
       const auto* method_position = context.positions->get(callee);
       if (method_position && method_position->path()) {
         issue_files_to_methods.update(
@@ -319,10 +338,14 @@ void get_frames_files_to_methods(
         taint = callee_model.sinks().raw_read(callee_port).root();
       }
       for (const auto& callee_frame : taint.frames_iterator()) {
-        if (callee_frame.is_leaf() || !seen_frames->emplace(&callee_frame)) {
+        if (callee_frame.is_leaf()) {
           continue;
         }
-        new_frames_to_check->emplace(&callee_frame);
+        auto next =
+            CalleePort(callee_frame.callee(), callee_frame.callee_port());
+        if (seen_frames->emplace(next)) {
+          new_frames_to_check->emplace(next);
+        }
       }
     });
     for (const auto& frame : *frames_to_check) {
@@ -343,26 +366,29 @@ ConcurrentMap<const std::string*, std::unordered_set<const Method*>>
 get_issue_files_to_methods(const Context& context, const Registry& registry) {
   ConcurrentMap<const std::string*, std::unordered_set<const Method*>>
       issue_files_to_methods;
-  ConcurrentSet<const Frame*> sources;
-  ConcurrentSet<const Frame*> sinks;
+  CalleePortSet sources;
+  CalleePortSet sinks;
 
   auto queue = sparta::work_queue<const Method*>([&](const Method* method) {
-    auto model = registry.get(method);
-    if (model.issues().size() == 0) {
+    auto issues = registry.get(method).issues();
+    if (context.issue_store != nullptr) {
+      issues.join_with(context.issue_store->get(method));
+    }
+    if (issues.size() == 0) {
       return;
     }
-    for (const auto& issue : model.issues()) {
+    for (const auto& issue : issues) {
       const auto& issue_sinks = issue.sinks();
       for (const auto& sink : issue_sinks.frames_iterator()) {
         if (!sink.is_leaf()) {
-          sinks.emplace(&sink);
+          sinks.emplace(CalleePort(sink.callee(), sink.callee_port()));
         }
       }
 
       const auto& issue_sources = issue.sources();
       for (const auto& source : issue_sources.frames_iterator()) {
         if (!source.is_leaf()) {
-          sources.emplace(&source);
+          sources.emplace(CalleePort(source.callee(), source.callee_port()));
         }
       }
     }
@@ -390,24 +416,26 @@ get_issue_files_to_methods(const Context& context, const Registry& registry) {
 
 } // namespace
 
-FileLines::FileLines(std::ifstream& stream) {
-  std::string line;
-  while (std::getline(stream, line)) {
-    lines_.push_back(line);
+FileLines::FileLines(const std::vector<std::string>& lines) {
+  std::string content;
+  for (const auto& line : lines) {
+    content.append(line);
+    content.push_back('\n');
   }
+  file_ = std::make_shared<const SourceFile>(std::move(content));
 }
 
 bool FileLines::has_line_number(std::size_t index) const {
-  return index >= 1 && index <= lines_.size();
+  return file_->has_line_number(index);
 }
 
-const std::string& FileLines::line(std::size_t index) const {
+std::string_view FileLines::line(std::size_t index) const {
   mt_assert(has_line_number(index));
-  return lines_[index - 1];
+  return file_->line(index);
 }
 
 std::size_t FileLines::size() const {
-  return lines_.size();
+  return file_->size();
 }
 
 Bounds Highlights::get_local_position_bounds(
@@ -499,12 +527,12 @@ void Highlights::augment_positions(Registry& registry, const Context& context) {
   auto issue_files_to_methods = get_issue_files_to_methods(context, registry);
   auto file_queue =
       sparta::work_queue<const std::string*>([&](const std::string* filepath) {
-        std::ifstream stream(*filepath);
-        if (stream.bad()) {
+        std::shared_ptr<const SourceFile> file = SourceFile::open(*filepath);
+        if (file == nullptr) {
           WARNING(1, "File {} was not found.", *filepath);
           return;
         }
-        auto lines = FileLines(stream);
+        auto lines = FileLines(std::move(file));
         for (const auto* method : issue_files_to_methods.get(filepath, {})) {
           const auto old_model = registry.get(method);
           auto new_model = old_model;
@@ -517,6 +545,12 @@ void Highlights::augment_positions(Registry& registry, const Context& context) {
           new_model.set_parameter_sources(augment_taint_tree_positions(
               old_model.parameter_sources(), lines, context));
           registry.set(new_model);
+          if (context.issue_store != nullptr) {
+            context.issue_store->set(
+                method,
+                augment_issue_positions(
+                    context.issue_store->get(method), lines, context));
+          }
         }
       });
 
@@ -7,7 +7,11 @@
 
 #pragma once
 
+#include <memory>
+#include <string_view>
+
 #include <mariana-trench/Registry.h>
+#include <mariana-trench/SourceFile.h>
 
 namespace marianatrench {
 
@@ -35,21 +39,23 @@ class Highlights {
 
   /*
    * Representation of the lines in a file. Used to prevent off-by-1 errors as
-   * lines in files are 1-indexed while cpp vectors are 0-indexed
+   * lines in files are 1-indexed while cpp vectors are 0-indexed. Lines are
+   * views into the underlying source file.
    */
   class FileLines {
    public:
-    explicit FileLines(const std::vector<std::string>& lines) : lines_(lines) {}
-    explicit FileLines(std::ifstream& stream);
+    explicit FileLines(const std::vector<std::string>& lines);
+    explicit FileLines(std::shared_ptr<const SourceFile> file)
+        : file_(std::move(file)) {}
 
     bool has_line_number(std::size_t index) const;
 
-    const std::string& line(std::size_t index) const;
+    std::string_view line(std::size_t index) const;
 
     std::size_t size() const;
 
    private:
-    std::vector<std::string> lines_;
+    std::shared_ptr<const SourceFile> file_;
   };
 
   static Bounds get_callee_highlight_bounds(
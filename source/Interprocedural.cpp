@@ -5,6 +5,11 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <atomic>
+#include <optional>
+#include <utility>
+#include <vector>
+
 #include <fmt/format.h>
 
 #include <AbstractDomain.h>
@@ -20,15 +25,20 @@
 #include <mariana-trench/ClassProperties.h>
 #include <mariana-trench/Context.h>
 #include <mariana-trench/Dependencies.h>
+#include <mariana-trench/DuplicateMethods.h>
+#include <mariana-trench/Heuristics.h>
 #include <mariana-trench/Interprocedural.h>
+#include <mariana-trench/IssueStore.h>
 #include <mariana-trench/Log.h>
 #include <mariana-trench/Methods.h>
 #include <mariana-trench/OperatingSystem.h>
 #include <mariana-trench/Overrides.h>
+#include <mariana-trench/ReplaySnapshot.h>
 #include <mariana-trench/Scheduler.h>
 #include <mariana-trench/Statistics.h>
 #include <mariana-trench/Timer.h>
 #include <mariana-trench/Transfer.h>
+#include <mariana-trench/TrivialMethods.h>
 
 namespace marianatrench {
 
@@ -104,7 +114,42 @@ std::string show_control_flow_graph(const cfg::ControlFlowGraph& cfg) {
   return string;
 }
 
-Model analyze(
+/**
+ * Tighten the heuristics for the remaining iterations when the memory used
+ * gets close to the memory limit. The precision is never restored.
+ */
+void adjust_precision(
+    Context& context,
+    std::size_t iteration,
+    double resident_set_size,
+    double memory_limit) {
+  if (resident_set_size < 0.0 || memory_limit <= 0.0) {
+    return;
+  }
+
+  auto level = Heuristics::precision_level_for_memory_usage(
+      resident_set_size / memory_limit);
+  if (level <= Heuristics::precision_level()) {
+    return;
+  }
+
+  Heuristics::set_precision_level(level);
+  context.statistics->log_precision_level(iteration, level, resident_set_size);
+  const auto& limits = Heuristics::precision_limits();
+  WARNING(
+      1,
+      "Memory used ({:.2f}GB) is close to the limit ({:.2f}GB), reducing precision to level {}: widening height {}, maximum leaves {}, join override threshold {}.",
+      resident_set_size,
+      memory_limit,
+      level,
+      limits.abstract_tree_widening_height,
+      limits.model_tree_max_leaves,
+      limits.join_override_threshold ? *limits.join_override_threshold : 0);
+}
+
+} // namespace
+
+Model Interprocedural::analyze(
     Context& global_context,
     const Registry& registry,
     const Model& old_model) {
@@ -148,7 +193,7 @@ Model analyze(
 
   global_context.statistics->log_time(method, timer);
   auto duration = timer.duration_in_seconds();
-  if (duration > 10.0) {
+  if (duration > Heuristics::kSlowMethodAnalysisTime) {
     WARNING(1, "Analyzing `{}` took {:.2f}s!", method->show(), duration);
   }
   auto slow_method_bound =
@@ -168,17 +213,73 @@ Model analyze(
   return model;
 }
 
-} // namespace
-
 void Interprocedural::run_analysis(Context& context, Registry& registry) {
+  // The precision level is process-wide, reset it in case of a previous run.
+  Heuristics::set_precision_level(0);
+  auto memory_limit = context.options->memory_limit()
+      ? *context.options->memory_limit()
+      : total_memory_in_gb();
+
+  Timer trivial_methods_timer;
+  auto trivial_methods = TrivialMethods::summarize_all(context, registry);
+  context.statistics->log_time("trivial_methods", trivial_methods_timer);
+  LOG(1,
+      "Summarized {} trivial methods in {:.2f}s.",
+      trivial_methods.size(),
+      trivial_methods_timer.duration_in_seconds());
+
+  Timer duplicate_methods_timer;
+  auto duplicate_methods = DuplicateMethods(context, registry);
+  context.statistics->log_time("duplicate_methods", duplicate_methods_timer);
+  LOG(1,
+      "Found {} duplicate methods in {:.2f}s.",
+      duplicate_methods.size(),
+      duplicate_methods_timer.duration_in_seconds());
+  std::atomic<std::size_t> duplicate_analyses(0);
+  std::atomic<std::size_t> shared_analyses(0);
+
+  // Number of times the model of each method changed, used to detect methods
+  // that do not stabilize.
+  ConcurrentMap<const Method*, std::size_t> model_changes;
+  ConcurrentSet<const Method*> widened_methods;
+  ConcurrentSet<const Method*> obscured_methods;
+
+  // When issues are streamed, they are kept out of the registry: callers never
+  // read them. Issues of a method are spilled to the issue store as soon as the
+  // method is stable.
+  auto* issue_store = context.issue_store.get();
+  ConcurrentMap<const Method*, IssueSet> pending_issues;
+
+  // Inputs of methods to replay, see `ReplaySnapshot`.
+  ReplaySnapshots replay_snapshots;
+
   LOG(1, "Computing global fixpoint...");
   auto methods_to_analyze = std::make_unique<ConcurrentSet<const Method*>>();
   for (const auto* method : *context.methods) {
-    methods_to_analyze->insert(method);
+    // Trivial methods do not call anything, hence they are never scheduled
+    // again by the fixpoint.
+    if (trivial_methods.count(method) == 0) {
+      methods_to_analyze->insert(method);
+    }
   }
 
+  std::vector<const Method*> stopped_methods;
   std::size_t iteration = 0;
   while (methods_to_analyze->size() > 0) {
+    if (iteration >= Heuristics::kMaxNumberIterations) {
+      WARNING(
+          1,
+          "Global fixpoint did not converge after {} iterations, stopping the analysis of {} methods.",
+          iteration,
+          methods_to_analyze->size());
+      for (const auto* method : *methods_to_analyze) {
+        LOG(2, "Stopping the analysis of `{}`.", method->show());
+        registry.freeze(method);
+        stopped_methods.push_back(method);
+      }
+      break;
+    }
+
     Timer iteration_timer;
     iteration++;
 
@@ -189,16 +290,7 @@ void Interprocedural::run_analysis(Context& context, Registry& registry) {
         iteration,
         methods_to_analyze->size(),
         resident_set_size);
-
-    if (iteration > Heuristics::kMaxNumberIterations) {
-      ERROR(1, "Too many iterations");
-      std::string message = "Unstable methods are:";
-      for (const auto* method : *methods_to_analyze) {
-        message.append(fmt::format("\n`{}`", method->show()));
-      }
-      LOG(1, message);
-      throw std::runtime_error("Too many iterations, exiting.");
-    }
+    adjust_precision(context, iteration, resident_set_size, memory_limit);
 
     auto new_methods_to_analyze =
         std::make_unique<ConcurrentSet<const Method*>>();
@@ -209,53 +301,156 @@ void Interprocedural::run_analysis(Context& context, Registry& registry) {
       threads = 1u;
     }
 
+    // Duplicates are analyzed after their representative, so that they can
+    // reuse its result.
+    ConcurrentSet<const Method*> representative_methods;
+    ConcurrentSet<const Method*> duplicate_methods_to_analyze;
+    for (const auto* method : *methods_to_analyze) {
+      const auto* representative = duplicate_methods.representative(method);
+      if (representative != nullptr &&
+          methods_to_analyze->count(representative) > 0) {
+        duplicate_methods_to_analyze.insert(method);
+      } else {
+        representative_methods.insert(method);
+      }
+    }
+
+    // Previous and new models of representatives analyzed in this iteration.
+    ConcurrentMap<const Method*, std::pair<Model, Model>>
+        representative_models;
+
     std::atomic<std::size_t> method_iteration(0);
-    auto queue = sparta::work_queue<const Method*>(
-        [&](const Method* method) {
-          method_iteration++;
-          if (method_iteration % 10000 == 0) {
-            LOG(1,
-                "Processed {}/{} methods.",
-                method_iteration.load(),
-                methods_to_analyze->size());
-          } else if (method_iteration % 100 == 0) {
-            LOG(4,
-                "Processed {}/{} methods.",
-                method_iteration.load(),
-                methods_to_analyze->size());
-          }
+    auto analyze_method = [&](const Method* method) {
+      method_iteration++;
+      if (method_iteration % 10000 == 0) {
+        LOG(1,
+            "Processed {}/{} methods.",
+            method_iteration.load(),
+            methods_to_analyze->size());
+      } else if (method_iteration % 100 == 0) {
+        LOG(4,
+            "Processed {}/{} methods.",
+            method_iteration.load(),
+            methods_to_analyze->size());
+      }
 
-          const auto old_model = registry.get(method);
-          if (old_model.skip_analysis()) {
-            LOG(3, "Skipping `{}`...", method->show());
-            return;
-          }
+      const auto old_model = registry.get(method);
+      if (old_model.skip_analysis()) {
+        LOG(3, "Skipping `{}`...", method->show());
+        return;
+      }
 
-          auto new_model = analyze(context, registry, old_model);
+      std::optional<Model> new_model;
+      if (duplicate_methods_to_analyze.count(method) > 0) {
+        const auto* representative = duplicate_methods.representative(method);
+        duplicate_analyses++;
+        auto found = representative_models.find(representative);
+        if (found != representative_models.end()) {
+          new_model = DuplicateMethods::share(
+              context,
+              method,
+              old_model,
+              /* representative_old_model */ found->second.first,
+              /* representative_new_model */ found->second.second);
+        }
+        if (new_model) {
+          shared_analyses++;
+          LOG(4,
+              "Reusing the analysis of `{}` for `{}`.",
+              representative->show(),
+              method->show());
+        }
+      }
+      if (!new_model) {
+        Timer analysis_timer;
+        new_model = analyze(context, registry, old_model);
+        replay_snapshots.record(
+            context,
+            registry,
+            old_model,
+            analysis_timer.duration_in_seconds());
+        if (duplicate_methods.has_duplicates(method)) {
+          representative_models.emplace(
+              method, std::make_pair(old_model, *new_model));
+        }
+      }
 
-          new_model.join_with(old_model);
+      new_model->join_with(old_model);
 
-          if (!new_model.leq(old_model)) {
-            if (!context.call_graph->callees(method).empty() ||
-                !context.call_graph->artificial_callees(method).empty()) {
-              new_methods_to_analyze->insert(method);
-            }
-            for (const auto* dependency :
-                 context.dependencies->dependencies(method)) {
-              new_methods_to_analyze->insert(dependency);
-            }
+      if (issue_store != nullptr && !new_model->issues().is_bottom()) {
+        pending_issues.update(
+            method,
+            [&](const Method* /* method */,
+                IssueSet& issues,
+                bool /* exists */) { issues.join_with(new_model->issues()); });
+        new_model->set_issues({});
+      }
+
+      if (!new_model->leq(old_model)) {
+        std::size_t changes = 0;
+        model_changes.update(
+            method,
+            [&](const Method* /* method */,
+                std::size_t& count,
+                bool /* exists */) { changes = ++count; });
+        if (changes >= Heuristics::kMaxNumberModelChanges) {
+          // The method is still analyzed, so that its model keeps up with
+          // its callees, but callers also treat it as obscure.
+          if (changes == Heuristics::kMaxNumberModelChanges) {
+            WARNING(
+                1,
+                "Model of `{}` changed {} times, treating it as obscure.",
+                method->show(),
+                changes);
           }
+          new_model->approximate_unstable();
+          new_model->add_mode(Model::Mode::AddViaObscureFeature, context);
+          new_model->add_mode(Model::Mode::TaintInTaintOut, context);
+          obscured_methods.insert(method);
+        } else if (
+            changes >= Heuristics::kMaxNumberModelChangesBeforeWidening) {
+          LOG(2,
+              "Model of `{}` changed {} times, widening it.",
+              method->show(),
+              changes);
+          new_model->approximate_unstable();
+          widened_methods.insert(method);
+        }
 
-          registry.set(new_model);
-        },
-        threads);
-    context.scheduler->schedule(
-        *methods_to_analyze,
-        [&](const Method* method, std::size_t worker_id) {
-          queue.add_item(method, worker_id);
-        },
-        threads);
-    queue.run_all();
+        if (!context.call_graph->callees(method).empty() ||
+            !context.call_graph->artificial_callees(method).empty()) {
+          new_methods_to_analyze->insert(method);
+        }
+        for (const auto* dependency :
+             context.dependencies->dependencies(method)) {
+          new_methods_to_analyze->insert(dependency);
+        }
+        registry.set(*new_model);
+      } else {
+        // The model is stable, keep it in its compact form until it
+        // changes again.
+        registry.freeze(method);
+        if (issue_store != nullptr) {
+          auto issues = pending_issues.get(method, IssueSet::bottom());
+          if (!issues.is_bottom()) {
+            issue_store->append(method, issues);
+            pending_issues.erase(method);
+          }
+        }
+      }
+    };
+
+    for (const auto* methods :
+         {&representative_methods, &duplicate_methods_to_analyze}) {
+      auto queue = sparta::work_queue<const Method*>(analyze_method, threads);
+      context.scheduler->schedule(
+          *methods,
+          [&](const Method* method, std::size_t worker_id) {
+            queue.add_item(method, worker_id);
+          },
+          threads);
+      queue.run_all();
+    }
 
     LOG(2,
         "Global fixpoint iteration completed in {:.2f}s.",
@@ -264,7 +459,36 @@ void Interprocedural::run_analysis(Context& context, Registry& registry) {
     methods_to_analyze = std::move(new_methods_to_analyze);
   }
 
+  if (issue_store != nullptr) {
+    for (const auto& [method, issues] : pending_issues) {
+      issue_store->append(method, issues);
+    }
+    LOG(1,
+        "Spilled issues of {} methods to the issue store ({} records, {:.2f}MB).",
+        issue_store->methods().size(),
+        issue_store->records_size(),
+        static_cast<double>(issue_store->size()) / (1024.0 * 1024.0));
+  }
+
+  replay_snapshots.write(context);
+
   context.statistics->log_number_iterations(iteration);
+  context.statistics->log_unstable_methods(
+      std::vector<const Method*>(
+          widened_methods.begin(), widened_methods.end()),
+      std::vector<const Method*>(
+          obscured_methods.begin(), obscured_methods.end()),
+      std::move(stopped_methods));
+  if (!obscured_methods.empty()) {
+    WARNING(
+        1,
+        "Treated {} methods that did not stabilize as obscure.",
+        obscured_methods.size());
+  }
+  context.statistics->log_duplicate_methods(
+      duplicate_methods.size(),
+      duplicate_analyses.load(),
+      shared_analyses.load());
   LOG(2, "Global fixpoint reached.");
 }
 
@@ -15,6 +15,10 @@ namespace marianatrench {
 class Interprocedural final {
  public:
   static void run_analysis(Context& context, Registry& registry);
+
+  /* Analyze the method of the given model once, using the given registry. */
+  static Model
+  analyze(Context& context, const Registry& registry, const Model& old_model);
 };
 
 } // namespace marianatrench
@@ -0,0 +1,498 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include <mariana-trench/Assert.h>
+#include <mariana-trench/Frame.h>
+#include <mariana-trench/IssueStore.h>
+#include <mariana-trench/Log.h>
+
+namespace marianatrench {
+
+namespace {
+
+std::runtime_error system_error(
+    const std::string& operation,
+    const boost::filesystem::path& path) {
+  return std::runtime_error(fmt::format(
+      "Issue store: {} `{}` failed: {}",
+      operation,
+      path.string(),
+      std::strerror(errno)));
+}
+
+/* State of a domain that can be bottom or top. */
+enum class State : std::uint64_t {
+  Bottom = 0,
+  Value = 1,
+  Top = 2,
+};
+
+class Writer final {
+ public:
+  void write_integer(std::uint64_t value) {
+    buffer_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  void write_state(State state) {
+    write_integer(static_cast<std::uint64_t>(state));
+  }
+
+  void write_pointer(const void* MT_NULLABLE pointer) {
+    write_integer(reinterpret_cast<std::uintptr_t>(pointer));
+  }
+
+  void write_string(const std::string& string) {
+    write_integer(string.size());
+    buffer_.append(string);
+  }
+
+  template <typename Container>
+  void write_pointers(const Container& container) {
+    std::vector<const void*> pointers;
+    for (const auto* pointer : container) {
+      pointers.push_back(pointer);
+    }
+    write_integer(pointers.size());
+    for (const auto* pointer : pointers) {
+      write_pointer(pointer);
+    }
+  }
+
+  std::string& buffer() {
+    return buffer_;
+  }
+
+ private:
+  std::string buffer_;
+};
+
+class Reader final {
+ public:
+  explicit Reader(std::string_view data) : data_(data) {}
+
+  std::uint64_t read_integer() {
+    mt_assert(data_.size() >= sizeof(std::uint64_t));
+    std::uint64_t value;
+    std::memcpy(&value, data_.data(), sizeof(value));
+    data_.remove_prefix(sizeof(value));
+    return value;
+  }
+
+  State read_state() {
+    return static_cast<State>(read_integer());
+  }
+
+  template <typename T>
+  const T* MT_NULLABLE read_pointer() {
+    return reinterpret_cast<const T*>(
+        static_cast<std::uintptr_t>(read_integer()));
+  }
+
+  std::string read_string() {
+    auto size = read_integer();
+    mt_assert(data_.size() >= size);
+    auto string = std::string(data_.substr(0, size));
+    data_.remove_prefix(size);
+    return string;
+  }
+
+  template <typename T, typename Function>
+  void read_pointers(const Function& add) {
+    auto size = read_integer();
+    for (std::uint64_t index = 0; index < size; index++) {
+      add(read_pointer<T>());
+    }
+  }
+
+  bool empty() const {
+    return data_.empty();
+  }
+
+ private:
+  std::string_view data_;
+};
+
+Root read_root(Reader& reader) {
+  return Root::decode(
+      static_cast<Root::IntegerEncoding>(reader.read_integer()));
+}
+
+void write_access_path(Writer& writer, const AccessPath& access_path) {
+  writer.write_integer(access_path.root().encode());
+  writer.write_pointers(access_path.path());
+}
+
+AccessPath read_access_path(Reader& reader) {
+  auto root = read_root(reader);
+  Path path;
+  reader.read_pointers<DexString>(
+      [&](const DexString* element) { path.append(element); });
+  return AccessPath(root, std::move(path));
+}
+
+template <typename Set>
+void write_pointer_set(Writer& writer, const Set& set) {
+  if (set.is_top()) {
+    writer.write_state(State::Top);
+  } else {
+    writer.write_state(State::Value);
+    writer.write_pointers(set);
+  }
+}
+
+template <typename Set, typename Element>
+Set read_pointer_set(Reader& reader) {
+  if (reader.read_state() == State::Top) {
+    return Set::top();
+  }
+  Set set;
+  reader.read_pointers<Element>(
+      [&](const Element* element) { set.add(element); });
+  return set;
+}
+
+void write_features(Writer& writer, const FeatureMayAlwaysSet& features) {
+  if (features.is_bottom()) {
+    writer.write_state(State::Bottom);
+  } else if (features.is_top()) {
+    writer.write_state(State::Top);
+  } else {
+    writer.write_state(State::Value);
+    writer.write_pointers(features.may());
+    writer.write_pointers(features.always());
+  }
+}
+
+FeatureMayAlwaysSet read_features(Reader& reader) {
+  switch (reader.read_state()) {
+    case State::Bottom:
+      return FeatureMayAlwaysSet::bottom();
+    case State::Top:
+      return FeatureMayAlwaysSet::top();
+    case State::Value:
+      break;
+  }
+  FeatureSet may;
+  reader.read_pointers<Feature>(
+      [&](const Feature* feature) { may.add(feature); });
+  FeatureSet always;
+  reader.read_pointers<Feature>(
+      [&](const Feature* feature) { always.add(feature); });
+  return FeatureMayAlwaysSet(may, always);
+}
+
+void write_roots(Writer& writer, const RootSetAbstractDomain& roots) {
+  if (roots.is_top()) {
+    writer.write_state(State::Top);
+    return;
+  }
+  writer.write_state(State::Value);
+  writer.write_integer(roots.elements().size());
+  for (const auto& root : roots.elements()) {
+    writer.write_integer(root.encode());
+  }
+}
+
+RootSetAbstractDomain read_roots(Reader& reader) {
+  if (reader.read_state() == State::Top) {
+    return RootSetAbstractDomain::top();
+  }
+  RootSetAbstractDomain roots;
+  auto size = reader.read_integer();
+  for (std::uint64_t index = 0; index < size; index++) {
+    roots.add(read_root(reader));
+  }
+  return roots;
+}
+
+void write_local_positions(
+    Writer& writer,
+    const LocalPositionSet& local_positions) {
+  if (local_positions.is_bottom()) {
+    writer.write_state(State::Bottom);
+  } else if (local_positions.is_top()) {
+    writer.write_state(State::Top);
+  } else {
+    writer.write_state(State::Value);
+    writer.write_pointers(local_positions.elements());
+  }
+}
+
+LocalPositionSet read_local_positions(Reader& reader) {
+  switch (reader.read_state()) {
+    case State::Bottom:
+      return LocalPositionSet::bottom();
+    case State::Top:
+      return LocalPositionSet::top();
+    case State::Value:
+      break;
+  }
+  LocalPositionSet local_positions;
+  reader.read_pointers<Position>(
+      [&](const Position* position) { local_positions.add(position); });
+  return local_positions;
+}
+
+void write_canonical_names(
+    Writer& writer,
+    const CanonicalNameSetAbstractDomain& canonical_names) {
+  if (canonical_names.is_top()) {
+    writer.write_state(State::Top);
+    return;
+  }
+  writer.write_state(State::Value);
+  writer.write_integer(canonical_names.elements().size());
+  for (const auto& canonical_name : canonical_names.elements()) {
+    if (auto value = canonical_name.template_value()) {
+      writer.write_integer(0);
+      writer.write_string(*value);
+    } else {
+      writer.write_integer(1);
+      writer.write_string(*canonical_name.instantiated_value());
+    }
+  }
+}
+
+CanonicalNameSetAbstractDomain read_canonical_names(Reader& reader) {
+  if (reader.read_state() == State::Top) {
+    return CanonicalNameSetAbstractDomain::top();
+  }
+  CanonicalNameSetAbstractDomain canonical_names;
+  auto size = reader.read_integer();
+  for (std::uint64_t index = 0; index < size; index++) {
+    bool is_template = reader.read_integer() == 0;
+    auto value = reader.read_string();
+    if (is_template) {
+      canonical_names.add(
+          CanonicalName(CanonicalName::TemplateValue{std::move(value)}));
+    } else {
+      canonical_names.add(
+          CanonicalName(CanonicalName::InstantiatedValue{std::move(value)}));
+    }
+  }
+  return canonical_names;
+}
+
+void write_frame(Writer& writer, const Frame& frame) {
+  writer.write_pointer(frame.kind());
+  write_access_path(writer, frame.callee_port());
+  writer.write_pointer(frame.callee());
+  writer.write_pointer(frame.field_callee());
+  writer.write_pointer(frame.call_position());
+  writer.write_integer(static_cast<std::uint64_t>(frame.distance()));
+  write_pointer_set(writer, frame.origins());
+  write_pointer_set(writer, frame.field_origins());
+  write_features(writer, frame.inferred_features());
+  write_features(writer, frame.locally_inferred_features());
+  writer.write_pointers(frame.user_features());
+  write_roots(writer, frame.via_type_of_ports());
+  write_roots(writer, frame.via_value_of_ports());
+  write_local_positions(writer, frame.local_positions());
+  write_canonical_names(writer, frame.canonical_names());
+}
+
+Frame read_frame(Reader& reader) {
+  const auto* kind = reader.read_pointer<Kind>();
+  auto callee_port = read_access_path(reader);
+  const auto* callee = reader.read_pointer<Method>();
+  const auto* field_callee = reader.read_pointer<Field>();
+  const auto* call_position = reader.read_pointer<Position>();
+  auto distance = static_cast<int>(reader.read_integer());
+  auto origins = read_pointer_set<MethodSet, Method>(reader);
+  auto field_origins = read_pointer_set<FieldSet, Field>(reader);
+  auto inferred_features = read_features(reader);
+  auto locally_inferred_features = read_features(reader);
+  FeatureSet user_features;
+  reader.read_pointers<Feature>(
+      [&](const Feature* feature) { user_features.add(feature); });
+  auto via_type_of_ports = read_roots(reader);
+  auto via_value_of_ports = read_roots(reader);
+  auto local_positions = read_local_positions(reader);
+  auto canonical_names = read_canonical_names(reader);
+  return Frame(
+      kind,
+      std::move(callee_port),
+      callee,
+      field_callee,
+      call_position,
+      distance,
+      std::move(origins),
+      std::move(field_origins),
+      std::move(inferred_features),
+      std::move(locally_inferred_features),
+      std::move(user_features),
+      std::move(via_type_of_ports),
+      std::move(via_value_of_ports),
+      std::move(local_positions),
+      std::move(canonical_names));
+}
+
+void write_taint(Writer& writer, const Taint& taint) {
+  std::vector<Frame> frames;
+  for (const auto& frame : taint.frames_iterator()) {
+    frames.push_back(frame);
+  }
+  writer.write_integer(frames.size());
+  for (const auto& frame : frames) {
+    write_frame(writer, frame);
+  }
+}
+
+Taint read_taint(Reader& reader) {
+  Taint taint;
+  auto size = reader.read_integer();
+  for (std::uint64_t index = 0; index < size; index++) {
+    taint.add(read_frame(reader));
+  }
+  return taint;
+}
+
+std::string write_issues(const IssueSet& issues) {
+  Writer writer;
+  // Reserve space for the size of the record.
+  writer.write_integer(0);
+  for (const auto& issue : issues) {
+    write_taint(writer, issue.sources());
+    write_taint(writer, issue.sinks());
+    writer.write_pointer(issue.rule());
+    writer.write_pointer(issue.position());
+  }
+  auto& record = writer.buffer();
+  std::uint64_t size = record.size() - sizeof(std::uint64_t);
+  std::memcpy(record.data(), &size, sizeof(size));
+  return std::move(record);
+}
+
+void read_issues(Reader& reader, IssueSet& issues) {
+  while (!reader.empty()) {
+    auto sources = read_taint(reader);
+    auto sinks = read_taint(reader);
+    const auto* rule = reader.read_pointer<Rule>();
+    const auto* position = reader.read_pointer<Position>();
+    issues.add(Issue(std::move(sources), std::move(sinks), rule, position));
+  }
+}
+
+} // namespace
+
+IssueStore::IssueStore(boost::filesystem::path path)
+    : path_(std::move(path)), file_(-1), size_(0), records_size_(0) {
+  file_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+  if (file_ < 0) {
+    throw system_error("open", path_);
+  }
+  // Records are only accessed through the descriptor. Unlinking the file right
+  // away guarantees that the disk space is reclaimed, even on a crash.
+  if (::unlink(path_.c_str()) != 0) {
+    ::close(file_);
+    throw system_error("unlink", path_);
+  }
+}
+
+IssueStore::~IssueStore() {
+  ::close(file_);
+}
+
+void IssueStore::append(const Method* method, const IssueSet& issues) {
+  if (issues.is_bottom()) {
+    return;
+  }
+  auto offset = write(write_issues(issues));
+  offsets_.update(
+      method,
+      [&](const Method* /* method */,
+          std::vector<std::uint64_t>& offsets,
+          bool /* exists */) { offsets.push_back(offset); });
+}
+
+void IssueStore::set(const Method* method, const IssueSet& issues) {
+  if (issues.is_bottom()) {
+    offsets_.erase(method);
+    return;
+  }
+  auto offset = write(write_issues(issues));
+  offsets_.insert_or_assign(
+      std::make_pair(method, std::vector<std::uint64_t>{offset}));
+}
+
+IssueSet IssueStore::get(const Method* method) const {
+  IssueSet issues;
+  for (auto offset : offsets_.get(method, /* default */ {})) {
+    std::uint64_t size;
+    if (::pread(file_, &size, sizeof(size), offset) !=
+        static_cast<ssize_t>(sizeof(size))) {
+      throw system_error("read", path_);
+    }
+    std::string record(size, '\0');
+    if (::pread(file_, record.data(), size, offset + sizeof(size)) !=
+        static_cast<ssize_t>(size)) {
+      throw system_error("read", path_);
+    }
+    auto reader = Reader(record);
+    read_issues(reader, issues);
+  }
+  return issues;
+}
+
+std::vector<const Method*> IssueStore::methods() const {
+  std::vector<const Method*> methods;
+  for (const auto& [method, _offsets] : offsets_) {
+    methods.push_back(method);
+  }
+  return methods;
+}
+
+std::size_t IssueStore::records_size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return records_size_;
+}
+
+std::uint64_t IssueStore::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_;
+}
+
+std::uint64_t IssueStore::write(const std::string& record) {
+  std::uint64_t offset;
+  {
+    // Only reserve space under the lock, records are written concurrently.
+    std::lock_guard<std::mutex> lock(mutex_);
+    offset = size_;
+    size_ += record.size();
+    records_size_++;
+  }
+
+  std::size_t written = 0;
+  while (written < record.size()) {
+    auto result = ::pwrite(
+        file_,
+        record.data() + written,
+        record.size() - written,
+        offset + written);
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw system_error("write", path_);
+    }
+    written += result;
+  }
+  return offset;
+}
+
+} // namespace marianatrench
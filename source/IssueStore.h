@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include <ConcurrentContainers.h>
+
+#include <mariana-trench/IssueSet.h>
+#include <mariana-trench/Method.h>
+
+namespace marianatrench {
+
+/**
+ * Append-only store of issues on disk, used to keep the issues of stable
+ * methods out of memory during the analysis (see `--stream-issues`).
+ *
+ * Each record holds issues of a single method. The issues of a method are the
+ * join of all its records, which lets the analysis spill the issues of a
+ * method again if it is re-analyzed later.
+ *
+ * Records are only read back by the process that wrote them. Kinds, methods,
+ * positions, features and rules are interned for the lifetime of the process,
+ * hence they are written as their address. This makes the serialization
+ * lossless and cheap, but the file is not meant to be read by other tools.
+ */
+class IssueStore final {
+ public:
+  /**
+   * Create an empty store at the given path. The file is unlinked right away,
+   * its space is reclaimed when the store is destroyed.
+   */
+  explicit IssueStore(boost::filesystem::path path);
+
+  IssueStore(const IssueStore&) = delete;
+  IssueStore(IssueStore&&) = delete;
+  IssueStore& operator=(const IssueStore&) = delete;
+  IssueStore& operator=(IssueStore&&) = delete;
+  ~IssueStore();
+
+  /* Add the given issues to the issues of the method. This is thread-safe. */
+  void append(const Method* method, const IssueSet& issues);
+
+  /**
+   * Replace the issues of the method by the given issues. This is thread-safe
+   * as long as each method is only written by a single thread.
+   */
+  void set(const Method* method, const IssueSet& issues);
+
+  /* Return the join of all the records of the method. This is thread-safe. */
+  IssueSet get(const Method* method) const;
+
+  /* Methods that have at least one record. */
+  std::vector<const Method*> methods() const;
+
+  /* Number of records written so far, including replaced ones. */
+  std::size_t records_size() const;
+
+  /* Number of bytes written so far, including replaced records. */
+  std::uint64_t size() const;
+
+ private:
+  /* Write the given record at the end of the file and return its offset. */
+  std::uint64_t write(const std::string& record);
+
+ private:
+  boost::filesystem::path path_;
+  int file_;
+  mutable std::mutex mutex_;
+  std::uint64_t size_;
+  std::size_t records_size_;
+  ConcurrentMap<const Method*, std::vector<std::uint64_t>> offsets_;
+};
+
+} // namespace marianatrench
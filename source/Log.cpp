@@ -5,17 +5,145 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <memory>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 #include <mariana-trench/Log.h>
 
 namespace {
 
+// Size of the buffer of pending messages, per thread.
+constexpr std::size_t k_thread_buffer_capacity = 1 << 20;
+
+// Maximum delay before pending messages are written.
+constexpr std::chrono::milliseconds k_writer_period(20);
+
+/**
+ * Single-producer single-consumer ring buffer of log lines.
+ *
+ * Each line is stored as its length followed by its content. The owning thread
+ * is the only producer and the writer thread is the only consumer, hence no
+ * lock is needed.
+ */
+class ThreadBuffer {
+ public:
+  ThreadBuffer()
+      : data_(std::make_unique<char[]>(k_thread_buffer_capacity)),
+        head_(0),
+        tail_(0),
+        orphaned_(false) {}
+
+  ThreadBuffer(const ThreadBuffer&) = delete;
+  ThreadBuffer(ThreadBuffer&&) = delete;
+  ThreadBuffer& operator=(const ThreadBuffer&) = delete;
+  ThreadBuffer& operator=(ThreadBuffer&&) = delete;
+  ~ThreadBuffer() = default;
+
+  /* Returns false if there is not enough space left for the line. */
+  bool push(std::string_view line) {
+    auto length = static_cast<std::uint32_t>(line.size());
+    auto needed = sizeof(length) + line.size();
+    auto head = head_.load(std::memory_order_relaxed);
+    auto tail = tail_.load(std::memory_order_acquire);
+    if (k_thread_buffer_capacity - (head - tail) < needed) {
+      return false;
+    }
+
+    write(head, reinterpret_cast<const char*>(&length), sizeof(length));
+    write(head + sizeof(length), line.data(), line.size());
+    head_.store(head + needed, std::memory_order_release);
+    return true;
+  }
+
+  /* Append all pending lines to `output`. */
+  void drain(std::string& output) {
+    auto tail = tail_.load(std::memory_order_relaxed);
+    auto head = head_.load(std::memory_order_acquire);
+    while (tail < head) {
+      std::uint32_t length;
+      read(tail, reinterpret_cast<char*>(&length), sizeof(length));
+      auto offset = output.size();
+      output.resize(offset + length);
+      read(tail + sizeof(length), output.data() + offset, length);
+      tail += sizeof(length) + length;
+    }
+    tail_.store(tail, std::memory_order_release);
+  }
+
+  bool empty() const {
+    return head_.load(std::memory_order_acquire) ==
+        tail_.load(std::memory_order_acquire);
+  }
+
+  /* Called by the owning thread when it exits. */
+  void orphan() {
+    orphaned_.store(true, std::memory_order_release);
+  }
+
+  bool orphaned() const {
+    return orphaned_.load(std::memory_order_acquire);
+  }
+
+ private:
+  void write(std::size_t position, const char* source, std::size_t size) {
+    auto index = position % k_thread_buffer_capacity;
+    auto first = std::min(size, k_thread_buffer_capacity - index);
+    std::memcpy(data_.get() + index, source, first);
+    std::memcpy(data_.get(), source + first, size - first);
+  }
+
+  void read(std::size_t position, char* destination, std::size_t size) const {
+    auto index = position % k_thread_buffer_capacity;
+    auto first = std::min(size, k_thread_buffer_capacity - index);
+    std::memcpy(destination, data_.get() + index, first);
+    std::memcpy(destination + first, data_.get(), size - first);
+  }
+
+ private:
+  std::unique_ptr<char[]> data_;
+  // Monotonic positions, the index in `data_` is modulo the capacity.
+  std::atomic<std::size_t> head_;
+  std::atomic<std::size_t> tail_;
+  std::atomic<bool> orphaned_;
+};
+
+struct ThreadBufferHandle {
+  ThreadBuffer* buffer = nullptr;
+  bool destroyed = false;
+
+  ~ThreadBufferHandle() {
+    if (buffer != nullptr) {
+      buffer->orphan();
+      buffer = nullptr;
+    }
+    destroyed = true;
+  }
+};
+
+thread_local ThreadBufferHandle thread_buffer_handle;
+
+/**
+ * Messages are buffered per thread and written by a background thread, so that
+ * threads never contend on a lock when logging. If a thread buffer is full,
+ * messages are dropped and the number of dropped messages is reported.
+ *
+ * Lines from a given thread are written in order, but lines from different
+ * threads may be interleaved differently than they were logged. Pending
+ * messages are written before any error and on exit.
+ */
 struct LoggerImplementation {
  public:
-  LoggerImplementation() : level_(0), file_(stderr) {
+  LoggerImplementation()
+      : level_(0), file_(stderr), dropped_(0), reported_dropped_(0) {
     const char* env = std::getenv("TRACE");
     if (env) {
       parse_environment(env);
@@ -26,7 +154,21 @@ struct LoggerImplementation {
   LoggerImplementation(LoggerImplementation&&) = delete;
   LoggerImplementation& operator=(const LoggerImplementation&) = delete;
   LoggerImplementation& operator=(LoggerImplementation&&) = delete;
-  ~LoggerImplementation() = default;
+
+  ~LoggerImplementation() {
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      stopped_ = true;
+    }
+    condition_.notify_all();
+    if (writer_.joinable()) {
+      writer_.join();
+    }
+
+    std::lock_guard<std::mutex> guard(mutex_);
+    write_pending();
+    fflush(file_);
+  }
 
   void set_level(int level) {
     level_ = level;
@@ -47,12 +189,81 @@ struct LoggerImplementation {
 
     std::string line = fmt::format("{} {}\n", section, message);
 
+    if (section != "ERROR" && line.size() < k_thread_buffer_capacity / 2) {
+      auto* buffer = thread_buffer();
+      if (buffer != nullptr) {
+        if (!buffer->push(line)) {
+          dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return;
+      }
+    }
+
+    // Errors are written synchronously, after all pending messages.
     std::lock_guard<std::mutex> guard(mutex_);
+    write_pending();
     fwrite(line.c_str(), line.size(), 1, file_);
     fflush(file_);
   }
 
  private:
+  /* Returns nullptr if the logger or the current thread is shutting down. */
+  ThreadBuffer* thread_buffer() {
+    if (thread_buffer_handle.buffer != nullptr) {
+      return thread_buffer_handle.buffer;
+    }
+    if (thread_buffer_handle.destroyed) {
+      return nullptr;
+    }
+
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (stopped_) {
+      return nullptr;
+    }
+    if (!writer_.joinable()) {
+      writer_ = std::thread([this]() { run_writer(); });
+    }
+    buffers_.push_back(std::make_unique<ThreadBuffer>());
+    thread_buffer_handle.buffer = buffers_.back().get();
+    return thread_buffer_handle.buffer;
+  }
+
+  void run_writer() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopped_) {
+      condition_.wait_for(lock, k_writer_period);
+      write_pending();
+    }
+  }
+
+  /* Write all pending messages. This must be called with `mutex_` held. */
+  void write_pending() {
+    std::string output;
+    for (auto iterator = buffers_.begin(); iterator != buffers_.end();) {
+      auto& buffer = *iterator;
+      // Check before draining, the thread cannot log anymore once orphaned.
+      bool orphaned = buffer->orphaned();
+      buffer->drain(output);
+      if (orphaned) {
+        iterator = buffers_.erase(iterator);
+      } else {
+        ++iterator;
+      }
+    }
+
+    auto dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped != reported_dropped_) {
+      output.append(fmt::format(
+          "WARNING Dropped {} log messages because the log buffer was full.\n",
+          dropped - reported_dropped_));
+      reported_dropped_ = dropped;
+    }
+
+    if (!output.empty()) {
+      fwrite(output.c_str(), output.size(), 1, file_);
+    }
+  }
+
   void parse_environment(std::string_view configuration) {
     // This needs to be consistent with redex.
     std::string module;
@@ -81,6 +292,12 @@ struct LoggerImplementation {
   int level_;
   FILE* file_;
   std::mutex mutex_;
+  std::condition_variable condition_;
+  std::thread writer_;
+  bool stopped_ = false;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+  std::atomic<std::size_t> dropped_;
+  std::size_t reported_dropped_;
 };
 
 static LoggerImplementation logger;
@@ -36,9 +36,19 @@ class Logger {
 
 } // namespace marianatrench
 
+/**
+ * Log statements with a level above this are compiled out, regardless of the
+ * level set at runtime. This is set by the `MARIANA_TRENCH_MAXIMUM_LOG_LEVEL`
+ * cmake option.
+ */
+#ifndef MT_MAXIMUM_LOG_LEVEL
+#define MT_MAXIMUM_LOG_LEVEL 5
+#endif
+
 #define SECTION(section, level, format, ...)                             \
   do {                                                                   \
-    if (marianatrench::Logger::enabled(level)) {                         \
+    if ((level) <= MT_MAXIMUM_LOG_LEVEL &&                               \
+        marianatrench::Logger::enabled(level)) {                         \
       marianatrench::Logger::log(section, level, format, ##__VA_ARGS__); \
     }                                                                    \
   } while (0)
@@ -51,9 +61,11 @@ class Logger {
 #define CONTEXT_LEVEL(context, level) \
   (context != nullptr && context->dump()) ? 1 : level
 
-#define LOG_OR_DUMP(context, level, format, ...)               \
-  do {                                                         \
-    LOG(CONTEXT_LEVEL(context, level), format, ##__VA_ARGS__); \
+#define LOG_OR_DUMP(context, level, format, ...)                 \
+  do {                                                           \
+    if ((level) <= MT_MAXIMUM_LOG_LEVEL) {                       \
+      LOG(CONTEXT_LEVEL(context, level), format, ##__VA_ARGS__); \
+    }                                                            \
   } while (0)
 
 #define WARNING(level, format, ...)                   \
@@ -61,9 +73,11 @@ class Logger {
     SECTION("WARNING", level, format, ##__VA_ARGS__); \
   } while (0)
 
-#define WARNING_OR_DUMP(context, level, format, ...)               \
-  do {                                                             \
-    WARNING(CONTEXT_LEVEL(context, level), format, ##__VA_ARGS__); \
+#define WARNING_OR_DUMP(context, level, format, ...)                 \
+  do {                                                               \
+    if ((level) <= MT_MAXIMUM_LOG_LEVEL) {                           \
+      WARNING(CONTEXT_LEVEL(context, level), format, ##__VA_ARGS__); \
+    }                                                                \
   } while (0)
 
 #define ERROR(level, format, ...)                   \
@@ -71,7 +85,9 @@ class Logger {
     SECTION("ERROR", level, format, ##__VA_ARGS__); \
   } while (0)
 
-#define ERROR_OR_DUMP(context, level, format, ...)                 \
-  do {                                                             \
-    WARNING(CONTEXT_LEVEL(context, level), format, ##__VA_ARGS__); \
+#define ERROR_OR_DUMP(context, level, format, ...)                   \
+  do {                                                               \
+    if ((level) <= MT_MAXIMUM_LOG_LEVEL) {                           \
+      WARNING(CONTEXT_LEVEL(context, level), format, ##__VA_ARGS__); \
+    }                                                                \
   } while (0)
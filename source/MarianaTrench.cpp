@@ -5,8 +5,15 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
 #include <memory>
+#include <optional>
 #include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <fmt/format.h>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem/operations.hpp>
@@ -18,12 +25,15 @@
 #include <mariana-trench/ClassHierarchies.h>
 #include <mariana-trench/ClassProperties.h>
 #include <mariana-trench/Context.h>
+#include <mariana-trench/Daemon.h>
 #include <mariana-trench/Dependencies.h>
 #include <mariana-trench/EventLogger.h>
 #include <mariana-trench/FieldCache.h>
 #include <mariana-trench/Fields.h>
+#include <mariana-trench/Heuristics.h>
 #include <mariana-trench/Highlights.h>
 #include <mariana-trench/Interprocedural.h>
+#include <mariana-trench/IssueStore.h>
 #include <mariana-trench/JsonValidation.h>
 #include <mariana-trench/Kind.h>
 #include <mariana-trench/LifecycleMethods.h>
@@ -35,7 +45,10 @@
 #include <mariana-trench/Overrides.h>
 #include <mariana-trench/Positions.h>
 #include <mariana-trench/PostprocessTraces.h>
+#include <mariana-trench/PreprocessingSnapshot.h>
 #include <mariana-trench/Redex.h>
+#include <mariana-trench/ReplaySnapshot.h>
+#include <mariana-trench/RuleSlice.h>
 #include <mariana-trench/Rules.h>
 #include <mariana-trench/Scheduler.h>
 #include <mariana-trench/Statistics.h>
@@ -59,7 +72,70 @@ void MarianaTrench::add_options(
   Options::add_options(options);
 }
 
+namespace {
+
+/**
+ * Restore a preprocessing phase from the snapshot if possible, or build it.
+ */
+template <typename T, typename Restore, typename Build>
+std::unique_ptr<T> restore_or_build(
+    const PreprocessingSnapshot* MT_NULLABLE snapshot,
+    const std::string& phase,
+    const Restore& restore,
+    const Build& build) {
+  if (snapshot != nullptr) {
+    if (auto value = snapshot->get(phase)) {
+      try {
+        auto result = restore(std::move(*value));
+        LOG(1, "Restored {} from the preprocessing snapshot.", phase);
+        return result;
+      } catch (const JsonValidationError& error) {
+        WARNING(
+            1,
+            "Unable to restore {} from the preprocessing snapshot: {}",
+            phase,
+            error.what());
+      }
+    }
+  }
+  return build();
+}
+
+} // namespace
+
 Registry MarianaTrench::analyze(Context& context) {
+  preprocess(context);
+  load_rules(context);
+  if (context.options->replay_snapshot_path()) {
+    return replay(context);
+  }
+  auto generated_models = generate_models(context);
+  return analyze(context, generated_models);
+}
+
+Registry MarianaTrench::replay(Context& context) {
+  const auto& snapshot_path = *context.options->replay_snapshot_path();
+  Timer replay_timer;
+  LOG(1, "Replaying analysis from `{}`...", snapshot_path);
+  auto model = ReplaySnapshot::replay(
+      context, JsonValidation::parse_json_file(snapshot_path));
+  context.statistics->log_time("replay", replay_timer);
+  LOG(1,
+      "Replayed analysis of `{}` in {:.2f}s.",
+      model.method()->show(),
+      replay_timer.duration_in_seconds());
+  return Registry(
+      context,
+      std::vector<Model>{model},
+      /* field_models */ std::vector<FieldModel>{});
+}
+
+void MarianaTrench::preprocess(Context& context) {
+  std::unique_ptr<PreprocessingSnapshot> snapshot;
+  if (context.options->preprocessing_snapshot_directory()) {
+    snapshot = std::make_unique<PreprocessingSnapshot>(*context.options);
+  }
+
   context.artificial_methods =
       std::make_unique<ArtificialMethods>(*context.kinds, context.stores);
   Timer methods_timer;
@@ -90,14 +166,46 @@ Registry MarianaTrench::analyze(Context& context) {
 
   Timer types_timer;
   LOG(1, "Inferring types...");
-  context.types = std::make_unique<Types>(*context.options, context.stores);
+  context.types = restore_or_build<Types>(
+      snapshot.get(),
+      "types",
+      [&](Json::Value value) {
+        return std::make_unique<Types>(
+            *context.methods, context.stores, value);
+      },
+      [&]() {
+        return std::make_unique<Types>(*context.options, context.stores);
+      });
+  // Types are restored for the methods that exist at this point, before
+  // life-cycle methods and shims add synthetic methods.
+  if (snapshot != nullptr && !snapshot->loaded()) {
+    snapshot->set("types", context.types->to_json(*context.methods));
+  }
   context.statistics->log_time("types", types_timer);
   LOG(1, "Inferred types in {:.2f}s.", types_timer.duration_in_seconds());
 
   Timer class_hierarchies_timer;
   LOG(1, "Building class hierarchies...");
-  context.class_hierarchies =
-      std::make_unique<ClassHierarchies>(*context.options, context.stores);
+  context.class_hierarchies = restore_or_build<ClassHierarchies>(
+      snapshot.get(),
+      "class_hierarchies",
+      [&](Json::Value value) {
+        auto class_hierarchies = ClassHierarchies::from_json(value);
+        if (context.options->dump_class_hierarchies()) {
+          auto class_hierarchies_path =
+              context.options->class_hierarchies_output_path();
+          LOG(1,
+              "Writing class hierarchies to `{}`",
+              class_hierarchies_path.native());
+          JsonValidation::write_json_file(
+              class_hierarchies_path, class_hierarchies->to_json());
+        }
+        return class_hierarchies;
+      },
+      [&]() {
+        return std::make_unique<ClassHierarchies>(
+            *context.options, context.stores);
+      });
   context.statistics->log_time("class_hierarchies", class_hierarchies_timer);
   LOG(1,
       "Built class hierarchies in {:.2f}s.",
@@ -123,8 +231,27 @@ Registry MarianaTrench::analyze(Context& context) {
 
   Timer overrides_timer;
   LOG(1, "Building override graph...");
-  context.overrides = std::make_unique<Overrides>(
-      *context.options, *context.methods, context.stores);
+  context.overrides = restore_or_build<Overrides>(
+      snapshot.get(),
+      "overrides",
+      [&](Json::Value value) {
+        auto overrides = Overrides::from_json(value, *context.methods);
+        if (context.options->dump_overrides()) {
+          auto overrides_path = context.options->overrides_output_path();
+          LOG(1, "Writing override graph to `{}`", overrides_path.native());
+          JsonValidation::write_json_file(overrides_path, overrides->to_json());
+        }
+        return overrides;
+      },
+      [&]() {
+        return std::make_unique<Overrides>(
+            *context.options, *context.methods, context.stores);
+      });
+  // The call graph adds overrides for methods with parameter type overrides,
+  // which are created again when restoring.
+  if (snapshot != nullptr && !snapshot->loaded()) {
+    snapshot->set("overrides", context.overrides->to_json());
+  }
   context.statistics->log_time("overrides", overrides_timer);
   LOG(1,
       "Built override graph in {:.2f}s.",
@@ -153,19 +280,44 @@ Registry MarianaTrench::analyze(Context& context) {
       "Built call graph in {:.2f}s.",
       call_graph_timer.duration_in_seconds());
 
-  std::vector<Model> generated_models;
-  std::vector<FieldModel> generated_field_models;
+  if (snapshot != nullptr && !snapshot->loaded()) {
+    Timer snapshot_timer;
+    LOG(1, "Writing preprocessing snapshot...");
+    snapshot->set("class_hierarchies", context.class_hierarchies->to_json());
+    snapshot->save();
+    context.statistics->log_time("preprocessing_snapshot", snapshot_timer);
+    LOG(1,
+        "Wrote preprocessing snapshot in {:.2f}s.",
+        snapshot_timer.duration_in_seconds());
+  }
+}
+
+void MarianaTrench::load_rules(Context& context) {
+  // Rules are loaded first so that sources and sinks with kinds that are not
+  // used in any rule are dropped as models are generated and loaded.
+  Timer rules_timer;
+  LOG(1, "Initializing rules...");
+  context.rules =
+      std::make_unique<Rules>(Rules::load(context, *context.options));
+  context.unused_kinds = std::make_unique<UnusedKinds>(*context.rules);
+  context.statistics->log_time("rules_init", rules_timer);
+  LOG(1,
+      "Initialized {} rules in {:.2f}s.",
+      context.rules->size(),
+      rules_timer.duration_in_seconds());
+}
+
+ModelGeneratorResult MarianaTrench::generate_models(Context& context) {
+  ModelGeneratorResult result;
   if (!context.options->skip_model_generation()) {
     Timer generation_timer;
     LOG(1, "Generating models...");
-    auto model_generator_result = ModelGeneration::run(context);
-    generated_models = model_generator_result.method_models;
-    generated_field_models = model_generator_result.field_models;
+    result = ModelGeneration::run(context);
     context.statistics->log_time("models_generation", generation_timer);
     LOG(1,
         "Generated {} models and {} field models in {:.2f}s.",
-        generated_models.size(),
-        generated_field_models.size(),
+        result.method_models.size(),
+        result.field_models.size(),
         generation_timer.duration_in_seconds());
   } else {
     LOG(1, "Skipped model generation.");
@@ -174,14 +326,23 @@ Registry MarianaTrench::analyze(Context& context) {
   // Add models for artificial methods.
   {
     auto models = context.artificial_methods->models(context);
-    generated_models.insert(
-        generated_models.end(), models.begin(), models.end());
+    result.method_models.insert(
+        result.method_models.end(), models.begin(), models.end());
   }
 
+  return result;
+}
+
+Registry MarianaTrench::analyze(
+    Context& context,
+    const ModelGeneratorResult& generated_models) {
   Timer registry_timer;
   LOG(1, "Initializing models...");
   auto registry = Registry::load(
-      context, *context.options, generated_models, generated_field_models);
+      context,
+      *context.options,
+      generated_models.method_models,
+      generated_models.field_models);
   context.statistics->log_time("registry_init", registry_timer);
   LOG(1,
       "Initialized {} models and {} field models in {:.2f}s.",
@@ -189,24 +350,9 @@ Registry MarianaTrench::analyze(Context& context) {
       registry.field_models_size(),
       registry_timer.duration_in_seconds());
 
-  Timer rules_timer;
-  LOG(1, "Initializing rules...");
-  context.rules =
-      std::make_unique<Rules>(Rules::load(context, *context.options));
-  context.statistics->log_time("rules_init", rules_timer);
-  LOG(1,
-      "Initialized {} rules in {:.2f}s.",
-      context.rules->size(),
-      rules_timer.duration_in_seconds());
-
-  Timer kind_pruning_timer;
-  LOG(1, "Removing unused Kinds");
-  int num_removed = UnusedKinds::remove_unused_kinds(context, registry).size();
-  context.statistics->log_time("prune_kinds", rules_timer);
   LOG(1,
-      "Removed {} kinds in {:.2f}s.",
-      num_removed,
-      kind_pruning_timer.duration_in_seconds());
+      "Dropped sources and sinks of {} unused kinds.",
+      context.rules->collect_unused_kinds(*context.kinds).size());
 
   Timer dependencies_timer;
   LOG(1, "Building dependency graph...");
@@ -221,6 +367,17 @@ Registry MarianaTrench::analyze(Context& context) {
       "Built dependency graph in {:.2f}s.",
       dependencies_timer.duration_in_seconds());
 
+  if (context.options->rules_filter()) {
+    Timer rule_slice_timer;
+    LOG(1, "Restricting the analysis to the selected rules...");
+    auto num_pruned = RuleSlice::apply(context, registry);
+    context.statistics->log_time("rule_slice", rule_slice_timer);
+    LOG(1,
+        "Skipped the analysis of {} methods in {:.2f}s.",
+        num_pruned,
+        rule_slice_timer.duration_in_seconds());
+  }
+
   Timer class_properties_timer;
   context.class_properties = std::make_unique<ClassProperties>(
       *context.options,
@@ -241,15 +398,30 @@ Registry MarianaTrench::analyze(Context& context) {
       "Built the analysis schedule in {:.2f}s.",
       scheduler_timer.duration_in_seconds());
 
+  // The previous store, if any, must be closed before creating a new one.
+  context.issue_store = nullptr;
+  if (context.options->stream_issues()) {
+    context.issue_store = std::make_unique<IssueStore>(
+        context.options->models_output_path() / "issue-store.bin");
+  }
+
   Timer analysis_timer;
   LOG(1, "Analyzing...");
   Interprocedural::run_analysis(context, registry);
   context.statistics->log_time("fixpoint", analysis_timer);
-  LOG(1,
-      "Analyzed {} models in {:.2f}s. Found {} issues!",
-      registry.models_size(),
-      analysis_timer.duration_in_seconds(),
-      registry.issues_size());
+  if (context.issue_store != nullptr) {
+    LOG(1,
+        "Analyzed {} models in {:.2f}s. Found issues in {} methods!",
+        registry.models_size(),
+        analysis_timer.duration_in_seconds(),
+        context.issue_store->methods().size());
+  } else {
+    LOG(1,
+        "Analyzed {} models in {:.2f}s. Found {} issues!",
+        registry.models_size(),
+        analysis_timer.duration_in_seconds(),
+        registry.issues_size());
+  }
 
   Timer remove_collapsed_traces_timer;
   LOG(2, "Removing invalid traces due to collapsing...");
@@ -272,6 +444,12 @@ Registry MarianaTrench::analyze(Context& context) {
     LOG(2, "Skipped augmenting positions.");
   }
 
+  Timer freeze_models_timer;
+  LOG(2, "Freezing models...");
+  registry.freeze_all();
+  context.statistics->log_time("freeze_models", freeze_models_timer);
+  LOG(2, "Froze models in {:.2f}s.", freeze_models_timer.duration_in_seconds());
+
   return registry;
 }
 
@@ -299,6 +477,7 @@ void MarianaTrench::run(const program_options::variables_map& variables) {
 
   context.options = std::make_unique<Options>(variables);
   const auto& options = *context.options;
+  Heuristics::set_max_number_origins(options.max_number_origins());
 
   EventLogger::init_event_logger(context.options.get());
 
@@ -328,10 +507,30 @@ void MarianaTrench::run(const program_options::variables_map& variables) {
       "Redex initialized in {:.2f}s.",
       initialization_timer.duration_in_seconds());
 
+  if (const auto& socket_path = options.daemon_socket_path()) {
+    serve(context, variables, *socket_path);
+    return;
+  }
+
   auto registry = analyze(context);
+  write_output(context, registry);
+}
+
+void MarianaTrench::write_output(Context& context, Registry& registry) {
+  const auto& options = *context.options;
 
-  Timer output_timer;
   auto models_path = options.models_output_path();
+  if (options.stream_issues()) {
+    Timer issues_output_timer;
+    LOG(1, "Writing issues to `{}`.", models_path.native());
+    registry.dump_issues(models_path);
+    context.statistics->log_time("dump_issues", issues_output_timer);
+    LOG(1,
+        "Wrote issues in {:.2f}s.",
+        issues_output_timer.duration_in_seconds());
+  }
+
+  Timer output_timer;
   LOG(1, "Writing models to `{}`.", models_path.native());
   registry.dump_models(models_path);
   context.statistics->log_time("dump_models", output_timer);
@@ -342,4 +541,153 @@ void MarianaTrench::run(const program_options::variables_map& variables) {
   registry.dump_metadata(/* path */ metadata_path);
 }
 
+program_options::variables_map MarianaTrench::parse_request_arguments(
+    const program_options::options_description& description,
+    const program_options::variables_map& initial_variables,
+    const std::vector<std::string>& arguments) {
+  program_options::variables_map variables;
+  program_options::store(
+      program_options::command_line_parser(arguments)
+          .options(description)
+          .run(),
+      variables);
+  for (const auto& [name, value] : initial_variables) {
+    auto found = variables.find(name);
+    if (found == variables.end()) {
+      variables.emplace(name, value);
+    } else if (found->second.defaulted() && !value.defaulted()) {
+      found->second = value;
+    }
+  }
+  program_options::notify(variables);
+  return variables;
+}
+
+std::optional<std::string> MarianaTrench::changed_program_option(
+    const Options& initial,
+    const Options& request) {
+  if (initial.apk_path() != request.apk_path()) {
+    return "apk-path";
+  }
+  if (initial.system_jar_paths() != request.system_jar_paths()) {
+    return "system-jar-paths";
+  }
+  if (initial.proguard_configuration_paths() !=
+      request.proguard_configuration_paths()) {
+    return "proguard-configuration-paths";
+  }
+  if (initial.remove_unreachable_code() != request.remove_unreachable_code()) {
+    return "remove-unreachable-code";
+  }
+  if (initial.lifecycles_paths() != request.lifecycles_paths()) {
+    return "lifecycles-paths";
+  }
+  if (initial.disable_parameter_type_overrides() !=
+      request.disable_parameter_type_overrides()) {
+    return "disable-parameter-type-overrides";
+  }
+  if (initial.source_root_directory() != request.source_root_directory() ||
+      initial.source_index_path() != request.source_index_path()) {
+    return "source-root-directory";
+  }
+  return std::nullopt;
+}
+
+void MarianaTrench::serve(
+    Context& context,
+    const program_options::variables_map& initial_variables,
+    const std::string& socket_path) {
+  preprocess(context);
+  auto initial_options = std::move(context.options);
+
+  program_options::options_description description;
+  add_options(description);
+
+  // Models generated by the previous request, and the kinds that were dropped
+  // while generating them.
+  std::optional<ModelGeneratorResult> generated_models;
+  std::unordered_set<const Kind*> dropped_kinds;
+
+  Daemon daemon(socket_path);
+  daemon.serve([&](const Json::Value& request) {
+    Timer request_timer;
+
+    std::vector<std::string> arguments;
+    for (const auto& argument :
+         JsonValidation::null_or_array(request, "arguments")) {
+      arguments.push_back(JsonValidation::string(argument));
+    }
+    auto from = request.isMember("from")
+        ? JsonValidation::string(request, "from")
+        : "model-generation";
+    if (from != "model-generation" && from != "fixpoint") {
+      throw std::invalid_argument(fmt::format(
+          "Expected `from` to be `model-generation` or `fixpoint`, got `{}`.",
+          from));
+    }
+
+    auto options = std::make_unique<Options>(
+        parse_request_arguments(description, initial_variables, arguments));
+    if (auto option = changed_program_option(*initial_options, *options)) {
+      throw std::invalid_argument(fmt::format(
+          "Option `--{}` cannot change while the daemon is running.",
+          *option));
+    }
+
+    context.options = std::move(options);
+    Heuristics::set_max_number_origins(context.options->max_number_origins());
+    context.statistics = std::make_unique<Statistics>();
+    context.dependencies = nullptr;
+    context.class_properties = nullptr;
+    context.scheduler = nullptr;
+    EventLogger::init_event_logger(context.options.get());
+
+    load_rules(context);
+
+    if (context.options->replay_snapshot_path()) {
+      auto registry = replay(context);
+      write_output(context, registry);
+
+      auto response = Json::Value(Json::objectValue);
+      response["status"] = "ok";
+      response["models"] =
+          Json::Value(static_cast<Json::UInt64>(registry.models_size()));
+      response["issues"] =
+          Json::Value(static_cast<Json::UInt64>(registry.issues_size()));
+      response["time"] = Json::Value(request_timer.duration_in_seconds());
+      return response;
+    }
+
+    // Generated models do not contain kinds that were unused by the rules at
+    // the time, they cannot be reused if the new rules use one of them.
+    if (from == "fixpoint" && generated_models &&
+        std::any_of(
+            dropped_kinds.begin(),
+            dropped_kinds.end(),
+            [&](const Kind* kind) { return context.rules->uses(kind); })) {
+      WARNING(
+          1, "Rules use kinds dropped by model generation, regenerating...");
+      generated_models = std::nullopt;
+    }
+    if (from == "model-generation" || !generated_models) {
+      generated_models = generate_models(context);
+      dropped_kinds = context.rules->collect_unused_kinds(*context.kinds);
+    } else {
+      LOG(1, "Re-using the models generated by the previous request.");
+    }
+
+    auto registry = analyze(context, *generated_models);
+    write_output(context, registry);
+
+    auto response = Json::Value(Json::objectValue);
+    response["status"] = "ok";
+    response["models"] =
+        Json::Value(static_cast<Json::UInt64>(registry.models_size()));
+    response["issues"] =
+        Json::Value(static_cast<Json::UInt64>(registry.issues_size()));
+    response["time"] = Json::Value(request_timer.duration_in_seconds());
+    return response;
+  });
+}
+
 } // namespace marianatrench
@@ -7,6 +7,10 @@
 
 #pragma once
 
+#include <optional>
+#include <string>
+#include <vector>
+
 #include <boost/program_options.hpp>
 
 #include <gtest/gtest_prod.h>
@@ -15,6 +19,7 @@
 
 #include <mariana-trench/Context.h>
 #include <mariana-trench/Registry.h>
+#include <mariana-trench/model-generator/ModelGenerator.h>
 
 namespace marianatrench {
 
@@ -28,7 +33,56 @@ class MarianaTrench : public Tool {
 
  private:
   FRIEND_TEST(IntegrationTest, CompareFlows);
+  FRIEND_TEST(MarianaTrenchTest, ParseRequestArguments);
+  FRIEND_TEST(MarianaTrenchTest, ChangedProgramOption);
   Registry analyze(Context& context);
+
+  /* Build everything that only depends on the analyzed program. */
+  static void preprocess(Context& context);
+
+  static void load_rules(Context& context);
+
+  static ModelGeneratorResult generate_models(Context& context);
+
+  /**
+   * Only re-run the analysis of the method saved in the replay snapshot, see
+   * `ReplaySnapshot`. This does not generate models.
+   */
+  static Registry replay(Context& context);
+
+  static Registry analyze(
+      Context& context,
+      const ModelGeneratorResult& generated_models);
+
+  static void write_output(Context& context, Registry& registry);
+
+  /**
+   * Keep the preprocessed program in memory and analyze it once per request
+   * received on the given socket, see `Daemon`.
+   *
+   * A request is an object with the command line `arguments` to use for this
+   * run, in addition to the ones given when starting the daemon, and where to
+   * start `from`: `model-generation` (default) or `fixpoint`, which re-uses
+   * the models generated by the previous request.
+   */
+  void serve(
+      Context& context,
+      const boost::program_options::variables_map& initial_variables,
+      const std::string& socket_path);
+
+  /**
+   * Parse the arguments of a daemon request. Options that are not given in the
+   * request keep the value they had when the daemon was started.
+   */
+  static boost::program_options::variables_map parse_request_arguments(
+      const boost::program_options::options_description& description,
+      const boost::program_options::variables_map& initial_variables,
+      const std::vector<std::string>& arguments);
+
+  /* Return the name of an option that cannot change while the daemon runs. */
+  static std::optional<std::string> changed_program_option(
+      const Options& initial,
+      const Options& request);
 };
 
 } // namespace marianatrench
@@ -9,6 +9,7 @@
 
 #include <Show.h>
 
+#include <mariana-trench/Heuristics.h>
 #include <mariana-trench/Log.h>
 #include <mariana-trench/Overrides.h>
 
@@ -36,12 +37,16 @@ MethodContext::MethodContext(
       memory_factory(model.method()),
       model(model),
       context_(context) {
-  std::string method_name = show(model.method());
+  dump_ = false;
   const auto& log_methods = options.log_methods();
-  dump_ = std::any_of(
-      log_methods.begin(), log_methods.end(), [&](const auto& pattern) {
-        return method_name.find(pattern) != std::string::npos;
-      });
+  if (!log_methods.empty()) {
+    // Use the cached name to avoid building it on every analysis.
+    const auto& method_name = model.method()->show();
+    dump_ = std::any_of(
+        log_methods.begin(), log_methods.end(), [&](const auto& pattern) {
+          return method_name.find(pattern) != std::string::npos;
+        });
+  }
 }
 
 Model MethodContext::model_at_callsite(
@@ -74,13 +79,12 @@ Model MethodContext::model_at_callsite(
     }
   }
 
-  auto model = registry.get(call_target.resolved_base_callee())
-                   .at_callsite(
-                       caller,
-                       position,
-                       context_,
-                       source_register_types,
-                       source_constant_arguments);
+  auto model = registry.at_callsite(
+      call_target.resolved_base_callee(),
+      caller,
+      position,
+      source_register_types,
+      source_constant_arguments);
 
   if (!call_target.is_virtual()) {
     return model;
@@ -95,6 +99,19 @@ Model MethodContext::model_at_callsite(
     return model;
   }
 
+  // The analysis tightens this threshold when running low on memory.
+  auto join_override_threshold = Heuristics::join_override_threshold();
+  if (join_override_threshold &&
+      context_.overrides->get(call_target.resolved_base_callee()).size() >=
+          *join_override_threshold) {
+    LOG_OR_DUMP(
+        this,
+        5,
+        "Not joining at call-site for method `{}` with too many overrides",
+        show(call_target.resolved_base_callee()));
+    return model;
+  }
+
   LOG_OR_DUMP(
       this,
       5,
@@ -103,10 +120,10 @@ Model MethodContext::model_at_callsite(
       model);
 
   for (const auto* override : call_target.overrides()) {
-    auto override_model = registry.get(override).at_callsite(
+    auto override_model = registry.at_callsite(
+        override,
         caller,
         position,
-        context_,
         source_register_types,
         source_constant_arguments);
     LOG_OR_DUMP(
@@ -14,16 +14,24 @@
 namespace marianatrench {
 
 MethodSet::MethodSet(std::initializer_list<const Method*> methods)
-    : set_(methods) {}
+    : set_(methods) {
+  collapse_if_too_large();
+}
 
 MethodSet::MethodSet(const Methods& methods)
-    : set_(methods.begin(), methods.end()) {}
+    : set_(methods.begin(), methods.end()) {
+  collapse_if_too_large();
+}
 
 void MethodSet::add(const Method* method) {
   if (is_top_) {
     return;
   }
+  auto previous = set_;
   set_.insert(method);
+  if (!set_.reference_equals(previous)) {
+    collapse_if_too_large();
+  }
 }
 
 void MethodSet::remove(const Method* method) {
@@ -55,7 +63,12 @@ void MethodSet::join_with(const MethodSet& other) {
     set_to_top();
     return;
   }
+  // Copies are cheap since nodes are shared.
+  auto previous = set_;
   set_.union_with(other.set_);
+  if (!set_.reference_equals(previous)) {
+    collapse_if_too_large();
+  }
 }
 
 void MethodSet::widen_with(const MethodSet& other) {
@@ -88,6 +101,24 @@ void MethodSet::difference_with(const MethodSet& other) {
   set_.difference_with(other.set_);
 }
 
+void MethodSet::collapse_if_too_large() {
+  auto maximum = Heuristics::max_number_origins();
+  if (!maximum) {
+    return;
+  }
+
+  // Computing the size is linear, so stop after the maximum.
+  std::size_t size = 0;
+  for (auto iterator = set_.begin(), end = set_.end(); iterator != end;
+       ++iterator) {
+    if (++size > *maximum) {
+      set_to_top();
+      Heuristics::record_collapsed_origins();
+      return;
+    }
+  }
+}
+
 MethodSet MethodSet::from_json(const Json::Value& value, Context& context) {
   MethodSet methods;
   for (const auto& method_value : JsonValidation::null_or_array(value)) {
@@ -97,6 +128,7 @@ MethodSet MethodSet::from_json(const Json::Value& value, Context& context) {
 }
 
 Json::Value MethodSet::to_json() const {
+  // Top is written as an empty list. See `Frame::to_json`.
   auto methods = Json::Value(Json::arrayValue);
   for (const auto* method : set_) {
     methods.append(method->to_json());
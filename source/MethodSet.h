@@ -16,10 +16,18 @@
 #include <PatriciaTreeSet.h>
 
 #include <mariana-trench/Assert.h>
+#include <mariana-trench/Heuristics.h>
 #include <mariana-trench/Method.h>
 
 namespace marianatrench {
 
+/**
+ * Represents a set of methods, e.g the origins of a frame.
+ *
+ * Sets are persistent: copies share their nodes, and joining a set with one
+ * of its subsets does not allocate. Sets larger than
+ * `Heuristics::max_number_origins()`, if any, are collapsed into top.
+ */
 class MethodSet final : public sparta::AbstractDomain<MethodSet> {
  private:
   using Set = sparta::PatriciaTreeSet<const Method*>;
@@ -114,6 +122,10 @@ class MethodSet final : public sparta::AbstractDomain<MethodSet> {
 
   friend std::ostream& operator<<(std::ostream& out, const MethodSet& methods);
 
+ private:
+  /* Collapse into top if the set has more than the maximum of methods. */
+  void collapse_if_too_large();
+
  private:
   Set set_;
   bool is_top_ = false;
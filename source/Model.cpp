@@ -22,6 +22,7 @@
 #include <mariana-trench/Model.h>
 #include <mariana-trench/Overrides.h>
 #include <mariana-trench/Positions.h>
+#include <mariana-trench/UnusedKinds.h>
 
 namespace marianatrench {
 
@@ -121,16 +122,23 @@ Model::Model(
     add_taint_in_taint_this(context);
   }
 
+  // Sources and sinks that cannot lead to an issue are dropped right away.
   for (const auto& [port, source] : generations) {
-    add_generation(port, source);
+    if (!UnusedKinds::should_drop(context, source.kind())) {
+      add_generation(port, source);
+    }
   }
 
   for (const auto& [port, source] : parameter_sources) {
-    add_parameter_source(port, source);
+    if (!UnusedKinds::should_drop(context, source.kind())) {
+      add_parameter_source(port, source);
+    }
   }
 
   for (const auto& [port, sink] : sinks) {
-    add_sink(port, sink);
+    if (!UnusedKinds::should_drop(context, sink.kind())) {
+      add_sink(port, sink);
+    }
   }
 
   for (const auto& [propagation, output] : propagations) {
@@ -252,8 +260,7 @@ Model Model::at_callsite(
     const {
   const auto* callee = method_;
 
-  Model model;
-  model.modes_ = modes_;
+  auto model = at_callsite_without_taint();
 
   auto maximum_source_sink_distance =
       context.options->maximum_source_sink_distance();
@@ -310,6 +317,12 @@ Model Model::at_callsite(
         UpdateKind::Weak);
   });
 
+  return model;
+}
+
+Model Model::at_callsite_without_taint() const {
+  Model model;
+  model.modes_ = modes_;
   model.propagations_ = propagations_;
   model.add_features_to_arguments_ = add_features_to_arguments_;
 
@@ -393,10 +406,25 @@ void Model::collapse_invalid_paths(Context& context) {
 }
 
 void Model::approximate() {
-  generations_.limit_leaves(Heuristics::kModelTreeMaxLeaves);
-  parameter_sources_.limit_leaves(Heuristics::kModelTreeMaxLeaves);
-  sinks_.limit_leaves(Heuristics::kModelTreeMaxLeaves);
-  propagations_.limit_leaves(Heuristics::kModelTreeMaxLeaves);
+  const auto max_leaves = Heuristics::model_tree_max_leaves();
+  generations_.limit_leaves(max_leaves);
+  parameter_sources_.limit_leaves(max_leaves);
+  sinks_.limit_leaves(max_leaves);
+  propagations_.limit_leaves(max_leaves);
+}
+
+void Model::approximate_unstable() {
+  auto drop_local_positions = [](Taint& taint) {
+    taint.set_local_positions(LocalPositionSet::top());
+  };
+
+  generations_.collapse_deeper_than(/* height */ 0);
+  generations_.map(drop_local_positions);
+  parameter_sources_.collapse_deeper_than(/* height */ 0);
+  parameter_sources_.map(drop_local_positions);
+  sinks_.collapse_deeper_than(/* height */ 0);
+  sinks_.map(drop_local_positions);
+  propagations_.collapse_deeper_than(/* height */ 0);
 }
 
 bool Model::empty() const {
@@ -918,7 +946,10 @@ Model Model::from_json(
       JsonValidation::string(generation_value, /* field */ "caller_port");
       port = AccessPath::from_json(generation_value["caller_port"]);
     }
-    model.add_generation(port, Frame::from_json(generation_value, context));
+    auto generation = Frame::from_json(generation_value, context);
+    if (!UnusedKinds::should_drop(context, generation.kind())) {
+      model.add_generation(port, generation);
+    }
   }
 
   for (auto parameter_source_value :
@@ -927,8 +958,10 @@ Model Model::from_json(
         parameter_source_value.isMember("port") ? "port" : "caller_port";
     JsonValidation::string(parameter_source_value, /* field */ port_field);
     auto port = AccessPath::from_json(parameter_source_value[port_field]);
-    model.add_parameter_source(
-        port, Frame::from_json(parameter_source_value, context));
+    auto parameter_source = Frame::from_json(parameter_source_value, context);
+    if (!UnusedKinds::should_drop(context, parameter_source.kind())) {
+      model.add_parameter_source(port, parameter_source);
+    }
   }
 
   for (auto source_value :
@@ -942,6 +975,9 @@ Model Model::from_json(
       port = AccessPath::from_json(source_value["caller_port"]);
     }
     auto source = Frame::from_json(source_value, context);
+    if (UnusedKinds::should_drop(context, source.kind())) {
+      continue;
+    }
     if (port.root().is_argument()) {
       model.add_parameter_source(port, source);
     } else {
@@ -955,7 +991,10 @@ Model Model::from_json(
         sink_value.isMember("port") ? "port" : "caller_port";
     JsonValidation::string(sink_value, /* field */ port_field);
     auto port = AccessPath::from_json(sink_value[port_field]);
-    model.add_sink(port, Frame::from_json(sink_value, context));
+    auto sink = Frame::from_json(sink_value, context);
+    if (!UnusedKinds::should_drop(context, sink.kind())) {
+      model.add_sink(port, sink);
+    }
   }
 
   for (auto propagation_value :
@@ -173,10 +173,22 @@ class Model final {
       const std::vector<std::optional<std::string>>& source_constant_arguments)
       const;
 
+  /**
+   * Return the caller-independent part of the callee model at a callsite, i.e
+   * `at_callsite` without generations and sinks. See `ExportSummary`.
+   */
+  Model at_callsite_without_taint() const;
+
   void collapse_invalid_paths(Context& context);
 
   void approximate();
 
+  /**
+   * Aggressively approximate the model of a method that keeps changing:
+   * collapse all trees into their roots and give up on local positions.
+   */
+  void approximate_unstable();
+
   bool empty() const;
 
   bool check_root_consistency(Root root) const;
@@ -0,0 +1,662 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+
+#include <boost/algorithm/string.hpp>
+#include <fmt/format.h>
+#include <re2/re2.h>
+
+#include <SpartaWorkQueue.h>
+
+#include <mariana-trench/JsonValidation.h>
+#include <mariana-trench/Log.h>
+#include <mariana-trench/ModelIndex.h>
+#include <mariana-trench/SourceFile.h>
+
+namespace marianatrench {
+
+namespace {
+
+// Bump this when the layout of the index changes.
+constexpr std::uint64_t k_version = 3;
+constexpr char k_magic[8] = {'M', 'T', 'I', 'N', 'D', 'E', 'X', '\0'};
+
+struct StringRecord {
+  std::uint64_t offset;
+  std::uint64_t length;
+};
+
+struct Header {
+  char magic[8];
+  std::uint64_t version;
+  std::uint64_t number_shards;
+  std::uint64_t number_entries;
+  std::uint64_t number_kinds;
+  std::uint64_t number_issues;
+  std::uint64_t strings_size;
+};
+
+/* A shard is unchanged if its size and modification time are. */
+struct ShardRecord {
+  StringRecord filename;
+  std::uint64_t size;
+  std::int64_t modification_time;
+};
+
+struct LineRecord {
+  std::uint64_t shard;
+  std::uint64_t offset;
+  std::uint64_t length;
+};
+
+/* A model, sorted by name. */
+struct EntryRecord {
+  StringRecord name;
+  LineRecord line;
+};
+
+/* A kind mentioned by a model, sorted by kind. */
+struct KindRecord {
+  StringRecord kind;
+  std::uint64_t entry;
+};
+
+/* A line containing issues for a rule, sorted by code. */
+struct IssueRecord {
+  std::int64_t code;
+  LineRecord line;
+};
+
+// Records are read in place from the mapping, which is page aligned.
+static_assert(sizeof(Header) % alignof(std::uint64_t) == 0);
+static_assert(sizeof(ShardRecord) % alignof(std::uint64_t) == 0);
+static_assert(sizeof(EntryRecord) % alignof(std::uint64_t) == 0);
+static_assert(sizeof(KindRecord) % alignof(std::uint64_t) == 0);
+static_assert(sizeof(IssueRecord) % alignof(std::uint64_t) == 0);
+
+struct Layout {
+  const Header* header;
+  const ShardRecord* shards;
+  const EntryRecord* entries;
+  const KindRecord* kinds;
+  const IssueRecord* issues;
+  const char* strings;
+  std::uint64_t size;
+};
+
+Layout make_layout(const char* data) {
+  Layout layout;
+  layout.header = reinterpret_cast<const Header*>(data);
+  const char* current = data + sizeof(Header);
+  layout.shards = reinterpret_cast<const ShardRecord*>(current);
+  current += sizeof(ShardRecord) * layout.header->number_shards;
+  layout.entries = reinterpret_cast<const EntryRecord*>(current);
+  current += sizeof(EntryRecord) * layout.header->number_entries;
+  layout.kinds = reinterpret_cast<const KindRecord*>(current);
+  current += sizeof(KindRecord) * layout.header->number_kinds;
+  layout.issues = reinterpret_cast<const IssueRecord*>(current);
+  current += sizeof(IssueRecord) * layout.header->number_issues;
+  layout.strings = current;
+  current += layout.header->strings_size;
+  layout.size = current - data;
+  return layout;
+}
+
+std::string_view to_string_view(const Layout& layout, StringRecord record) {
+  return std::string_view(layout.strings + record.offset, record.length);
+}
+
+class StringTable final {
+ public:
+  StringRecord add(const std::string& string) {
+    auto found = records_.find(string);
+    if (found != records_.end()) {
+      return found->second;
+    }
+    auto record = StringRecord{data_.size(), string.size()};
+    data_.append(string);
+    records_.emplace(string, record);
+    return record;
+  }
+
+  const std::string& data() const {
+    return data_;
+  }
+
+ private:
+  std::string data_;
+  std::unordered_map<std::string, StringRecord> records_;
+};
+
+/* Information extracted from a line of a shard while building the index. */
+struct IndexedLine {
+  // Only set for models, i.e lines of `model@*.json` shards.
+  std::optional<std::string> name;
+  std::vector<std::string> kinds;
+  std::vector<int> codes;
+  LineRecord line;
+};
+
+bool is_model_shard(const std::string& filename) {
+  return boost::starts_with(filename, "model@");
+}
+
+std::vector<boost::filesystem::path> list_shards(
+    const boost::filesystem::path& output_directory) {
+  std::vector<boost::filesystem::path> shards;
+  for (const auto& entry :
+       boost::filesystem::directory_iterator(output_directory)) {
+    auto filename = entry.path().filename().string();
+    if ((is_model_shard(filename) || boost::starts_with(filename, "issues@")) &&
+        entry.path().extension() == ".json") {
+      shards.push_back(entry.path());
+    }
+  }
+  std::sort(shards.begin(), shards.end());
+  return shards;
+}
+
+void collect_kinds(const Json::Value& value, std::vector<std::string>& kinds) {
+  if (value.isObject()) {
+    for (auto iterator = value.begin(); iterator != value.end(); ++iterator) {
+      if (iterator.name() == "kind" && iterator->isString()) {
+        kinds.push_back(iterator->asString());
+      } else {
+        collect_kinds(*iterator, kinds);
+      }
+    }
+  } else if (value.isArray()) {
+    for (const auto& element : value) {
+      collect_kinds(element, kinds);
+    }
+  }
+}
+
+template <typename Record>
+void write_records(std::ofstream& stream, const std::vector<Record>& records) {
+  stream.write(
+      reinterpret_cast<const char*>(records.data()),
+      sizeof(Record) * records.size());
+}
+
+std::string to_compact_string(const Json::Value& value) {
+  static const auto writer = JsonValidation::compact_writer();
+  std::stringstream string;
+  writer->write(value, &string);
+  return string.str();
+}
+
+} // namespace
+
+void ModelIndex::build(
+    const boost::filesystem::path& output_directory,
+    const boost::filesystem::path& index_path) {
+  auto shard_paths = list_shards(output_directory);
+  std::vector<std::vector<IndexedLine>> shard_lines(shard_paths.size());
+  std::vector<ShardRecord> shards(shard_paths.size());
+
+  auto queue = sparta::work_queue<std::size_t>(
+      [&](std::size_t shard) {
+        const auto& path = shard_paths[shard];
+        boost::system::error_code error;
+        auto modification_time =
+            boost::filesystem::last_write_time(path, error);
+        auto file = SourceFile::open(path.string());
+        if (!file) {
+          WARNING(1, "Unable to read `{}`.", path.string());
+          return;
+        }
+        // Describe the content that was indexed, even if the shard changes
+        // while it is being read.
+        shards[shard].size = file->content().size();
+        shards[shard].modification_time = error ? -1 : modification_time;
+
+        bool model_shard = is_model_shard(path.filename().string());
+        auto& lines = shard_lines[shard];
+        for (std::size_t index = 1; index <= file->size(); index++) {
+          auto line = file->line(index);
+          if (line.empty() || line.substr(0, 2) == "//") {
+            continue;
+          }
+
+          Json::Value value;
+          try {
+            value = JsonValidation::parse_json(std::string(line));
+          } catch (const std::exception& exception) {
+            WARNING(
+                1,
+                "Skipping line {} of `{}`: {}",
+                index,
+                path.string(),
+                exception.what());
+            continue;
+          }
+
+          IndexedLine indexed_line;
+          indexed_line.line = LineRecord{
+              /* shard */ shard,
+              /* offset */
+              static_cast<std::uint64_t>(
+                  line.data() - file->content().data()),
+              /* length */ line.size()};
+          if (model_shard) {
+            indexed_line.name = name(value);
+            collect_kinds(value, indexed_line.kinds);
+            std::sort(indexed_line.kinds.begin(), indexed_line.kinds.end());
+            indexed_line.kinds.erase(
+                std::unique(
+                    indexed_line.kinds.begin(), indexed_line.kinds.end()),
+                indexed_line.kinds.end());
+          }
+          for (const auto& issue : value["issues"]) {
+            if (issue.isObject() && issue["rule"].isInt()) {
+              indexed_line.codes.push_back(issue["rule"].asInt());
+            }
+          }
+          std::sort(indexed_line.codes.begin(), indexed_line.codes.end());
+          indexed_line.codes.erase(
+              std::unique(indexed_line.codes.begin(), indexed_line.codes.end()),
+              indexed_line.codes.end());
+          lines.push_back(std::move(indexed_line));
+        }
+      },
+      sparta::parallel::default_num_threads());
+  for (std::size_t shard = 0; shard < shard_paths.size(); shard++) {
+    queue.add_item(shard);
+  }
+  queue.run_all();
+
+  StringTable strings;
+  for (std::size_t shard = 0; shard < shard_paths.size(); shard++) {
+    shards[shard].filename =
+        strings.add(shard_paths[shard].filename().string());
+  }
+
+  std::vector<const IndexedLine*> models;
+  std::vector<IssueRecord> issues;
+  for (const auto& lines : shard_lines) {
+    for (const auto& line : lines) {
+      if (line.name) {
+        models.push_back(&line);
+      }
+      for (int code : line.codes) {
+        issues.push_back(IssueRecord{code, line.line});
+      }
+    }
+  }
+  std::sort(
+      models.begin(), models.end(), [](const auto* left, const auto* right) {
+        return *left->name < *right->name;
+      });
+  std::sort(
+      issues.begin(), issues.end(), [](const auto& left, const auto& right) {
+        return std::tie(left.code, left.line.shard, left.line.offset) <
+            std::tie(right.code, right.line.shard, right.line.offset);
+      });
+
+  std::vector<EntryRecord> entries;
+  std::vector<std::pair<std::string_view, std::uint64_t>> kind_entries;
+  for (std::size_t entry = 0; entry < models.size(); entry++) {
+    const auto* model = models[entry];
+    entries.push_back(EntryRecord{strings.add(*model->name), model->line});
+    for (const auto& kind : model->kinds) {
+      kind_entries.emplace_back(kind, entry);
+    }
+  }
+  std::sort(kind_entries.begin(), kind_entries.end());
+  std::vector<KindRecord> kinds;
+  for (const auto& [kind, entry] : kind_entries) {
+    kinds.push_back(KindRecord{strings.add(std::string(kind)), entry});
+  }
+
+  Header header;
+  std::memcpy(header.magic, k_magic, sizeof(k_magic));
+  header.version = k_version;
+  header.number_shards = shards.size();
+  header.number_entries = entries.size();
+  header.number_kinds = kinds.size();
+  header.number_issues = issues.size();
+  header.strings_size = strings.data().size();
+
+  auto temporary_path = index_path;
+  temporary_path += boost::filesystem::unique_path(".%%%%-%%%%-%%%%.tmp");
+  {
+    std::ofstream stream(temporary_path.native(), std::ios_base::binary);
+    if (!stream.is_open()) {
+      throw std::runtime_error(fmt::format(
+          "Unable to write the model index at `{}`.", index_path.string()));
+    }
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    write_records(stream, shards);
+    write_records(stream, entries);
+    write_records(stream, kinds);
+    write_records(stream, issues);
+    stream.write(strings.data().data(), strings.data().size());
+  }
+  boost::filesystem::rename(temporary_path, index_path);
+
+  LOG(1,
+      "Indexed {} models and {} issue lines from {} shards in `{}`.",
+      entries.size(),
+      issues.size(),
+      shards.size(),
+      index_path.string());
+}
+
+std::unique_ptr<ModelIndex> MT_NULLABLE ModelIndex::open(
+    const boost::filesystem::path& output_directory,
+    const boost::filesystem::path& index_path) {
+  boost::system::error_code error;
+  if (!boost::filesystem::is_regular_file(index_path, error) ||
+      boost::filesystem::file_size(index_path, error) < sizeof(Header)) {
+    return nullptr;
+  }
+
+  // Use `new` since the default constructor is private.
+  auto index = std::unique_ptr<ModelIndex>(new ModelIndex());
+  try {
+    index->mapping_.open(index_path.string());
+  } catch (const std::exception& exception) {
+    WARNING(
+        1,
+        "Unable to map model index `{}`: {}",
+        index_path.string(),
+        exception.what());
+    return nullptr;
+  }
+  index->data_ = index->mapping_.data();
+
+  const auto* header = reinterpret_cast<const Header*>(index->data_);
+  if (std::memcmp(header->magic, k_magic, sizeof(k_magic)) != 0 ||
+      header->version != k_version ||
+      make_layout(index->data_).size != index->mapping_.size()) {
+    LOG(1, "Ignoring outdated model index at `{}`.", index_path.string());
+    return nullptr;
+  }
+
+  // The index is outdated if the shards changed since it was built.
+  auto layout = make_layout(index->data_);
+  auto shard_paths = list_shards(output_directory);
+  if (shard_paths.size() != header->number_shards) {
+    LOG(1, "Ignoring outdated model index at `{}`.", index_path.string());
+    return nullptr;
+  }
+  for (std::size_t shard = 0; shard < shard_paths.size(); shard++) {
+    const auto& path = shard_paths[shard];
+    const auto& record = layout.shards[shard];
+    auto size = boost::filesystem::file_size(path, error);
+    std::int64_t modification_time =
+        error ? -1 : boost::filesystem::last_write_time(path, error);
+    if (path.filename().string() != to_string_view(layout, record.filename) ||
+        error || size != record.size ||
+        modification_time != record.modification_time) {
+      LOG(1, "Ignoring outdated model index at `{}`.", index_path.string());
+      return nullptr;
+    }
+    // Shards are mapped lazily, see `line`.
+    index->shards_.push_back(std::make_unique<Shard>());
+    index->shards_.back()->path = path;
+  }
+
+  return index;
+}
+
+std::size_t ModelIndex::size() const {
+  return make_layout(data_).header->number_entries;
+}
+
+std::string_view ModelIndex::name(std::size_t index) const {
+  auto layout = make_layout(data_);
+  mt_assert(index < layout.header->number_entries);
+  return to_string_view(layout, layout.entries[index].name);
+}
+
+std::optional<std::string_view> ModelIndex::model(std::string_view name) const {
+  auto layout = make_layout(data_);
+  const auto* begin = layout.entries;
+  const auto* end = begin + layout.header->number_entries;
+  const auto* found = std::lower_bound(
+      begin, end, name, [&](const EntryRecord& entry, std::string_view name) {
+        return to_string_view(layout, entry.name) < name;
+      });
+  if (found == end || to_string_view(layout, found->name) != name) {
+    return std::nullopt;
+  }
+  return model_line(found - begin);
+}
+
+std::vector<std::string_view> ModelIndex::names_matching(
+    const std::string& pattern) const {
+  re2::RE2 regex(pattern);
+  if (!regex.ok()) {
+    throw std::invalid_argument(fmt::format(
+        "Invalid regular expression `{}`: {}", pattern, regex.error()));
+  }
+
+  std::vector<std::string_view> names;
+  for (std::size_t index = 0; index < size(); index++) {
+    auto name = this->name(index);
+    if (re2::RE2::PartialMatch(
+            re2::StringPiece(name.data(), name.size()), regex)) {
+      names.push_back(name);
+    }
+  }
+  return names;
+}
+
+std::vector<std::string_view> ModelIndex::names_with_kind(
+    std::string_view kind) const {
+  auto layout = make_layout(data_);
+  const auto* begin = layout.kinds;
+  const auto* end = begin + layout.header->number_kinds;
+  const auto* found = std::lower_bound(
+      begin, end, kind, [&](const KindRecord& record, std::string_view kind) {
+        return to_string_view(layout, record.kind) < kind;
+      });
+
+  std::vector<std::string_view> names;
+  for (; found != end && to_string_view(layout, found->kind) == kind;
+       ++found) {
+    names.push_back(name(found->entry));
+  }
+  return names;
+}
+
+std::vector<Json::Value> ModelIndex::issues(int code) const {
+  auto layout = make_layout(data_);
+  const auto* begin = layout.issues;
+  const auto* end = begin + layout.header->number_issues;
+  const auto* found = std::lower_bound(
+      begin, end, code, [](const IssueRecord& record, int code) {
+        return record.code < code;
+      });
+
+  std::vector<Json::Value> issues;
+  for (; found != end && found->code == code; ++found) {
+    auto value = JsonValidation::parse_json(std::string(
+        line(found->line.shard, found->line.offset, found->line.length)));
+    for (const auto& issue : value["issues"]) {
+      if (issue["rule"].isInt() && issue["rule"].asInt() == code) {
+        auto result = Json::Value(Json::objectValue);
+        result["method"] = value["method"];
+        result["issue"] = issue;
+        issues.push_back(std::move(result));
+      }
+    }
+  }
+  return issues;
+}
+
+ModelIndex::Diff ModelIndex::diff(
+    const ModelIndex& left,
+    const ModelIndex& right) {
+  Diff diff;
+
+  // Both indices are sorted by name.
+  std::vector<std::pair<std::size_t, std::size_t>> common;
+  std::size_t left_index = 0;
+  std::size_t right_index = 0;
+  while (left_index < left.size() || right_index < right.size()) {
+    if (right_index == right.size() ||
+        (left_index < left.size() &&
+         left.name(left_index) < right.name(right_index))) {
+      diff.removed.emplace_back(left.name(left_index++));
+    } else if (
+        left_index == left.size() ||
+        right.name(right_index) < left.name(left_index)) {
+      diff.added.emplace_back(right.name(right_index++));
+    } else {
+      common.emplace_back(left_index++, right_index++);
+    }
+  }
+
+  std::mutex mutex;
+  auto queue = sparta::work_queue<std::size_t>(
+      [&](std::size_t index) {
+        auto [left_index, right_index] = common[index];
+        auto left_line = left.model_line(left_index);
+        auto right_line = right.model_line(right_index);
+        if (left_line == right_line) {
+          return;
+        }
+
+        auto left_model =
+            canonicalize(JsonValidation::parse_json(std::string(left_line)));
+        auto right_model =
+            canonicalize(JsonValidation::parse_json(std::string(right_line)));
+        std::set<std::string> members;
+        for (const auto& member : left_model.getMemberNames()) {
+          members.insert(member);
+        }
+        for (const auto& member : right_model.getMemberNames()) {
+          members.insert(member);
+        }
+
+        std::vector<std::string> fields;
+        for (const auto& member : members) {
+          if (left_model[member] != right_model[member]) {
+            fields.push_back(member);
+          }
+        }
+        if (fields.empty()) {
+          return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        diff.changed.emplace_back(
+            std::string(left.name(left_index)), std::move(fields));
+      },
+      sparta::parallel::default_num_threads());
+  for (std::size_t index = 0; index < common.size(); index++) {
+    queue.add_item(index);
+  }
+  queue.run_all();
+
+  std::sort(diff.changed.begin(), diff.changed.end());
+  return diff;
+}
+
+std::string ModelIndex::name(const Json::Value& model) {
+  if (model.isMember("field")) {
+    const auto& field = model["field"];
+    return field.isString() ? field.asString() : to_compact_string(field);
+  }
+
+  const auto& method = model["method"];
+  if (method.isString()) {
+    return method.asString();
+  }
+
+  // Same format as `Method::show`.
+  auto name = method["name"].asString();
+  const auto& parameter_type_overrides = method["parameter_type_overrides"];
+  if (parameter_type_overrides.isArray() &&
+      !parameter_type_overrides.empty()) {
+    std::vector<std::string> overrides;
+    for (const auto& parameter_type_override : parameter_type_overrides) {
+      overrides.push_back(fmt::format(
+          "{}: {}",
+          parameter_type_override["parameter"].asInt(),
+          parameter_type_override["type"].asString()));
+    }
+    name += fmt::format("[{}]", boost::algorithm::join(overrides, ","));
+  }
+  return name;
+}
+
+Json::Value ModelIndex::canonicalize(const Json::Value& value) {
+  if (value.isArray()) {
+    std::vector<std::pair<std::string, Json::Value>> elements;
+    for (const auto& element : value) {
+      auto canonical_element = canonicalize(element);
+      elements.emplace_back(
+          to_compact_string(canonical_element), std::move(canonical_element));
+    }
+    std::sort(
+        elements.begin(),
+        elements.end(),
+        [](const auto& left, const auto& right) {
+          return left.first < right.first;
+        });
+
+    auto result = Json::Value(Json::arrayValue);
+    for (auto& [_string, element] : elements) {
+      result.append(std::move(element));
+    }
+    return result;
+  } else if (value.isObject()) {
+    // Members of json objects are already sorted by name.
+    auto result = Json::Value(Json::objectValue);
+    for (const auto& member : value.getMemberNames()) {
+      result[member] = canonicalize(value[member]);
+    }
+    return result;
+  } else {
+    return value;
+  }
+}
+
+std::string_view ModelIndex::model_line(std::size_t index) const {
+  auto layout = make_layout(data_);
+  mt_assert(index < layout.header->number_entries);
+  const auto& record = layout.entries[index].line;
+  return line(record.shard, record.offset, record.length);
+}
+
+std::string_view ModelIndex::line(
+    std::uint64_t shard,
+    std::uint64_t offset,
+    std::uint64_t length) const {
+  mt_assert(shard < shards_.size());
+  auto& entry = *shards_[shard];
+  std::call_once(entry.mapped, [&entry]() {
+    try {
+      entry.mapping.open(entry.path.string());
+    } catch (const std::exception& exception) {
+      WARNING(
+          1, "Unable to map `{}`: {}", entry.path.string(), exception.what());
+    }
+  });
+  if (!entry.mapping.is_open() || offset + length > entry.mapping.size()) {
+    throw std::runtime_error(fmt::format(
+        "Unable to read `{}` at offset {}, it changed since it was indexed.",
+        entry.path.string(),
+        offset));
+  }
+  return std::string_view(entry.mapping.data() + offset, length);
+}
+
+} // namespace marianatrench
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <json/json.h>
+
+#include <mariana-trench/Compiler.h>
+
+namespace marianatrench {
+
+/**
+ * Index of the models and issues written by an analysis run.
+ *
+ * The index maps each method (or field) to the line holding its model in the
+ * `model@*.json` shards, each kind to the methods whose model mentions it, and
+ * each rule code to the lines holding its issues (in the `model@*.json` or
+ * `issues@*.json` shards).
+ *
+ * The index is stored on disk as a flat array of fixed-size records followed
+ * by a string table. Loading it only maps the file in memory: lookups are
+ * binary searches over the mapping and never parse the index itself. Shards
+ * are mapped on the first read of one of their lines, which is located by its
+ * byte offset, so only the requested lines are parsed.
+ */
+class ModelIndex final {
+ public:
+  struct Diff {
+    /* Methods or fields only present in the second run. */
+    std::vector<std::string> added;
+    /* Methods or fields only present in the first run. */
+    std::vector<std::string> removed;
+    /* Methods or fields whose models differ, with the fields that differ. */
+    std::vector<std::pair<std::string, std::vector<std::string>>> changed;
+  };
+
+ public:
+  ModelIndex(const ModelIndex&) = delete;
+  ModelIndex(ModelIndex&&) = delete;
+  ModelIndex& operator=(const ModelIndex&) = delete;
+  ModelIndex& operator=(ModelIndex&&) = delete;
+  ~ModelIndex() = default;
+
+  /**
+   * Index the shards in the given output directory, in parallel, and write the
+   * index at the given path.
+   *
+   * The index is written to a temporary file which is then renamed.
+   */
+  static void build(
+      const boost::filesystem::path& output_directory,
+      const boost::filesystem::path& index_path);
+
+  /**
+   * Map the index at the given path.
+   *
+   * Returns `nullptr` if the index does not exist, has a different version or
+   * is outdated, i.e the size or modification time of the shards in the output
+   * directory changed since. Shards are not read.
+   */
+  static std::unique_ptr<ModelIndex> MT_NULLABLE open(
+      const boost::filesystem::path& output_directory,
+      const boost::filesystem::path& index_path);
+
+  /* Number of indexed methods and fields. */
+  std::size_t size() const;
+
+  /* Return the name of the method or field at the given position. */
+  std::string_view name(std::size_t index) const;
+
+  /* Return the JSON line of the model for the given method or field. */
+  std::optional<std::string_view> model(std::string_view name) const;
+
+  /* Return all methods and fields matching the given regular expression. */
+  std::vector<std::string_view> names_matching(
+      const std::string& pattern) const;
+
+  /* Return all methods and fields whose model mentions the given kind. */
+  std::vector<std::string_view> names_with_kind(std::string_view kind) const;
+
+  /**
+   * Return all issues for the given rule code, as objects with the `method`
+   * and the `issue`.
+   */
+  std::vector<Json::Value> issues(int code) const;
+
+  /**
+   * Compare the models of two runs, in parallel.
+   *
+   * Models are compared semantically: the order of keys and of elements in
+   * arrays is ignored.
+   */
+  static Diff diff(const ModelIndex& left, const ModelIndex& right);
+
+  /* Name of a model, as used in the index. */
+  static std::string name(const Json::Value& model);
+
+  /**
+   * Return a copy of the given value where the elements of all arrays are
+   * sorted, so that semantically equal values compare equal.
+   */
+  static Json::Value canonicalize(const Json::Value& value);
+
+ private:
+  ModelIndex() = default;
+
+  /* Return the JSON line of the model at the given position. */
+  std::string_view model_line(std::size_t index) const;
+
+  /* Return the given line of a shard, mapping the shard if needed. */
+  std::string_view line(
+      std::uint64_t shard,
+      std::uint64_t offset,
+      std::uint64_t length) const;
+
+ private:
+  struct Shard {
+    boost::filesystem::path path;
+    std::once_flag mapped;
+    boost::iostreams::mapped_file_source mapping;
+  };
+
+  boost::iostreams::mapped_file_source mapping_;
+  const char* data_ = nullptr;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+} // namespace marianatrench
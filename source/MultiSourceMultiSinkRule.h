@@ -55,6 +55,10 @@ class MultiSourceMultiSinkRule final : public Rule {
     return multi_source_kinds_;
   }
 
+  const PartialKindSet& partial_sink_kinds() const {
+    return partial_sink_kinds_;
+  }
+
   PartialKindSet partial_sink_kinds(const std::string& label) const;
 
   bool uses(const Kind*) const override;
@@ -16,6 +16,8 @@
 #include <mach/mach.h>
 #include <mach/mach_init.h>
 #include <mach/mach_types.h>
+#include <sys/sysctl.h>
+#include <sys/types.h>
 #endif
 
 namespace marianatrench {
@@ -49,4 +51,31 @@ double resident_set_size_in_gb() {
   return -1.0;
 }
 
+double total_memory_in_gb() {
+#if __APPLE__
+  int64_t memory_size = 0;
+  std::size_t length = sizeof(memory_size);
+  if (sysctlbyname("hw.memsize", &memory_size, &length, nullptr, 0) != 0) {
+    ERROR(1, "Call to `sysctlbyname()` failed");
+  } else {
+    return static_cast<double>(memory_size) / 1000.0 / 1000.0 / 1000.0;
+  }
+#elif __linux__
+  try {
+    std::ifstream infile("/proc/meminfo");
+    std::string line;
+    while (std::getline(infile, line)) {
+      if (boost::starts_with(line, "MemTotal:")) {
+        return static_cast<double>(std::stoll(line.substr(9), nullptr)) /
+            1000.0 / 1000.0;
+      }
+    }
+    ERROR(1, "Total memory not found in `/proc/meminfo`");
+  } catch (const std::exception& error) {
+    ERROR(1, "Failed to read `/proc/meminfo`: {}", error.what());
+  }
+#endif
+  return -1.0;
+}
+
 } // namespace marianatrench
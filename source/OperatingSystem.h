@@ -10,4 +10,7 @@ namespace marianatrench {
 /* Returns -1 for unsupported operating systems. */
 double resident_set_size_in_gb();
 
+/* Returns the total physical memory, or -1 for unsupported systems. */
+double total_memory_in_gb();
+
 } // namespace marianatrench
@@ -120,12 +120,19 @@ Options::Options(
       remove_unreachable_code_(remove_unreachable_code),
       disable_parameter_type_overrides_(false),
       maximum_method_analysis_time_(std::nullopt),
+      rules_filter_(std::nullopt),
+      memory_limit_(std::nullopt),
+      max_number_origins_(std::nullopt),
       maximum_source_sink_distance_(10),
       dump_class_hierarchies_(false),
       dump_overrides_(false),
       dump_call_graph_(false),
       dump_dependencies_(false),
-      dump_methods_(false) {}
+      dump_methods_(false),
+      stream_issues_(false),
+      replay_snapshot_slow_methods_(false),
+      preprocessing_snapshot_directory_(std::nullopt),
+      daemon_socket_path_(std::nullopt) {}
 
 Options::Options(const boost::program_options::variables_map& variables) {
   system_jar_paths_ = parse_paths_list(
@@ -183,6 +190,12 @@ Options::Options(const boost::program_options::variables_map& variables) {
         variables["source-exclude-directories"].as<std::string>(),
         /* extension */ std::nullopt);
   }
+  if (!variables["source-index-path"].empty()) {
+    // Indexing changes the current directory, use an absolute path.
+    source_index_path_ = boost::filesystem::absolute(
+                             variables["source-index-path"].as<std::string>())
+                             .string();
+  }
 
   apk_path_ = check_path_exists(variables["apk-path"].as<std::string>());
   output_directory_ = boost::filesystem::path(
@@ -200,6 +213,20 @@ Options::Options(const boost::program_options::variables_map& variables) {
       ? std::nullopt
       : std::make_optional<int>(
             variables["maximum-method-analysis-time"].as<int>());
+  if (!variables["rules-filter"].empty()) {
+    rules_filter_ = variables["rules-filter"].as<std::vector<int>>();
+  }
+  if (!variables["memory-limit"].empty()) {
+    memory_limit_ = variables["memory-limit"].as<double>();
+  }
+  if (!variables["max-number-origins"].empty()) {
+    auto max_number_origins = variables["max-number-origins"].as<int>();
+    if (max_number_origins <= 0) {
+      throw std::invalid_argument(
+          "Expected a positive value for `--max-number-origins`.");
+    }
+    max_number_origins_ = max_number_origins;
+  }
   maximum_source_sink_distance_ =
       variables["maximum-source-sink-distance"].as<int>();
 
@@ -211,6 +238,25 @@ Options::Options(const boost::program_options::variables_map& variables) {
   dump_call_graph_ = variables.count("dump-call-graph") > 0;
   dump_dependencies_ = variables.count("dump-dependencies") > 0;
   dump_methods_ = variables.count("dump-methods") > 0;
+  stream_issues_ = variables.count("stream-issues") > 0;
+
+  if (!variables["replay-snapshot-method"].empty()) {
+    replay_snapshot_methods_ =
+        variables["replay-snapshot-method"].as<std::vector<std::string>>();
+  }
+  replay_snapshot_slow_methods_ =
+      variables.count("replay-snapshot-slow-methods") > 0;
+  if (!variables["replay-snapshot"].empty()) {
+    replay_snapshot_path_ =
+        check_path_exists(variables["replay-snapshot"].as<std::string>());
+  }
+  if (!variables["preprocessing-snapshot-directory"].empty()) {
+    preprocessing_snapshot_directory_ = check_directory_exists(
+        variables["preprocessing-snapshot-directory"].as<std::string>());
+  }
+  if (!variables["daemon-socket"].empty()) {
+    daemon_socket_path_ = variables["daemon-socket"].as<std::string>();
+  }
 
   job_id_ = variables.count("job-id") == 0
       ? std::nullopt
@@ -277,6 +323,10 @@ void Options::add_options(
       "source-exclude-directories",
       program_options::value<std::string>(),
       "A `;`-separated list of directories that should be excluded from indexed source files.");
+  options.add_options()(
+      "source-index-path",
+      program_options::value<std::string>(),
+      "Path to a file used to persist the source index across runs. Only new or modified source files are indexed again.");
 
   options.add_options()(
       "apk-path",
@@ -303,6 +353,18 @@ void Options::add_options(
       "maximum-method-analysis-time",
       program_options::value<int>(),
       "Specify number of seconds as a bound. If the analysis of a method takes longer than this then make the method obscure (default taint-in-taint-out).");
+  options.add_options()(
+      "rules-filter",
+      program_options::value<std::vector<int>>()->multitoken(),
+      "Only report issues for the given rule codes. Methods that cannot carry taint for these rules are not analyzed.");
+  options.add_options()(
+      "memory-limit",
+      program_options::value<double>(),
+      "Memory available to the analysis, in GB (default: total physical memory). The analysis reduces its precision when getting close to this limit.");
+  options.add_options()(
+      "max-number-origins",
+      program_options::value<int>(),
+      "Collapse the origins of a frame once there are more than this number of them, e.g 100 (default: no maximum). This bounds memory on large apps at the cost of precision.");
 
   options.add_options()(
       "maximum-source-sink-distance",
@@ -324,6 +386,29 @@ void Options::add_options(
       "dump-dependencies", "Dump the dependency graph in `dependencies.json`.");
   options.add_options()(
       "dump-methods", "Dump the list of method signatures in `methods.json`.");
+  options.add_options()(
+      "stream-issues",
+      "Write issues to separate `issues@*.json` files, one method at a time, instead of with the models.");
+
+  options.add_options()(
+      "replay-snapshot-method",
+      program_options::value<std::vector<std::string>>()->multitoken(),
+      "Save the inputs of the analysis of the given methods in the `replay` output directory.");
+  options.add_options()(
+      "replay-snapshot-slow-methods",
+      "Save the inputs of the analysis of slow methods in the `replay` output directory.");
+  options.add_options()(
+      "replay-snapshot",
+      program_options::value<std::string>(),
+      "Only re-run the analysis of the method saved in the given replay snapshot.");
+  options.add_options()(
+      "preprocessing-snapshot-directory",
+      program_options::value<std::string>(),
+      "Directory where a snapshot of the preprocessing phases (class hierarchies, overrides, types) is stored and restored from, keyed by the APK and options.");
+  options.add_options()(
+      "daemon-socket",
+      program_options::value<std::string>(),
+      "Keep the program in memory and serve analysis requests on the given unix domain socket.");
 
   options.add_options()(
       "job-id",
@@ -384,6 +469,10 @@ const std::vector<std::string>& Options::source_exclude_directories() const {
   return source_exclude_directories_;
 }
 
+const std::optional<std::string>& Options::source_index_path() const {
+  return source_index_path_;
+}
+
 const std::vector<std::string>& Options::system_jar_paths() const {
   return system_jar_paths_;
 }
@@ -432,6 +521,11 @@ const boost::filesystem::path Options::dependencies_output_path() const {
   return output_directory_ / "dependencies.json";
 }
 
+const boost::filesystem::path Options::replay_snapshots_output_directory()
+    const {
+  return output_directory_ / "replay";
+}
+
 bool Options::sequential() const {
   return sequential_;
 }
@@ -456,6 +550,18 @@ std::optional<int> Options::maximum_method_analysis_time() const {
   return maximum_method_analysis_time_;
 }
 
+const std::optional<std::vector<int>>& Options::rules_filter() const {
+  return rules_filter_;
+}
+
+std::optional<double> Options::memory_limit() const {
+  return memory_limit_;
+}
+
+std::optional<std::size_t> Options::max_number_origins() const {
+  return max_number_origins_;
+}
+
 int Options::maximum_source_sink_distance() const {
   return maximum_source_sink_distance_;
 }
@@ -484,6 +590,31 @@ bool Options::dump_methods() const {
   return dump_methods_;
 }
 
+bool Options::stream_issues() const {
+  return stream_issues_;
+}
+
+const std::vector<std::string>& Options::replay_snapshot_methods() const {
+  return replay_snapshot_methods_;
+}
+
+bool Options::replay_snapshot_slow_methods() const {
+  return replay_snapshot_slow_methods_;
+}
+
+const std::optional<std::string>& Options::replay_snapshot_path() const {
+  return replay_snapshot_path_;
+}
+
+const std::optional<std::string>& Options::preprocessing_snapshot_directory()
+    const {
+  return preprocessing_snapshot_directory_;
+}
+
+const std::optional<std::string>& Options::daemon_socket_path() const {
+  return daemon_socket_path_;
+}
+
 const std::optional<std::string>& Options::job_id() const {
   return job_id_;
 }
@@ -59,6 +59,7 @@ class Options final {
   const std::string& repository_root_directory() const;
   const std::string& source_root_directory() const;
   const std::vector<std::string>& source_exclude_directories() const;
+  const std::optional<std::string>& source_index_path() const;
 
   const std::vector<std::string>& system_jar_paths() const;
 
@@ -75,6 +76,7 @@ class Options final {
   const boost::filesystem::path class_hierarchies_output_path() const;
   const boost::filesystem::path overrides_output_path() const;
   const boost::filesystem::path dependencies_output_path() const;
+  const boost::filesystem::path replay_snapshots_output_directory() const;
 
   bool sequential() const;
   bool skip_source_indexing() const;
@@ -82,6 +84,9 @@ class Options final {
   bool disable_parameter_type_overrides() const;
   bool remove_unreachable_code() const;
   std::optional<int> maximum_method_analysis_time() const;
+  const std::optional<std::vector<int>>& rules_filter() const;
+  std::optional<double> memory_limit() const;
+  std::optional<std::size_t> max_number_origins() const;
 
   int maximum_source_sink_distance() const;
 
@@ -91,6 +96,14 @@ class Options final {
   bool dump_call_graph() const;
   bool dump_dependencies() const;
   bool dump_methods() const;
+  bool stream_issues() const;
+
+  const std::vector<std::string>& replay_snapshot_methods() const;
+  bool replay_snapshot_slow_methods() const;
+  const std::optional<std::string>& replay_snapshot_path() const;
+
+  const std::optional<std::string>& preprocessing_snapshot_directory() const;
+  const std::optional<std::string>& daemon_socket_path() const;
 
   const std::optional<std::string>& job_id() const;
   const std::optional<std::string>& metarun_id() const;
@@ -111,6 +124,7 @@ class Options final {
   std::string repository_root_directory_;
   std::string source_root_directory_;
   std::vector<std::string> source_exclude_directories_;
+  std::optional<std::string> source_index_path_;
 
   std::vector<std::string> system_jar_paths_;
   std::string apk_directory_;
@@ -125,6 +139,9 @@ class Options final {
   bool remove_unreachable_code_;
   bool disable_parameter_type_overrides_;
   std::optional<int> maximum_method_analysis_time_;
+  std::optional<std::vector<int>> rules_filter_;
+  std::optional<double> memory_limit_;
+  std::optional<std::size_t> max_number_origins_;
 
   int maximum_source_sink_distance_;
 
@@ -134,6 +151,14 @@ class Options final {
   bool dump_call_graph_;
   bool dump_dependencies_;
   bool dump_methods_;
+  bool stream_issues_;
+
+  std::vector<std::string> replay_snapshot_methods_;
+  bool replay_snapshot_slow_methods_;
+  std::optional<std::string> replay_snapshot_path_;
+
+  std::optional<std::string> preprocessing_snapshot_directory_;
+  std::optional<std::string> daemon_socket_path_;
 
   std::optional<std::string> job_id_;
   std::optional<std::string> metarun_id_;
@@ -94,4 +94,39 @@ Json::Value Overrides::to_json() const {
   return value;
 }
 
+namespace {
+
+const Method* method_from_json(
+    const Methods& methods,
+    const Json::Value& value) {
+  const auto* method = methods.get(JsonValidation::string(value));
+  if (method == nullptr) {
+    throw JsonValidationError(
+        value, /* field */ std::nullopt, /* expected */ "existing method");
+  }
+  return method;
+}
+
+} // namespace
+
+std::unique_ptr<Overrides> Overrides::from_json(
+    const Json::Value& value,
+    const Methods& methods) {
+  JsonValidation::validate_object(value);
+
+  // The constructor is private, hence `std::make_unique` cannot be used.
+  auto overrides = std::unique_ptr<Overrides>(new Overrides());
+  for (auto iterator = value.begin(); iterator != value.end(); ++iterator) {
+    const auto* method =
+        method_from_json(methods, Json::Value(iterator.name()));
+    std::unordered_set<const Method*> method_overrides;
+    for (const auto& override : JsonValidation::null_or_array(*iterator)) {
+      method_overrides.insert(method_from_json(methods, override));
+    }
+    overrides->set(method, std::move(method_overrides));
+  }
+
+  return overrides;
+}
+
 } // namespace marianatrench
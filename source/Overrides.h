@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <memory>
 #include <unordered_set>
 
 #include <json/json.h>
@@ -49,7 +50,14 @@ class Overrides final {
 
   Json::Value to_json() const;
 
+  /* Restore the override graph from the output of `to_json`. */
+  static std::unique_ptr<Overrides> from_json(
+      const Json::Value& value,
+      const Methods& methods);
+
  private:
+  Overrides() = default;
+
   UniquePointerConcurrentMap<const Method*, std::unordered_set<const Method*>>
       overrides_;
   std::unordered_set<const Method*> empty_method_set_;
@@ -0,0 +1,852 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <AbstractDomain.h>
+
+#include <mariana-trench/Assert.h>
+#include <mariana-trench/Compiler.h>
+#include <mariana-trench/GroupHashedSetAbstractDomain.h>
+
+namespace marianatrench {
+
+/**
+ * A powerset abstract domain with grouping implemented using a persistent hash
+ * array mapped trie (HAMT).
+ *
+ * This has the same semantics as `GroupHashedSetAbstractDomain`, but nodes are
+ * immutable and shared between copies: copying the set is O(1), and updating
+ * it only copies the nodes on the path to the updated element. `leq`,
+ * `equals`, `join_with` and `difference_with` skip subtrees that are shared
+ * between both operands.
+ *
+ * Nodes that are not shared with another set are updated in place.
+ */
+template <
+    typename Element,
+    typename GroupHash,
+    typename GroupEqual,
+    typename GroupDifference = detail::GroupDifference<Element>>
+class PersistentGroupHashedSetAbstractDomain final
+    : public sparta::AbstractDomain<PersistentGroupHashedSetAbstractDomain<
+          Element,
+          GroupHash,
+          GroupEqual,
+          GroupDifference>> {
+ public:
+  static_assert(std::is_same_v<
+                decltype(GroupHash()(std::declval<const Element>())),
+                std::size_t>);
+  static_assert(std::is_same_v<
+                decltype(GroupEqual()(
+                    std::declval<const Element>(),
+                    std::declval<const Element>())),
+                bool>);
+  static_assert(std::is_same_v<
+                decltype(GroupDifference()(
+                    std::declval<Element&>(),
+                    std::declval<const Element>())),
+                void>);
+
+ private:
+  static constexpr std::size_t k_bits_per_level = 5;
+  static constexpr std::size_t k_level_mask = (1 << k_bits_per_level) - 1;
+  static constexpr std::size_t k_max_depth =
+      (sizeof(std::size_t) * 8 + k_bits_per_level - 1) / k_bits_per_level;
+
+  struct Node;
+  using NodePtr = std::shared_ptr<Node>;
+
+  /**
+   * A node is either a leaf, holding all elements with the same group hash, or
+   * a branch, holding up to 32 children indexed by the next 5 bits of the
+   * hash.
+   *
+   * The trie is kept canonical: a branch never has a single leaf child, so
+   * the shape of the trie only depends on the set of hashes.
+   */
+  struct Node {
+    bool leaf;
+    /* Number of elements in the subtree. */
+    std::size_t size = 0;
+    /* For leaves, the group hash of all elements. */
+    std::size_t hash = 0;
+    std::vector<Element> elements;
+    /* For branches, the bitmap of non-empty children. */
+    std::uint32_t bitmap = 0;
+    std::vector<NodePtr> children;
+  };
+
+  class ConstIterator final {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Element;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Element*;
+    using reference = const Element&;
+
+    /* Create the end iterator. */
+    ConstIterator() = default;
+
+    explicit ConstIterator(const Node* MT_NULLABLE root) {
+      if (root != nullptr) {
+        descend(root);
+      }
+    }
+
+    ConstIterator(const ConstIterator&) = default;
+    ConstIterator(ConstIterator&&) = default;
+    ConstIterator& operator=(const ConstIterator&) = default;
+    ConstIterator& operator=(ConstIterator&&) = default;
+    ~ConstIterator() = default;
+
+    reference operator*() const {
+      return leaf_->elements[element_];
+    }
+
+    pointer operator->() const {
+      return &leaf_->elements[element_];
+    }
+
+    ConstIterator& operator++() {
+      if (++element_ < leaf_->elements.size()) {
+        return *this;
+      }
+
+      while (depth_ > 0) {
+        auto& [branch, child] = stack_[depth_ - 1];
+        if (++child < branch->children.size()) {
+          descend(branch->children[child].get());
+          return *this;
+        }
+        depth_--;
+      }
+      leaf_ = nullptr;
+      element_ = 0;
+      return *this;
+    }
+
+    ConstIterator operator++(int) {
+      ConstIterator result = *this;
+      ++(*this);
+      return result;
+    }
+
+    bool operator==(const ConstIterator& other) const {
+      return leaf_ == other.leaf_ && element_ == other.element_;
+    }
+
+    bool operator!=(const ConstIterator& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    void descend(const Node* node) {
+      while (!node->leaf) {
+        mt_assert(depth_ < k_max_depth);
+        stack_[depth_++] = {node, 0};
+        node = node->children.front().get();
+      }
+      leaf_ = node;
+      element_ = 0;
+    }
+
+   private:
+    std::array<std::pair<const Node*, std::size_t>, k_max_depth> stack_;
+    std::size_t depth_ = 0;
+    const Node* MT_NULLABLE leaf_ = nullptr;
+    std::size_t element_ = 0;
+  };
+
+ public:
+  // C++ container concept member types
+  using iterator = ConstIterator;
+  using const_iterator = ConstIterator;
+  using value_type = Element;
+  using difference_type = std::ptrdiff_t;
+  using size_type = std::size_t;
+  using const_reference = const Element&;
+  using const_pointer = const Element*;
+
+ public:
+  /* Create the bottom (i.e, empty) abstract set. */
+  PersistentGroupHashedSetAbstractDomain() = default;
+
+  explicit PersistentGroupHashedSetAbstractDomain(const Element& element) {
+    add(element);
+  }
+
+  explicit PersistentGroupHashedSetAbstractDomain(
+      std::initializer_list<Element> elements) {
+    for (const auto& element : elements) {
+      add(element);
+    }
+  }
+
+  PersistentGroupHashedSetAbstractDomain(
+      const PersistentGroupHashedSetAbstractDomain&) = default;
+  PersistentGroupHashedSetAbstractDomain(
+      PersistentGroupHashedSetAbstractDomain&&) = default;
+  PersistentGroupHashedSetAbstractDomain& operator=(
+      const PersistentGroupHashedSetAbstractDomain&) = default;
+  PersistentGroupHashedSetAbstractDomain& operator=(
+      PersistentGroupHashedSetAbstractDomain&&) = default;
+
+  static PersistentGroupHashedSetAbstractDomain bottom() {
+    return PersistentGroupHashedSetAbstractDomain();
+  }
+
+  static PersistentGroupHashedSetAbstractDomain top() {
+    mt_unreachable(); // Not implemented.
+  }
+
+  bool is_bottom() const override {
+    return root_ == nullptr;
+  }
+
+  bool is_top() const override {
+    return false;
+  }
+
+  void set_to_bottom() override {
+    root_ = nullptr;
+  }
+
+  void set_to_top() override {
+    mt_unreachable(); // Not implemented.
+  }
+
+  std::size_t size() const {
+    return root_ == nullptr ? 0 : root_->size;
+  }
+
+  bool empty() const {
+    return root_ == nullptr;
+  }
+
+  ConstIterator begin() const {
+    return ConstIterator(root_.get());
+  }
+
+  ConstIterator end() const {
+    return ConstIterator();
+  }
+
+  bool contains(const Element& element) const {
+    if (element.is_bottom()) {
+      return true;
+    }
+
+    const auto* found = find(root_.get(), GroupHash()(element), 0, element);
+    return found != nullptr && element.leq(*found);
+  }
+
+  void add(const Element& element) {
+    if (element.is_bottom()) {
+      return;
+    }
+
+    insert(root_, GroupHash()(element), 0, element);
+  }
+
+  void remove(const Element& element) {
+    if (element.is_bottom()) {
+      return;
+    }
+
+    auto hash = GroupHash()(element);
+    const auto* found = find(root_.get(), hash, 0, element);
+    if (found != nullptr && found->leq(element)) {
+      update(root_, hash, 0, element, [](Element& existing) {
+        existing.set_to_bottom();
+      });
+    }
+  }
+
+  void clear() {
+    root_ = nullptr;
+  }
+
+  bool leq(const PersistentGroupHashedSetAbstractDomain& other) const override {
+    return leq(root_.get(), other.root_.get(), 0);
+  }
+
+  bool equals(
+      const PersistentGroupHashedSetAbstractDomain& other) const override {
+    return equals(root_.get(), other.root_.get(), 0);
+  }
+
+  void join_with(const PersistentGroupHashedSetAbstractDomain& other) override {
+    root_ = join(root_, other.root_, 0);
+  }
+
+  void widen_with(
+      const PersistentGroupHashedSetAbstractDomain& other) override {
+    join_with(other);
+  }
+
+  void meet_with(
+      const PersistentGroupHashedSetAbstractDomain& /*other*/) override {
+    mt_unreachable(); // Not implemented.
+  }
+
+  void narrow_with(
+      const PersistentGroupHashedSetAbstractDomain& other) override {
+    meet_with(other);
+  }
+
+  void difference_with(const PersistentGroupHashedSetAbstractDomain& other) {
+    root_ = difference(root_, other.root_, 0);
+  }
+
+  /* Update all elements without affecting the grouping. */
+  void map(const std::function<void(Element&)>& f) {
+    map(root_, f);
+  }
+
+  /* Remove all elements that do not match the given predicate. */
+  void filter(const std::function<bool(const Element&)>& predicate) {
+    root_ = filter(root_, predicate);
+  }
+
+  friend std::ostream& operator<<(
+      std::ostream& out,
+      const PersistentGroupHashedSetAbstractDomain& value) {
+    out << "{";
+    for (auto it = value.begin(); it != value.end();) {
+      out << *it++;
+      if (it != value.end()) {
+        out << ", ";
+      }
+    }
+    return out << "}";
+  }
+
+ private:
+  static std::uint32_t bit(std::size_t hash, std::size_t shift) {
+    return std::uint32_t(1) << ((hash >> shift) & k_level_mask);
+  }
+
+  /* Position of the child for the given bit in a branch. */
+  static std::size_t position(std::uint32_t bitmap, std::uint32_t bit) {
+    return __builtin_popcount(bitmap & (bit - 1));
+  }
+
+  static NodePtr make_leaf(std::size_t hash, std::vector<Element> elements) {
+    auto node = std::make_shared<Node>();
+    node->leaf = true;
+    node->size = elements.size();
+    node->hash = hash;
+    node->elements = std::move(elements);
+    return node;
+  }
+
+  /* Make a canonical branch from the given non-empty children. */
+  static NodePtr make_branch(
+      std::uint32_t bitmap,
+      std::vector<NodePtr> children) {
+    if (children.empty()) {
+      return nullptr;
+    }
+    if (children.size() == 1 && children.front()->leaf) {
+      return std::move(children.front());
+    }
+
+    auto node = std::make_shared<Node>();
+    node->leaf = false;
+    for (const auto& child : children) {
+      node->size += child->size;
+    }
+    node->bitmap = bitmap;
+    node->children = std::move(children);
+    return node;
+  }
+
+  /* Make a branch holding two leaves with different hashes. */
+  static NodePtr merge_leaves(NodePtr left, NodePtr right, std::size_t shift) {
+    mt_assert(left->hash != right->hash);
+    auto left_bit = bit(left->hash, shift);
+    auto right_bit = bit(right->hash, shift);
+    if (left_bit == right_bit) {
+      return make_branch(
+          left_bit,
+          {merge_leaves(
+              std::move(left), std::move(right), shift + k_bits_per_level)});
+    } else if (left_bit < right_bit) {
+      return make_branch(
+          left_bit | right_bit, {std::move(left), std::move(right)});
+    } else {
+      return make_branch(
+          left_bit | right_bit, {std::move(right), std::move(left)});
+    }
+  }
+
+  /* Copy the given node if it is shared with another set. */
+  static Node& make_unique(NodePtr& node) {
+    if (node.use_count() != 1) {
+      node = std::make_shared<Node>(*node);
+    }
+    return *node;
+  }
+
+  /* Return the element with the same group as the given element, if any. */
+  static const Element* MT_NULLABLE find(
+      const Node* MT_NULLABLE node,
+      std::size_t hash,
+      std::size_t shift,
+      const Element& element) {
+    while (node != nullptr && !node->leaf) {
+      auto bit = PersistentGroupHashedSetAbstractDomain::bit(hash, shift);
+      if ((node->bitmap & bit) == 0) {
+        return nullptr;
+      }
+      node = node->children[position(node->bitmap, bit)].get();
+      shift += k_bits_per_level;
+    }
+    if (node == nullptr || node->hash != hash) {
+      return nullptr;
+    }
+    for (const auto& existing : node->elements) {
+      if (GroupEqual()(existing, element)) {
+        return &existing;
+      }
+    }
+    return nullptr;
+  }
+
+  /* Add the given element, joining it with the element of the same group. */
+  static void insert(
+      NodePtr& node,
+      std::size_t hash,
+      std::size_t shift,
+      const Element& element) {
+    // Avoid copying shared nodes if the element is already included.
+    const auto* found = find(node.get(), hash, shift, element);
+    if (found != nullptr) {
+      if (element.leq(*found)) {
+        return;
+      }
+      update(node, hash, shift, element, [&element](Element& existing) {
+        // This is safe as long as `join_with` does not change the grouping.
+        existing.join_with(element);
+      });
+      return;
+    }
+
+    if (node == nullptr) {
+      node = make_leaf(hash, {element});
+      return;
+    }
+    if (node->leaf) {
+      if (node->hash == hash) {
+        auto& leaf = make_unique(node);
+        leaf.elements.push_back(element);
+        leaf.size++;
+      } else {
+        node = merge_leaves(node, make_leaf(hash, {element}), shift);
+      }
+      return;
+    }
+
+    auto& branch = make_unique(node);
+    auto bit = PersistentGroupHashedSetAbstractDomain::bit(hash, shift);
+    auto position = PersistentGroupHashedSetAbstractDomain::position(
+        branch.bitmap, bit);
+    if ((branch.bitmap & bit) == 0) {
+      branch.bitmap |= bit;
+      branch.children.insert(
+          branch.children.begin() + position, make_leaf(hash, {element}));
+    } else {
+      insert(
+          branch.children[position], hash, shift + k_bits_per_level, element);
+    }
+    branch.size++;
+  }
+
+  /**
+   * Apply `f` on the element with the same group as the given element, which
+   * must exist, and remove it if it becomes bottom.
+   */
+  template <typename Function>
+  static void update(
+      NodePtr& node,
+      std::size_t hash,
+      std::size_t shift,
+      const Element& element,
+      const Function& f) {
+    if (node->leaf) {
+      auto& leaf = make_unique(node);
+      auto existing = std::find_if(
+          leaf.elements.begin(),
+          leaf.elements.end(),
+          [&element](const Element& existing) {
+            return GroupEqual()(existing, element);
+          });
+      mt_assert(existing != leaf.elements.end());
+      f(*existing);
+      if (existing->is_bottom()) {
+        leaf.elements.erase(existing);
+        leaf.size--;
+        if (leaf.elements.empty()) {
+          node = nullptr;
+        }
+      }
+      return;
+    }
+
+    auto& branch = make_unique(node);
+    auto bit = PersistentGroupHashedSetAbstractDomain::bit(hash, shift);
+    auto position = PersistentGroupHashedSetAbstractDomain::position(
+        branch.bitmap, bit);
+    auto& child = branch.children[position];
+    auto previous_size = child->size;
+    update(child, hash, shift + k_bits_per_level, element, f);
+    if (child != nullptr) {
+      branch.size = branch.size - previous_size + child->size;
+      if (branch.children.size() == 1 && child->leaf) {
+        // The only child collapsed into a leaf.
+        node = std::move(child);
+      }
+      return;
+    }
+
+    branch.bitmap &= ~bit;
+    branch.children.erase(branch.children.begin() + position);
+    node = make_branch(branch.bitmap, std::move(branch.children));
+  }
+
+  /* Call `f` on all leaves of the given subtree, until it returns false. */
+  template <typename Function>
+  static bool all_leaves(const Node* node, const Function& f) {
+    if (node->leaf) {
+      return f(*node);
+    }
+    for (const auto& child : node->children) {
+      if (!all_leaves(child.get(), f)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static bool leq(
+      const Node* MT_NULLABLE left,
+      const Node* MT_NULLABLE right,
+      std::size_t shift) {
+    if (left == right || left == nullptr) {
+      return true;
+    } else if (right == nullptr || left->size > right->size) {
+      return false;
+    }
+
+    if (!left->leaf && !right->leaf) {
+      if ((left->bitmap & ~right->bitmap) != 0) {
+        return false;
+      }
+      for (auto bits = left->bitmap; bits != 0; bits &= bits - 1) {
+        auto bit = bits & (~bits + 1);
+        if (!leq(left->children[position(left->bitmap, bit)].get(),
+                 right->children[position(right->bitmap, bit)].get(),
+                 shift + k_bits_per_level)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    return all_leaves(left, [right, shift](const Node& leaf) {
+      for (const auto& element : leaf.elements) {
+        const auto* found = find(right, leaf.hash, shift, element);
+        if (found == nullptr || !element.leq(*found)) {
+          return false;
+        }
+      }
+      return true;
+    });
+  }
+
+  static bool equals(
+      const Node* MT_NULLABLE left,
+      const Node* MT_NULLABLE right,
+      std::size_t shift) {
+    if (left == right) {
+      return true;
+    } else if (
+        left == nullptr || right == nullptr || left->size != right->size) {
+      return false;
+    }
+
+    if (!left->leaf && !right->leaf) {
+      // Since the trie is canonical, equal sets have the same shape.
+      if (left->bitmap != right->bitmap) {
+        return false;
+      }
+      for (std::size_t index = 0; index < left->children.size(); index++) {
+        if (!equals(
+                left->children[index].get(),
+                right->children[index].get(),
+                shift + k_bits_per_level)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    return all_leaves(left, [right, shift](const Node& leaf) {
+      for (const auto& element : leaf.elements) {
+        const auto* found = find(right, leaf.hash, shift, element);
+        if (found == nullptr || !(element == *found)) {
+          return false;
+        }
+      }
+      return true;
+    });
+  }
+
+  static NodePtr join(
+      const NodePtr& left,
+      const NodePtr& right,
+      std::size_t shift) {
+    if (left == right || right == nullptr) {
+      return left;
+    } else if (left == nullptr) {
+      return right;
+    }
+
+    if (right->leaf) {
+      auto result = left;
+      for (const auto& element : right->elements) {
+        insert(result, right->hash, shift, element);
+      }
+      return result;
+    } else if (left->leaf) {
+      auto result = right;
+      for (const auto& element : left->elements) {
+        insert(result, left->hash, shift, element);
+      }
+      return result;
+    }
+
+    auto bitmap = left->bitmap | right->bitmap;
+    std::vector<NodePtr> children;
+    children.reserve(__builtin_popcount(bitmap));
+    bool same_as_left = true;
+    bool same_as_right = true;
+    for (auto bits = bitmap; bits != 0; bits &= bits - 1) {
+      auto bit = bits & (~bits + 1);
+      if ((right->bitmap & bit) == 0) {
+        children.push_back(left->children[position(left->bitmap, bit)]);
+        same_as_right = false;
+      } else if ((left->bitmap & bit) == 0) {
+        children.push_back(right->children[position(right->bitmap, bit)]);
+        same_as_left = false;
+      } else {
+        const auto& left_child = left->children[position(left->bitmap, bit)];
+        const auto& right_child =
+            right->children[position(right->bitmap, bit)];
+        auto child = join(left_child, right_child, shift + k_bits_per_level);
+        same_as_left = same_as_left && child == left_child;
+        same_as_right = same_as_right && child == right_child;
+        children.push_back(std::move(child));
+      }
+    }
+
+    if (same_as_left) {
+      return left;
+    } else if (same_as_right) {
+      return right;
+    } else {
+      return make_branch(bitmap, std::move(children));
+    }
+  }
+
+  static NodePtr difference(
+      const NodePtr& left,
+      const NodePtr& right,
+      std::size_t shift) {
+    if (left == nullptr || right == nullptr) {
+      return left;
+    } else if (
+        left == right &&
+        std::is_same_v<GroupDifference, detail::GroupDifference<Element>>) {
+      return nullptr;
+    }
+
+    if (left->leaf) {
+      std::vector<Element> elements;
+      bool changed = false;
+      for (const auto& element : left->elements) {
+        const auto* found = find(right.get(), left->hash, shift, element);
+        if (found == nullptr) {
+          elements.push_back(element);
+          continue;
+        }
+        changed = true;
+        auto result = element;
+        GroupDifference()(result, *found);
+        if (!result.is_bottom()) {
+          elements.push_back(std::move(result));
+        }
+      }
+      if (!changed) {
+        return left;
+      } else if (elements.empty()) {
+        return nullptr;
+      } else {
+        return make_leaf(left->hash, std::move(elements));
+      }
+    } else if (right->leaf) {
+      auto result = left;
+      for (const auto& element : right->elements) {
+        if (find(result.get(), right->hash, shift, element) != nullptr) {
+          update(
+              result,
+              right->hash,
+              shift,
+              element,
+              [&element](Element& existing) {
+                GroupDifference()(existing, element);
+              });
+        }
+      }
+      return result;
+    }
+
+    std::uint32_t bitmap = 0;
+    std::vector<NodePtr> children;
+    children.reserve(left->children.size());
+    bool changed = false;
+    for (auto bits = left->bitmap; bits != 0; bits &= bits - 1) {
+      auto bit = bits & (~bits + 1);
+      const auto& left_child = left->children[position(left->bitmap, bit)];
+      auto child = (right->bitmap & bit) == 0
+          ? left_child
+          : difference(
+                left_child,
+                right->children[position(right->bitmap, bit)],
+                shift + k_bits_per_level);
+      changed = changed || child != left_child;
+      if (child != nullptr) {
+        bitmap |= bit;
+        children.push_back(std::move(child));
+      }
+    }
+
+    if (!changed) {
+      return left;
+    } else {
+      return make_branch(bitmap, std::move(children));
+    }
+  }
+
+  static void map(NodePtr& node, const std::function<void(Element&)>& f) {
+    if (node == nullptr) {
+      return;
+    }
+
+    if (node->leaf) {
+      auto& leaf = make_unique(node);
+      for (auto& element : leaf.elements) {
+        // This is safe as long as `f` does not change the grouping.
+        f(element);
+        mt_assert_log(
+            element.is_bottom() || GroupHash()(element) == leaf.hash,
+            "group hash has changed");
+      }
+      leaf.elements.erase(
+          std::remove_if(
+              leaf.elements.begin(),
+              leaf.elements.end(),
+              [](const Element& element) { return element.is_bottom(); }),
+          leaf.elements.end());
+      leaf.size = leaf.elements.size();
+      if (leaf.elements.empty()) {
+        node = nullptr;
+      }
+      return;
+    }
+
+    auto& branch = make_unique(node);
+    std::uint32_t bitmap = 0;
+    std::vector<NodePtr> children;
+    children.reserve(branch.children.size());
+    auto bits = branch.bitmap;
+    for (auto& child : branch.children) {
+      auto bit = bits & (~bits + 1);
+      bits &= bits - 1;
+      map(child, f);
+      if (child != nullptr) {
+        bitmap |= bit;
+        children.push_back(std::move(child));
+      }
+    }
+    node = make_branch(bitmap, std::move(children));
+  }
+
+  static NodePtr filter(
+      const NodePtr& node,
+      const std::function<bool(const Element&)>& predicate) {
+    if (node == nullptr) {
+      return nullptr;
+    }
+
+    if (node->leaf) {
+      std::vector<Element> elements;
+      for (const auto& element : node->elements) {
+        if (predicate(element)) {
+          elements.push_back(element);
+        }
+      }
+      if (elements.size() == node->elements.size()) {
+        return node;
+      } else if (elements.empty()) {
+        return nullptr;
+      } else {
+        return make_leaf(node->hash, std::move(elements));
+      }
+    }
+
+    std::uint32_t bitmap = 0;
+    std::vector<NodePtr> children;
+    children.reserve(node->children.size());
+    bool changed = false;
+    auto bits = node->bitmap;
+    for (const auto& child : node->children) {
+      auto bit = bits & (~bits + 1);
+      bits &= bits - 1;
+      auto result = filter(child, predicate);
+      changed = changed || result != child;
+      if (result != nullptr) {
+        bitmap |= bit;
+        children.push_back(std::move(result));
+      }
+    }
+
+    if (!changed) {
+      return node;
+    } else {
+      return make_branch(bitmap, std::move(children));
+    }
+  }
+
+ private:
+  NodePtr root_;
+};
+
+} // namespace marianatrench
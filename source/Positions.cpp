@@ -6,12 +6,11 @@
  */
 
 #include <cstdio>
-#include <fstream>
+#include <string_view>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
 #include <fmt/format.h>
-#include <re2/re2.h>
 
 #include <ConcurrentContainers.h>
 #include <DexClass.h>
@@ -24,6 +23,9 @@
 #include <mariana-trench/JsonValidation.h>
 #include <mariana-trench/Log.h>
 #include <mariana-trench/Positions.h>
+#include <mariana-trench/SourceFile.h>
+#include <mariana-trench/SourceIndex.h>
+#include <mariana-trench/SourceScanner.h>
 #include <mariana-trench/Timer.h>
 
 namespace marianatrench {
@@ -32,13 +34,56 @@ namespace {
 
 constexpr int k_unknown_line = -1;
 
-// Performance optimization to avoid calling more expensive regex matches on
-// every line.
-bool maybe_class(const std::string& line) {
-  return line.find("class") != std::string::npos ||
-      line.find("interface") != std::string::npos ||
-      line.find("object") != std::string::npos ||
-      line.find("enum") != std::string::npos;
+/**
+ * Return the top-level classes defined in the given Java or Kotlin file, or
+ * an empty list if the package is skipped. Declarations within comments and
+ * string literals are ignored.
+ */
+std::vector<std::string> scan_classes(
+    const std::string& path,
+    const SourceFile& file,
+    const std::unordered_set<std::string>& skipped_package_prefixes) {
+  std::vector<std::string> classes;
+  std::optional<std::string> package = std::nullopt;
+  bool skipped = false;
+
+  SourceScanner::visit_code_lines(file.content(), [&](std::string_view line) {
+    if (!package) {
+      auto package_match = SourceScanner::package(line);
+      if (!package_match) {
+        return true;
+      }
+      package = std::string(*package_match);
+      boost::replace_all(*package, ".", "/");
+      if (std::any_of(
+              skipped_package_prefixes.begin(),
+              skipped_package_prefixes.end(),
+              [&](const auto& skipped_prefix) {
+                return boost::starts_with(*package, skipped_prefix);
+              })) {
+        LOG(3, "Skipping module `{}` at `{}`...", *package, path);
+        skipped = true;
+        return false;
+      }
+      if (boost::ends_with(path, ".kt")) {
+        auto pos = path.find_last_of("/");
+        if (pos != std::string::npos) {
+          auto filename = path.substr(pos + 1, path.size() - pos - 4);
+          classes.push_back(fmt::format("L{}/{}Kt;", *package, filename));
+        }
+      }
+    }
+
+    if (auto class_name = SourceScanner::class_name(line)) {
+      classes.push_back(fmt::format("L{}/{};", *package, *class_name));
+    }
+    return true;
+  });
+
+  if (skipped) {
+    return {};
+  }
+  return classes;
 }
 
 } // namespace
@@ -101,11 +146,13 @@ Positions::Positions(const Options& options, const DexStoresVector& stores) {
     Timer index_timer;
     LOG(2, "Indexing classes...");
 
+    SourceIndex source_index(options.source_root_directory());
+    if (options.source_index_path()) {
+      source_index.load(*options.source_index_path());
+    }
+
     std::atomic<std::size_t> iteration(0);
     ConcurrentMap<std::string, std::string> class_to_path;
-    re2::RE2 package_regex("^package\\s+([^;]+)(?:;|$)");
-    re2::RE2 class_regex(
-        "^\\s*(?:/\\*.*\\*/)?\\s*(?:public|internal|private)?\\s*(?:abstract|data|final|open)?\\s*(?:class|enum|interface|object)\\s+([A-z0-9]+)");
     std::unordered_set<std::string> skipped_package_prefixes = {
         "android/",
     };
@@ -137,65 +184,22 @@ Positions::Positions(const Options& options, const DexStoresVector& stores) {
             }
           }
 
-          std::optional<std::string> package = std::nullopt;
-
-          std::ifstream stream(*path);
-          std::string line;
-          while (std::getline(stream, line)) {
-            re2::StringPiece package_match;
-            // Using capturing groups with `re2` is very slow, so we only
-            // capture if we know the regex matches. This gives a huge
-            // performance boost.
-            if (!package && re2::RE2::PartialMatch(line, package_regex) &&
-                re2::RE2::PartialMatch(line, package_regex, &package_match)) {
-              package = package_match.as_string();
-              boost::replace_all(*package, ".", "/");
-              if (std::any_of(
-                      skipped_package_prefixes.begin(),
-                      skipped_package_prefixes.end(),
-                      [&](const auto& skipped_prefix) {
-                        return boost::starts_with(*package, skipped_prefix);
-                      })) {
-                LOG(3, "Skipping module `{}` at `{}`...", *package, *path);
-                return;
-              }
-              if (boost::ends_with(*path, ".kt")) {
-                auto pos = path->find_last_of("/");
-                if (pos != std::string::npos) {
-                  auto filename = path->substr(pos + 1, path->size() - pos - 4);
-                  auto classname = fmt::format("L{}/{}Kt;", *package, filename);
-                  class_to_path.update(
-                      classname,
-                      [&path](
-                          const std::string& /* classname */,
-                          std::string& value,
-                          bool exists) {
-                        if (exists && value < *path) {
-                          return;
-                        }
-                        value = *path;
-                      });
-                }
-              }
-            }
-
-            re2::StringPiece class_match;
-            if (package && maybe_class(line) &&
-                re2::RE2::PartialMatch(line, class_regex) &&
-                re2::RE2::PartialMatch(line, class_regex, &class_match)) {
-              auto classname = fmt::format("L{}/{};", *package, class_match);
-              class_to_path.update(
-                  classname,
-                  [&path](
-                      const std::string& /* classname */,
-                      std::string& value,
-                      bool exists) {
-                    if (exists && value < *path) {
-                      return;
-                    }
-                    value = *path;
-                  });
-            }
+          auto classes =
+              source_index.classes(*path, [&](const SourceFile& file) {
+                return scan_classes(*path, file, skipped_package_prefixes);
+              });
+          for (const auto& classname : classes) {
+            class_to_path.update(
+                classname,
+                [&path](
+                    const std::string& /* classname */,
+                    std::string& value,
+                    bool exists) {
+                  if (exists && value < *path) {
+                    return;
+                  }
+                  value = *path;
+                });
           }
         },
         sparta::parallel::default_num_threads());
@@ -206,10 +210,16 @@ Positions::Positions(const Options& options, const DexStoresVector& stores) {
 
     boost::filesystem::current_path(current_path);
 
+    if (options.source_index_path()) {
+      source_index.save(*options.source_index_path());
+    }
+
     LOG(2,
-        "Indexed {} top-level classes in {:.2f}s.",
+        "Indexed {} top-level classes in {:.2f}s ({} files reused from the source index, {} files scanned).",
         class_to_path.size(),
-        index_timer.duration_in_seconds());
+        index_timer.duration_in_seconds(),
+        source_index.hits(),
+        source_index.misses());
 
     Timer method_paths_timer;
     LOG(2, "Indexing method paths...");
@@ -5,9 +5,16 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
 #include <SpartaWorkQueue.h>
 
+#include <mariana-trench/Context.h>
 #include <mariana-trench/Dependencies.h>
+#include <mariana-trench/IssueStore.h>
 #include <mariana-trench/Methods.h>
 #include <mariana-trench/PostprocessTraces.h>
 #include <mariana-trench/Registry.h>
@@ -16,11 +23,118 @@ namespace marianatrench {
 
 namespace {
 
+/**
+ * Index from (callee, callee port) to the kinds of the generations and sinks
+ * on that port, i.e the kinds in `model.generations().raw_read(port).root()`.
+ *
+ * During a round of `remove_collapsed_traces`, the index is only read. Updated
+ * models are staged with `stage` and published at the end of the round with
+ * `commit`, so that only the entries of changed methods are rebuilt.
+ */
+class CalleePortKindsIndex final {
+ private:
+  using KindsByPort =
+      std::unordered_map<AccessPath, std::unordered_set<const Kind*>>;
+
+  struct PortKinds {
+    KindsByPort generations;
+    KindsByPort sinks;
+  };
+
+  struct Entry {
+    PortKinds current;
+    std::optional<PortKinds> next;
+  };
+
+ public:
+  explicit CalleePortKindsIndex(
+      const Registry& registry,
+      const Methods& methods) {
+    for (const auto* method : methods) {
+      index_.emplace(method, Entry{});
+    }
+
+    // Entries are never inserted concurrently, hence this is thread-safe.
+    auto queue = sparta::work_queue<const Method*>(
+        [&](const Method* method) {
+          index_.at(method).current = make_port_kinds(registry.get(method));
+        },
+        sparta::parallel::default_num_threads());
+    for (const auto* method : methods) {
+      queue.add_item(method);
+    }
+    queue.run_all();
+  }
+
+  bool has_generation(
+      const Method* callee,
+      const AccessPath& callee_port,
+      const Kind* kind) const {
+    auto found = index_.find(callee);
+    return found != index_.end() &&
+        contains(found->second.current.generations, callee_port, kind);
+  }
+
+  bool has_sink(
+      const Method* callee,
+      const AccessPath& callee_port,
+      const Kind* kind) const {
+    auto found = index_.find(callee);
+    return found != index_.end() &&
+        contains(found->second.current.sinks, callee_port, kind);
+  }
+
+  /* This is thread-safe as long as each method is staged by a single thread. */
+  void stage(const Method* method, const Model& model) {
+    index_.at(method).next = make_port_kinds(model);
+  }
+
+  void commit(const ConcurrentSet<const Method*>& methods) {
+    for (const auto* method : methods) {
+      auto& entry = index_.at(method);
+      if (entry.next) {
+        entry.current = std::move(*entry.next);
+        entry.next = std::nullopt;
+      }
+    }
+  }
+
+ private:
+  static PortKinds make_port_kinds(const Model& model) {
+    PortKinds result;
+    model.generations().visit(
+        [&](const AccessPath& port, const Taint& generations) {
+          auto& kinds = result.generations[port];
+          for (const auto& frame : generations.frames_iterator()) {
+            kinds.insert(frame.kind());
+          }
+        });
+    model.sinks().visit([&](const AccessPath& port, const Taint& sinks) {
+      auto& kinds = result.sinks[port];
+      for (const auto& frame : sinks.frames_iterator()) {
+        kinds.insert(frame.kind());
+      }
+    });
+    return result;
+  }
+
+  static bool contains(
+      const KindsByPort& kinds_by_port,
+      const AccessPath& port,
+      const Kind* kind) {
+    auto found = kinds_by_port.find(port);
+    return found != kinds_by_port.end() && found->second.count(kind) > 0;
+  }
+
+ private:
+  std::unordered_map<const Method*, Entry> index_;
+};
+
 bool is_valid_generation(
     const Method* MT_NULLABLE callee,
     const AccessPath& callee_port,
     const Kind* kind,
-    const Registry& registry) {
+    const CalleePortKindsIndex& index) {
   if (callee == nullptr) {
     // Leaf frame
     return true;
@@ -31,16 +145,14 @@ bool is_valid_generation(
     // itself is not a leaf (has a callee).
     return true;
   }
-  auto model = registry.get(callee);
-  auto sources = model.generations().raw_read(callee_port).root();
-  return sources.contains_kind(kind);
+  return index.has_generation(callee, callee_port, kind);
 }
 
 bool is_valid_sink(
     const Method* MT_NULLABLE callee,
     const AccessPath& callee_port,
     const Kind* kind,
-    const Registry& registry) {
+    const CalleePortKindsIndex& index) {
   if (callee == nullptr) {
     // Leaf frame
     return true;
@@ -52,10 +164,7 @@ bool is_valid_sink(
     return true;
   }
 
-  auto model = registry.get(callee);
-  auto sinks = model.sinks().raw_read(callee_port).root();
-
-  if (sinks.contains_kind(kind)) {
+  if (index.has_sink(callee, callee_port, kind)) {
     return true;
   }
 
@@ -68,17 +177,70 @@ bool is_valid_sink(
     return false;
   }
 
-  return sinks.contains_kind(sink_triggered_kind->partial_kind());
+  return index.has_sink(
+      callee, callee_port, sink_triggered_kind->partial_kind());
+}
+
+bool has_invalid_frames(
+    const Taint& taint,
+    const std::function<
+        bool(const Method* MT_NULLABLE, const AccessPath&, const Kind*)>&
+        is_valid) {
+  for (const auto& frame : taint.frames_iterator()) {
+    if (!is_valid(frame.callee(), frame.callee_port(), frame.kind())) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool has_invalid_frames(
+    const TaintAccessPathTree& tree,
+    const std::function<
+        bool(const Method* MT_NULLABLE, const AccessPath&, const Kind*)>&
+        is_valid) {
+  bool result = false;
+  tree.visit([&](const AccessPath& /* port */, const Taint& taint) {
+    result = result || has_invalid_frames(taint, is_valid);
+  });
+  return result;
+}
+
+bool has_collapsed_traces(
+    const Model& model,
+    const CalleePortKindsIndex& index) {
+  auto is_valid_generation_frame = [&](const Method* MT_NULLABLE callee,
+                                       const AccessPath& callee_port,
+                                       const Kind* kind) {
+    return is_valid_generation(callee, callee_port, kind, index);
+  };
+  auto is_valid_sink_frame = [&](const Method* MT_NULLABLE callee,
+                                 const AccessPath& callee_port,
+                                 const Kind* kind) {
+    return is_valid_sink(callee, callee_port, kind, index);
+  };
+
+  if (has_invalid_frames(model.generations(), is_valid_generation_frame) ||
+      has_invalid_frames(model.sinks(), is_valid_sink_frame)) {
+    return true;
+  }
+  for (const auto& issue : model.issues()) {
+    if (has_invalid_frames(issue.sources(), is_valid_generation_frame) ||
+        has_invalid_frames(issue.sinks(), is_valid_sink_frame)) {
+      return true;
+    }
+  }
+  return false;
 }
 
 TaintAccessPathTree cull_collapsed_generations(
     TaintAccessPathTree generation_tree,
-    const Registry& registry) {
+    const CalleePortKindsIndex& index) {
   generation_tree.map([&](Taint& generation_taint) {
     generation_taint.filter_invalid_frames([&](const Method* MT_NULLABLE callee,
                                                const AccessPath& callee_port,
                                                const Kind* kind) {
-      return is_valid_generation(callee, callee_port, kind, registry);
+      return is_valid_generation(callee, callee_port, kind, index);
     });
   });
   return generation_tree;
@@ -86,28 +248,30 @@ TaintAccessPathTree cull_collapsed_generations(
 
 TaintAccessPathTree cull_collapsed_sinks(
     TaintAccessPathTree sink_tree,
-    const Registry& registry) {
+    const CalleePortKindsIndex& index) {
   sink_tree.map([&](Taint& sink_taint) {
     sink_taint.filter_invalid_frames([&](const Method* MT_NULLABLE callee,
                                          const AccessPath& callee_port,
                                          const Kind* kind) {
-      return is_valid_sink(callee, callee_port, kind, registry);
+      return is_valid_sink(callee, callee_port, kind, index);
     });
   });
   return sink_tree;
 }
 
-IssueSet cull_collapsed_issues(IssueSet issues, const Registry& registry) {
+IssueSet cull_collapsed_issues(
+    IssueSet issues,
+    const CalleePortKindsIndex& index) {
   issues.map([&](Issue& issue) {
     issue.filter_sources([&](const Method* MT_NULLABLE callee,
                              const AccessPath& callee_port,
                              const Kind* kind) {
-      return is_valid_generation(callee, callee_port, kind, registry);
+      return is_valid_generation(callee, callee_port, kind, index);
     });
     issue.filter_sinks([&](const Method* MT_NULLABLE callee,
                            const AccessPath& callee_port,
                            const Kind* kind) {
-      return is_valid_sink(callee, callee_port, kind, registry);
+      return is_valid_sink(callee, callee_port, kind, index);
     });
   });
   return issues;
@@ -120,6 +284,12 @@ void PostprocessTraces::remove_collapsed_traces(
     const Context& context) {
   // We need to compute a decreasing fixpoint since we might remove empty
   // generations or sinks that are referenced in other models.
+  //
+  // Frames are checked against an index of the kinds on each callee port, so
+  // that we never copy models. Only models with invalid frames are updated and
+  // only their callers are analyzed in the next round.
+
+  auto index = CalleePortKindsIndex(registry, *context.methods);
 
   auto methods = std::make_unique<ConcurrentSet<const Method*>>();
   for (const auto* method : *context.methods) {
@@ -128,33 +298,55 @@ void PostprocessTraces::remove_collapsed_traces(
 
   while (methods->size() > 0) {
     auto new_methods = std::make_unique<ConcurrentSet<const Method*>>();
+    auto changed_methods = ConcurrentSet<const Method*>();
 
     auto queue = sparta::work_queue<const Method*>(
         [&](const Method* method) {
-          const auto old_model = registry.get(method);
+          bool changed = registry.update(method, [&](Model& model) {
+            if (!has_collapsed_traces(model, index)) {
+              return false;
+            }
 
-          auto model = old_model;
-          model.set_generations(
-              cull_collapsed_generations(model.generations(), registry));
-          model.set_sinks(cull_collapsed_sinks(model.sinks(), registry));
-          model.set_issues(cull_collapsed_issues(model.issues(), registry));
+            model.set_generations(
+                cull_collapsed_generations(model.generations(), index));
+            model.set_sinks(cull_collapsed_sinks(model.sinks(), index));
+            model.set_issues(cull_collapsed_issues(model.issues(), index));
+            index.stage(method, model);
+            return true;
+          });
 
-          if (!old_model.leq(model)) {
+          if (changed) {
+            changed_methods.insert(method);
             for (const auto* dependency :
                  context.dependencies->dependencies(method)) {
               new_methods->insert(dependency);
             }
           }
-
-          registry.set(model);
         },
         sparta::parallel::default_num_threads());
     for (const auto* method : *methods) {
       queue.add_item(method);
     }
     queue.run_all();
+
+    index.commit(changed_methods);
     methods = std::move(new_methods);
   }
+
+  // Issues are never read by other models, hence spilled issues are culled in
+  // a single streaming pass once generations and sinks are final.
+  if (auto* issue_store = context.issue_store.get()) {
+    auto queue = sparta::work_queue<const Method*>(
+        [&](const Method* method) {
+          issue_store->set(
+              method, cull_collapsed_issues(issue_store->get(method), index));
+        },
+        sparta::parallel::default_num_threads());
+    for (const auto* method : issue_store->methods()) {
+      queue.add_item(method);
+    }
+    queue.run_all();
+  }
 }
 
 } // namespace marianatrench
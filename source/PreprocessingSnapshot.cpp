@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <mariana-trench/Assert.h>
+#include <mariana-trench/JsonValidation.h>
+#include <mariana-trench/Log.h>
+#include <mariana-trench/PreprocessingSnapshot.h>
+#include <mariana-trench/SourceIndex.h>
+
+namespace marianatrench {
+
+namespace {
+
+// Bump this when the content of a phase changes.
+constexpr int k_version = 1;
+
+std::string hash_to_string(std::uint64_t hash) {
+  return fmt::format("{:016x}", hash);
+}
+
+/* Hash the file in chunks, since apks and jars can be large. */
+std::uint64_t hash_file(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    throw std::runtime_error(fmt::format("Unable to read `{}`.", path));
+  }
+  std::vector<char> buffer(1 << 20);
+  std::uint64_t hash = SourceIndex::k_initial_hash;
+  while (file) {
+    file.read(buffer.data(), buffer.size());
+    hash = SourceIndex::hash(
+        std::string_view(buffer.data(), file.gcount()), hash);
+  }
+  if (file.bad()) {
+    throw std::runtime_error(fmt::format("Unable to read `{}`.", path));
+  }
+  return hash;
+}
+
+} // namespace
+
+PreprocessingSnapshot::PreprocessingSnapshot(const Options& options)
+    : key_(key(options)), loaded_(false), phases_(Json::objectValue) {
+  mt_assert(options.preprocessing_snapshot_directory());
+  path_ = boost::filesystem::path(*options.preprocessing_snapshot_directory()) /
+      fmt::format("preprocessing-{}.json", hash_to_string(key_));
+
+  if (!boost::filesystem::exists(path_)) {
+    LOG(1, "No preprocessing snapshot found at `{}`.", path_.string());
+    return;
+  }
+
+  try {
+    auto value = JsonValidation::parse_json_file(path_);
+    JsonValidation::validate_object(value);
+    if (JsonValidation::integer(value, "version") != k_version ||
+        JsonValidation::string(value, "key") != hash_to_string(key_)) {
+      LOG(1,
+          "Ignoring outdated preprocessing snapshot at `{}`.",
+          path_.string());
+      return;
+    }
+    phases_ = JsonValidation::object(value, "phases");
+    loaded_ = true;
+    LOG(1, "Loaded preprocessing snapshot from `{}`.", path_.string());
+  } catch (const std::exception& exception) {
+    WARNING(
+        1,
+        "Unable to load preprocessing snapshot at `{}`: {}",
+        path_.string(),
+        exception.what());
+    phases_ = Json::Value(Json::objectValue);
+  }
+}
+
+std::optional<Json::Value> PreprocessingSnapshot::get(
+    const std::string& phase) const {
+  if (!phases_.isMember(phase)) {
+    return std::nullopt;
+  }
+  return phases_[phase];
+}
+
+void PreprocessingSnapshot::set(const std::string& phase, Json::Value value) {
+  phases_[phase] = std::move(value);
+}
+
+void PreprocessingSnapshot::save() const {
+  auto value = Json::Value(Json::objectValue);
+  value["version"] = Json::Value(k_version);
+  value["key"] = Json::Value(hash_to_string(key_));
+  value["phases"] = phases_;
+
+  auto temporary_path = path_;
+  temporary_path += boost::filesystem::unique_path(".%%%%-%%%%-%%%%.tmp");
+  try {
+    JsonValidation::write_json_file(temporary_path, value);
+    boost::filesystem::rename(temporary_path, path_);
+  } catch (const std::exception& exception) {
+    WARNING(
+        1,
+        "Unable to write preprocessing snapshot at `{}`: {}",
+        path_.string(),
+        exception.what());
+    boost::system::error_code error;
+    boost::filesystem::remove(temporary_path, error);
+    return;
+  }
+
+  LOG(1, "Wrote preprocessing snapshot to `{}`.", path_.string());
+}
+
+std::uint64_t PreprocessingSnapshot::key(const Options& options) {
+  // Paths are hashed with the content of the files they point to, since the
+  // same path is usually re-used for different builds.
+  std::string key;
+  auto add_file = [&key](const std::string& path) {
+    key.append(path);
+    key.push_back('\0');
+    if (boost::filesystem::exists(path)) {
+      key.append(hash_to_string(hash_file(path)));
+    }
+    key.push_back('\0');
+  };
+
+  add_file(options.apk_path());
+  for (const auto& path : options.system_jar_paths()) {
+    add_file(path);
+  }
+  for (const auto& path : options.proguard_configuration_paths()) {
+    add_file(path);
+  }
+  for (const auto& path : options.lifecycles_paths()) {
+    add_file(path);
+  }
+  key.append(options.remove_unreachable_code() ? "1" : "0");
+  key.append(options.disable_parameter_type_overrides() ? "1" : "0");
+
+  return SourceIndex::hash(key);
+}
+
+} // namespace marianatrench
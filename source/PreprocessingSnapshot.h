@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include <boost/filesystem.hpp>
+#include <json/json.h>
+
+#include <mariana-trench/Options.h>
+
+namespace marianatrench {
+
+/**
+ * A snapshot of the preprocessing phases that only depend on the analyzed
+ * program: the class hierarchies, the override graph and the inferred types.
+ *
+ * The snapshot is stored in a directory, keyed by a hash of the APK and of
+ * the options that change the program (system jars, proguard configurations,
+ * lifecycles, ...). A later run on the same program restores these phases
+ * instead of computing them again.
+ *
+ * Redex objects (types, methods, instructions) are referred to by name or by
+ * position, so that the snapshot does not depend on the process.
+ */
+class PreprocessingSnapshot final {
+ public:
+  /**
+   * Create the snapshot for the program described by the given options. It
+   * is loaded from the snapshot directory if it exists there.
+   */
+  explicit PreprocessingSnapshot(const Options& options);
+
+  PreprocessingSnapshot(const PreprocessingSnapshot&) = delete;
+  PreprocessingSnapshot(PreprocessingSnapshot&&) = delete;
+  PreprocessingSnapshot& operator=(const PreprocessingSnapshot&) = delete;
+  PreprocessingSnapshot& operator=(PreprocessingSnapshot&&) = delete;
+  ~PreprocessingSnapshot() = default;
+
+  /* Whether a valid snapshot was found on disk. */
+  bool loaded() const {
+    return loaded_;
+  }
+
+  /* Return the stored value of the given phase, if any. */
+  std::optional<Json::Value> get(const std::string& phase) const;
+
+  /* Record the value of the given phase, to be written by `save`. */
+  void set(const std::string& phase, Json::Value value);
+
+  /* Atomically write the snapshot in the snapshot directory. */
+  void save() const;
+
+  const boost::filesystem::path& path() const {
+    return path_;
+  }
+
+  /* Hash of the program and the options it depends on. */
+  static std::uint64_t key(const Options& options);
+
+ private:
+  boost::filesystem::path path_;
+  std::uint64_t key_;
+  bool loaded_;
+  Json::Value phases_;
+};
+
+} // namespace marianatrench
@@ -5,6 +5,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <atomic>
 #include <cstdio>
 
 #include <boost/algorithm/string/predicate.hpp>
@@ -14,16 +15,33 @@
 #include <SpartaWorkQueue.h>
 
 #include <json/value.h>
+#include <mariana-trench/IssueStore.h>
 #include <mariana-trench/JsonValidation.h>
 #include <mariana-trench/Log.h>
 #include <mariana-trench/Methods.h>
 #include <mariana-trench/Options.h>
+#include <mariana-trench/Positions.h>
 #include <mariana-trench/Registry.h>
 #include <mariana-trench/Rules.h>
 #include <mariana-trench/Statistics.h>
 
 namespace marianatrench {
 
+namespace {
+
+/* Remove existing shards with the given prefix under this directory. */
+void remove_shards(const boost::filesystem::path& path, const char* prefix) {
+  for (auto& file : boost::filesystem::directory_iterator(path)) {
+    const auto& file_path = file.path();
+    if (boost::filesystem::is_regular_file(file_path) &&
+        boost::starts_with(file_path.filename().string(), prefix)) {
+      boost::filesystem::remove(file_path);
+    }
+  }
+}
+
+} // namespace
+
 Registry::Registry(Context& context) : context_(context) {
   auto queue = sparta::work_queue<const Method*>(
       [&](const Method* method) { set(Model(method, context)); },
@@ -96,7 +114,8 @@ Registry Registry::load(
 void Registry::add_default_models() {
   auto queue = sparta::work_queue<const Method*>(
       [&](const Method* method) {
-        models_.insert(std::make_pair(method, Model(method, context_)));
+        models_.insert(std::make_pair(
+            method, Entry{Model(method, context_), /* summary */ nullptr}));
       },
       sparta::parallel::default_num_threads());
   for (const auto* method : *context_.methods) {
@@ -111,7 +130,7 @@ Model Registry::get(const Method* method) const {
   }
 
   try {
-    return models_.at(method);
+    return thaw(models_.at(method).model);
   } catch (const std::out_of_range&) {
     throw std::runtime_error(fmt::format(
         "Trying to get model for untracked method `{}`.", method->show()));
@@ -130,8 +149,159 @@ FieldModel Registry::get(const Field* field) const {
   }
 }
 
+Model Registry::thaw(const MaybeFrozenModel& model) {
+  if (const auto* frozen =
+          std::get_if<std::shared_ptr<FrozenModel>>(&model)) {
+    return (*frozen)->thaw();
+  }
+  return std::get<Model>(model);
+}
+
+Json::Value Registry::to_json(const MaybeFrozenModel& model) const {
+  return visit(
+      model, [&](const auto& model) { return model.to_json(context_); });
+}
+
+std::shared_ptr<const ExportSummary> Registry::export_summary(
+    const Method* method) const {
+  if (models_.count(method) == 0) {
+    throw std::runtime_error(fmt::format(
+        "Trying to get model for untracked method `{}`.", method->show()));
+  }
+
+  std::shared_ptr<const ExportSummary> summary;
+  models_.update(
+      method,
+      [&](const Method* /* method */, Entry& entry, bool /* exists */) {
+        const auto* model = std::get_if<Model>(&entry.model);
+        if (model == nullptr) {
+          return;
+        }
+        if (entry.summary == nullptr) {
+          // This model was not created through `set` or `update`.
+          entry.summary =
+              std::make_shared<const ExportSummary>(*model, context_);
+        }
+        summary = entry.summary;
+      });
+  return summary;
+}
+
+Model Registry::at_callsite(
+    const Method* callee,
+    const Method* caller,
+    const Position* call_position,
+    const std::vector<const DexType * MT_NULLABLE>& source_register_types,
+    const std::vector<std::optional<std::string>>& source_constant_arguments)
+    const {
+  if (models_.count(callee) == 0) {
+    throw std::runtime_error(fmt::format(
+        "Trying to get model for untracked method `{}`.", callee->show()));
+  }
+
+  std::shared_ptr<const ExportSummary> summary;
+  std::shared_ptr<const FrozenModel> frozen;
+  models_.update(
+      callee,
+      [&](const Method* /* method */, Entry& entry, bool /* exists */) {
+        if (const auto* model =
+                std::get_if<std::shared_ptr<FrozenModel>>(&entry.model)) {
+          frozen = *model;
+          return;
+        }
+        if (entry.summary == nullptr) {
+          entry.summary = std::make_shared<const ExportSummary>(
+              std::get<Model>(entry.model), context_);
+        }
+        summary = entry.summary;
+      });
+
+  // The summary of a frozen model is only built for this call site, so that
+  // stable methods are only kept in their compact form.
+  if (frozen != nullptr) {
+    summary = std::make_shared<const ExportSummary>(*frozen, context_);
+  }
+  return summary->at_callsite(
+      caller,
+      call_position,
+      context_,
+      source_register_types,
+      source_constant_arguments);
+}
+
 void Registry::set(const Model& model) {
-  models_.insert_or_assign(std::make_pair(model.method(), model));
+  auto summary = std::make_shared<const ExportSummary>(model, context_);
+  models_.update(
+      model.method(),
+      [&](const Method* /* method */, Entry& entry, bool /* exists */) {
+        entry.model = model;
+        entry.summary = std::move(summary);
+      });
+}
+
+bool Registry::update(
+    const Method* method,
+    const std::function<bool(Model&)>& updater) {
+  bool changed = false;
+  models_.update(
+      method,
+      [&](const Method* /* method */, Entry& entry, bool exists) {
+        if (!exists) {
+          entry.model = Model(method, context_);
+        }
+        if (const auto* frozen =
+                std::get_if<std::shared_ptr<FrozenModel>>(&entry.model)) {
+          // Only replace the frozen model if it changes, to keep stable
+          // models compact.
+          auto model = (*frozen)->thaw();
+          if (updater(model)) {
+            entry.summary =
+                std::make_shared<const ExportSummary>(model, context_);
+            entry.model = std::move(model);
+            changed = true;
+          }
+          return;
+        }
+        auto& model = std::get<Model>(entry.model);
+        if (updater(model)) {
+          entry.summary =
+              std::make_shared<const ExportSummary>(model, context_);
+          changed = true;
+        }
+      });
+  return changed;
+}
+
+void Registry::freeze(const Method* method) {
+  models_.update(
+      method,
+      [&](const Method* /* method */, Entry& entry, bool exists) {
+        if (!exists) {
+          entry.model = Model(method, context_);
+        }
+        if (const auto* model = std::get_if<Model>(&entry.model)) {
+          entry.model = std::make_shared<FrozenModel>(*model);
+        }
+        // Call sites of frozen models build their summary on demand.
+        entry.summary = nullptr;
+      });
+}
+
+void Registry::freeze_all() {
+  auto queue = sparta::work_queue<const Method*>(
+      [&](const Method* method) { freeze(method); },
+      sparta::parallel::default_num_threads());
+  for (const auto& entry : models_) {
+    queue.add_item(entry.first);
+  }
+  queue.run_all();
+}
+
+bool Registry::is_frozen(const Method* method) const {
+  auto found = models_.find(method);
+  return found != models_.end() &&
+      std::holds_alternative<std::shared_ptr<FrozenModel>>(
+             found->second.model);
 }
 
 std::size_t Registry::models_size() const {
@@ -143,9 +313,11 @@ std::size_t Registry::field_models_size() const {
 }
 
 std::size_t Registry::issues_size() const {
-  std::size_t result = 0;
+  std::size_t result = dumped_issues_size_;
   for (const auto& entry : models_) {
-    result += entry.second.issues().size();
+    result += visit(entry.second.model, [](const auto& model) {
+      return model.issues().size();
+    });
   }
   return result;
 }
@@ -153,12 +325,17 @@ std::size_t Registry::issues_size() const {
 void Registry::join_with(const Model& model) {
   const auto* method = model.method();
   mt_assert(method);
-  auto iterator = models_.find(method);
-  if (iterator != models_.end()) {
-    iterator->second.join_with(model);
-  } else {
-    models_.insert(std::make_pair(method, model));
-  }
+  models_.update(
+      method, [&](const Method* /* method */, Entry& entry, bool exists) {
+        if (exists) {
+          auto joined = thaw(entry.model);
+          joined.join_with(model);
+          entry.model = std::move(joined);
+        } else {
+          entry.model = model;
+        }
+        entry.summary = nullptr;
+      });
 }
 
 void Registry::join_with(const FieldModel& field_model) {
@@ -174,7 +351,7 @@ void Registry::join_with(const FieldModel& field_model) {
 
 void Registry::join_with(const Registry& other) {
   for (const auto& other_model : other.models_) {
-    join_with(other_model.second);
+    join_with(thaw(other_model.second.model));
   }
   for (const auto& other_field_model : other.field_models_) {
     join_with(other_field_model.second);
@@ -206,11 +383,16 @@ void Registry::dump_metadata(const boost::filesystem::path& path) const {
       })));
   statistics["methods_skipped"] = Json::Value(static_cast<Json::UInt64>(
       std::count_if(models_.begin(), models_.end(), [](const auto& model) {
-        return model.second.skip_analysis();
+        return visit(model.second.model, [](const auto& model) {
+          return model.skip_analysis();
+        });
       })));
   value["stats"] = statistics;
 
   value["filename_spec"] = Json::Value("model@*.json");
+  if (context_.options->stream_issues()) {
+    value["issues_filename_spec"] = Json::Value("issues@*.json");
+  }
   value["repo_root"] =
       Json::Value(context_.options->repository_root_directory());
   value["root"] = Json::Value(context_.options->source_root_directory());
@@ -227,7 +409,7 @@ std::string Registry::dump_models() const {
   string << "// @";
   string << "generated\n";
   for (const auto& model : models_) {
-    writer->write(model.second.to_json(context_), &string);
+    writer->write(to_json(model.second.model), &string);
     string << "\n";
   }
   for (const auto& field_model : field_models_) {
@@ -240,8 +422,8 @@ std::string Registry::dump_models() const {
 Json::Value Registry::models_to_json() const {
   auto models_value = Json::Value(Json::objectValue);
   models_value["models"] = Json::Value(Json::arrayValue);
-  for (auto model : models_) {
-    models_value["models"].append(model.second.to_json(context_));
+  for (const auto& model : models_) {
+    models_value["models"].append(to_json(model.second.model));
   }
   models_value["field_models"] = Json::Value(Json::arrayValue);
   for (auto field_model : field_models_) {
@@ -253,23 +435,17 @@ Json::Value Registry::models_to_json() const {
 void Registry::dump_models(
     const boost::filesystem::path& path,
     const std::size_t batch_size) const {
-  // Remove existing model files under this directory.
-  for (auto& file : boost::filesystem::directory_iterator(path)) {
-    const auto& file_path = file.path();
-    if (boost::filesystem::is_regular_file(file_path) &&
-        boost::starts_with(file_path.filename().string(), "model@")) {
-      boost::filesystem::remove(file_path);
-    }
-  }
+  remove_shards(path, "model@");
 
-  std::vector<Model> models;
+  // Models are not copied, frozen models are only thawed while being written.
+  std::vector<const MaybeFrozenModel*> models;
   for (const auto& model : models_) {
-    models.push_back(model.second);
+    models.push_back(&model.second.model);
   }
 
-  std::vector<FieldModel> field_models;
+  std::vector<const FieldModel*> field_models;
   for (const auto& field_model : field_models_) {
-    field_models.push_back(field_model.second);
+    field_models.push_back(&field_model.second);
   }
 
   const auto total_batch =
@@ -297,10 +473,10 @@ void Registry::dump_models(
              i < models.size() + field_models.size();
              i++) {
           if (i < models.size()) {
-            writer->write(models[i].to_json(context_), &batch_stream);
+            writer->write(to_json(*models[i]), &batch_stream);
           } else {
             writer->write(
-                field_models[i - models.size()].to_json(context_),
+                field_models[i - models.size()]->to_json(context_),
                 &batch_stream);
           }
           batch_stream << "\n";
@@ -317,4 +493,85 @@ void Registry::dump_models(
   LOG(1, "Wrote models to {} shards.", total_batch);
 }
 
+void Registry::dump_issues(
+    const boost::filesystem::path& path,
+    const std::size_t batch_size) {
+  remove_shards(path, "issues@");
+
+  std::vector<const Method*> methods;
+  for (const auto& model : models_) {
+    methods.push_back(model.first);
+  }
+
+  const auto total_batch = methods.size() / batch_size + 1;
+  const auto padded_total_batch = fmt::format("{:0>5}", total_batch);
+  std::atomic<std::size_t> issues_size(0);
+
+  auto queue = sparta::work_queue<std::size_t>(
+      [&](std::size_t batch) {
+        const auto padded_batch = fmt::format("{:0>5}", batch);
+        const auto batch_path = path /
+            ("issues@" + padded_batch + "-of-" + padded_total_batch + ".json");
+
+        std::ofstream batch_stream(batch_path.native(), std::ios_base::out);
+        if (!batch_stream.is_open()) {
+          ERROR(1, "Unable to write issues to `{}`.", batch_path.native());
+          return;
+        }
+        batch_stream << "// @"
+                     << "generated\n";
+
+        auto writer = JsonValidation::compact_writer();
+        for (std::size_t i = batch_size * batch;
+             i < batch_size * (batch + 1) && i < methods.size();
+             i++) {
+          const auto* method = methods[i];
+          auto issues = take_issues(method);
+          if (context_.issue_store != nullptr) {
+            issues.join_with(context_.issue_store->get(method));
+            context_.issue_store->set(method, IssueSet::bottom());
+          }
+          if (issues.is_bottom()) {
+            continue;
+          }
+
+          auto value = Json::Value(Json::objectValue);
+          value["method"] = method->to_json();
+          value["position"] = context_.positions->get(method)->to_json();
+          auto issues_value = Json::Value(Json::arrayValue);
+          for (const auto& issue : issues) {
+            issues_value.append(issue.to_json());
+          }
+          value["issues"] = issues_value;
+          issues_size += issues.size();
+
+          writer->write(value, &batch_stream);
+          batch_stream << "\n";
+        }
+        batch_stream.close();
+      },
+      sparta::parallel::default_num_threads());
+
+  for (std::size_t batch = 0; batch < total_batch; batch++) {
+    queue.add_item(batch);
+  }
+  queue.run_all();
+
+  dumped_issues_size_ += issues_size.load();
+  LOG(1, "Wrote {} issues to {} shards.", issues_size.load(), total_batch);
+}
+
+IssueSet Registry::take_issues(const Method* method) {
+  IssueSet issues;
+  models_.update(
+      method,
+      [&](const Method* /* method */, Entry& entry, bool /* exists */) {
+        visit(entry.model, [&](auto& model) {
+          issues = model.issues();
+          model.set_issues({});
+        });
+      });
+  return issues;
+}
+
 } // namespace marianatrench
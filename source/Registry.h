@@ -7,6 +7,13 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
 #include <boost/filesystem/path.hpp>
 #include <json/json.h>
 
@@ -14,9 +21,13 @@
 #include <DexClass.h>
 #include <DexStore.h>
 
+#include <mariana-trench/Compiler.h>
 #include <mariana-trench/Context.h>
+#include <mariana-trench/ExportSummary.h>
 #include <mariana-trench/FieldModel.h>
+#include <mariana-trench/FrozenModel.h>
 #include <mariana-trench/Model.h>
+#include <mariana-trench/Position.h>
 
 namespace {
 
@@ -67,11 +78,58 @@ class Registry final {
   Model get(const Method* method) const;
   FieldModel get(const Field* field) const;
 
+  /**
+   * Return the export summary of the given method, i.e its model in a form
+   * that is cheap to instantiate at call sites. This is thread-safe.
+   *
+   * The summary is computed once per version of the model. Frozen models do
+   * not keep a summary, this returns null for them.
+   */
+  std::shared_ptr<const ExportSummary> export_summary(
+      const Method* method) const;
+
+  /**
+   * Return the model of the given callee at a call site, see
+   * `Model::at_callsite`. This reads frozen models without thawing them. This
+   * is thread-safe.
+   */
+  Model at_callsite(
+      const Method* callee,
+      const Method* caller,
+      const Position* call_position,
+      const std::vector<const DexType * MT_NULLABLE>& source_register_types,
+      const std::vector<std::optional<std::string>>& source_constant_arguments)
+      const;
+
   /* This is thread-safe. */
   void set(const Model& model);
 
+  /**
+   * Update the model of the given method in place, without copying it.
+   * `updater` returns whether it changed the model. A frozen model is only
+   * thawed if it changes. This is thread-safe.
+   */
+  bool update(
+      const Method* method,
+      const std::function<bool(Model&)>& updater);
+
+  /**
+   * Convert the model of the given method into its compact read-only form, see
+   * `FrozenModel`. This should be called once the model stops changing. The
+   * model is thawed on the next write. This is thread-safe.
+   */
+  void freeze(const Method* method);
+
+  /* Freeze the models of all methods. */
+  void freeze_all();
+
+  /* Return whether the model of the given method is frozen. */
+  bool is_frozen(const Method* method) const;
+
   std::size_t models_size() const;
   std::size_t field_models_size() const;
+
+  /* Number of issues, including the ones already written by `dump_issues`. */
   std::size_t issues_size() const;
 
   void join_with(const Model& model);
@@ -85,11 +143,66 @@ class Registry final {
   std::string dump_models() const;
   Json::Value models_to_json() const;
 
+  /**
+   * Write the issues of all methods as `issues@*.json` shards in the given
+   * directory and remove them from the models.
+   *
+   * Each line holds the issues of a single method, in the same format as
+   * models. Issues are moved out of the registry one method at a time, so they
+   * are never all copied at once, and they are not written with the models.
+   */
+  void dump_issues(
+      const boost::filesystem::path& path,
+      const std::size_t shard_limit = k_default_shard_limit);
+
+ private:
+  /**
+   * Frozen models are shared, so that call sites can read them outside of the
+   * lock of their entry. Only their issues are written in place.
+   */
+  using MaybeFrozenModel = std::variant<Model, std::shared_ptr<FrozenModel>>;
+
+  /**
+   * The model of a method and its export summary. They are always updated
+   * together, under the lock of the entry, so that the summary never outlives
+   * the version of the model it was computed from.
+   */
+  struct Entry {
+    MaybeFrozenModel model;
+    /* Export summary of `model`, computed lazily if null. Null if frozen. */
+    std::shared_ptr<const ExportSummary> summary;
+  };
+
+  /* Apply the given function to the model, whether it is frozen or not. */
+  template <typename Function>
+  static auto visit(MaybeFrozenModel& model, Function&& function) {
+    if (auto* frozen = std::get_if<std::shared_ptr<FrozenModel>>(&model)) {
+      return function(**frozen);
+    }
+    return function(std::get<Model>(model));
+  }
+
+  template <typename Function>
+  static auto visit(const MaybeFrozenModel& model, Function&& function) {
+    if (const auto* frozen =
+            std::get_if<std::shared_ptr<FrozenModel>>(&model)) {
+      return function(static_cast<const FrozenModel&>(**frozen));
+    }
+    return function(std::get<Model>(model));
+  }
+
+  static Model thaw(const MaybeFrozenModel& model);
+  Json::Value to_json(const MaybeFrozenModel& model) const;
+
+  /* Remove the issues of the given method and return them. */
+  IssueSet take_issues(const Method* method);
+
  private:
   Context& context_;
 
-  mutable ConcurrentMap<const Method*, Model> models_;
+  mutable ConcurrentMap<const Method*, Entry> models_;
   ConcurrentMap<const Field*, FieldModel> field_models_;
+  std::size_t dumped_issues_size_ = 0;
 };
 
 } // namespace marianatrench
@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <unordered_set>
+
+#include <boost/filesystem/operations.hpp>
+#include <fmt/format.h>
+
+#include <ControlFlow.h>
+#include <IRCode.h>
+
+#include <mariana-trench/CallGraph.h>
+#include <mariana-trench/ClassProperties.h>
+#include <mariana-trench/Dependencies.h>
+#include <mariana-trench/Field.h>
+#include <mariana-trench/Heuristics.h>
+#include <mariana-trench/Interprocedural.h>
+#include <mariana-trench/JsonValidation.h>
+#include <mariana-trench/Log.h>
+#include <mariana-trench/Options.h>
+#include <mariana-trench/ReplaySnapshot.h>
+
+namespace marianatrench {
+
+namespace {
+
+void add_callees(
+    std::unordered_set<const Method*>& callees,
+    const CallTarget& call_target) {
+  if (call_target.resolved()) {
+    callees.insert(call_target.resolved_base_callee());
+  }
+  if (call_target.is_virtual()) {
+    for (const auto* override : call_target.overrides()) {
+      callees.insert(override);
+    }
+  }
+}
+
+/* Issues cannot be parsed back and are not an input of the analysis. */
+Json::Value model_to_json(const Model& model) {
+  auto value = model.to_json();
+  value.removeMember("issues");
+  return value;
+}
+
+} // namespace
+
+bool ReplaySnapshot::should_capture(
+    const Context& context,
+    const Method* method,
+    double duration_in_seconds) {
+  const auto& options = *context.options;
+  if (options.replay_snapshot_path()) {
+    // We are already replaying.
+    return false;
+  }
+  if (options.replay_snapshot_slow_methods() &&
+      duration_in_seconds > Heuristics::kSlowMethodAnalysisTime) {
+    return true;
+  }
+
+  const auto& patterns = options.replay_snapshot_methods();
+  if (patterns.empty()) {
+    return false;
+  }
+  const auto& method_name = method->show();
+  return std::any_of(
+      patterns.begin(), patterns.end(), [&](const auto& pattern) {
+        return method_name.find(pattern) != std::string::npos;
+      });
+}
+
+Json::Value ReplaySnapshot::capture(
+    Context& context,
+    const Registry& registry,
+    const Model& model) {
+  const auto* method = model.method();
+  mt_assert(method != nullptr);
+
+  std::unordered_set<const Method*> callees;
+  for (const auto& call_target : context.call_graph->callees(method)) {
+    add_callees(callees, call_target);
+  }
+  for (const auto& [instruction, artificial_callees] :
+       context.call_graph->artificial_callees(method)) {
+    for (const auto& artificial_callee : artificial_callees) {
+      add_callees(callees, artificial_callee.call_target);
+    }
+  }
+
+  std::unordered_set<const Field*> fields;
+  const auto* code = method->get_code();
+  if (code != nullptr && code->cfg_built()) {
+    for (const auto* block : code->cfg().blocks()) {
+      for (const auto& entry : InstructionIterable(block)) {
+        const auto* field =
+            context.call_graph->resolved_field_access(method, entry.insn);
+        if (field != nullptr) {
+          fields.insert(field);
+        }
+      }
+    }
+  }
+
+  auto callee_models = Json::Value(Json::arrayValue);
+  for (const auto* callee : callees) {
+    callee_models.append(model_to_json(registry.get(callee)));
+  }
+
+  auto field_models = Json::Value(Json::arrayValue);
+  for (const auto* field : fields) {
+    field_models.append(registry.get(field).to_json());
+  }
+
+  auto value = Json::Value(Json::objectValue);
+  value["method"] = method->to_json();
+  value["model"] = model_to_json(model);
+  value["callee_models"] = callee_models;
+  value["field_models"] = field_models;
+  return value;
+}
+
+boost::filesystem::path ReplaySnapshot::write(
+    Context& context,
+    const Method* method,
+    const Json::Value& snapshot) {
+  auto directory = context.options->replay_snapshots_output_directory();
+  boost::filesystem::create_directories(directory);
+
+  const auto& method_name = method->show();
+  auto path = directory /
+      fmt::format("{:016x}.json", std::hash<std::string>()(method_name));
+  JsonValidation::write_json_file(path, snapshot);
+  LOG(1,
+      "Wrote replay snapshot for `{}` to `{}`.",
+      method_name,
+      path.native());
+  return path;
+}
+
+Model ReplaySnapshot::replay(Context& context, const Json::Value& snapshot) {
+  JsonValidation::validate_object(snapshot);
+
+  const auto* method = Method::from_json(snapshot["method"], context);
+  mt_assert(method != nullptr);
+
+  auto registry = Registry(
+      context,
+      /* models_value */ snapshot["callee_models"],
+      /* field_models_value */ snapshot["field_models"]);
+  // `Registry::get` throws for methods without a model, use default models
+  // for anything that is not in the snapshot.
+  registry.add_default_models();
+
+  // Class properties read the dependencies, which depend on the models.
+  context.class_properties = nullptr;
+  context.dependencies = std::make_unique<Dependencies>(
+      *context.options,
+      *context.methods,
+      *context.overrides,
+      *context.call_graph,
+      registry);
+  context.class_properties = std::make_unique<ClassProperties>(
+      *context.options,
+      context.stores,
+      *context.features,
+      *context.dependencies);
+
+  auto model = Model::from_json(method, snapshot["model"], context);
+  return Interprocedural::analyze(context, registry, model);
+}
+
+void ReplaySnapshots::record(
+    Context& context,
+    const Registry& registry,
+    const Model& model,
+    double duration_in_seconds) {
+  const auto* method = model.method();
+  if (method == nullptr ||
+      !ReplaySnapshot::should_capture(context, method, duration_in_seconds)) {
+    return;
+  }
+
+  bool slowest = false;
+  captures_.update(
+      method,
+      [&](const Method* /* method */, Capture& capture, bool exists) {
+        if (!exists || duration_in_seconds > capture.duration_in_seconds) {
+          capture.duration_in_seconds = duration_in_seconds;
+          slowest = true;
+        }
+      });
+  if (!slowest) {
+    return;
+  }
+
+  // Callee models change between iterations, hence they are captured now.
+  auto snapshot = ReplaySnapshot::capture(context, registry, model);
+  captures_.update(
+      method,
+      [&](const Method* /* method */, Capture& capture, bool /* exists */) {
+        capture.snapshot = std::move(snapshot);
+      });
+}
+
+void ReplaySnapshots::write(Context& context) const {
+  for (const auto& [method, capture] : captures_) {
+    ReplaySnapshot::write(context, method, capture.snapshot);
+  }
+}
+
+} // namespace marianatrench
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <boost/filesystem/path.hpp>
+#include <json/json.h>
+
+#include <ConcurrentContainers.h>
+
+#include <mariana-trench/Context.h>
+#include <mariana-trench/Method.h>
+#include <mariana-trench/Model.h>
+#include <mariana-trench/Registry.h>
+
+namespace marianatrench {
+
+/**
+ * Snapshot of the inputs of the analysis of a single method, used to replay
+ * that analysis in isolation (e.g, to profile or debug a slow method).
+ *
+ * A snapshot contains the model of the method before the analysis and the
+ * models of all the methods it calls (including overrides and artificial
+ * callees) and of the fields it accesses. The code of the method itself is
+ * not part of the snapshot: it is loaded from the same APK when replaying.
+ */
+class ReplaySnapshot final {
+ public:
+  /**
+   * Return whether the inputs of the analysis of the given method should be
+   * saved, given how long the analysis took.
+   */
+  static bool should_capture(
+      const Context& context,
+      const Method* method,
+      double duration_in_seconds);
+
+  /* Capture the inputs of the analysis of the method of `model`. */
+  static Json::Value capture(
+      Context& context,
+      const Registry& registry,
+      const Model& model);
+
+  /* Write the given snapshot in the replay output directory. */
+  static boost::filesystem::path write(
+      Context& context,
+      const Method* method,
+      const Json::Value& snapshot);
+
+  /**
+   * Re-run the analysis of the method saved in the given snapshot.
+   *
+   * This only needs the preprocessed program and the rules: the dependencies
+   * and class properties of the context are rebuilt from the models in the
+   * snapshot, and no other model is generated.
+   */
+  static Model replay(Context& context, const Json::Value& snapshot);
+};
+
+/**
+ * Snapshots captured during the global fixpoint. A method can be analyzed
+ * many times, only the inputs of its slowest analysis are kept, and they are
+ * written once the fixpoint is reached.
+ */
+class ReplaySnapshots final {
+ private:
+  struct Capture {
+    double duration_in_seconds = 0.0;
+    Json::Value snapshot;
+  };
+
+ public:
+  ReplaySnapshots() = default;
+
+  ReplaySnapshots(const ReplaySnapshots&) = delete;
+  ReplaySnapshots(ReplaySnapshots&&) = delete;
+  ReplaySnapshots& operator=(const ReplaySnapshots&) = delete;
+  ReplaySnapshots& operator=(ReplaySnapshots&&) = delete;
+  ~ReplaySnapshots() = default;
+
+  /**
+   * Capture the inputs of the analysis of the method of `model` if it should
+   * be captured and it is its slowest analysis so far. This is thread-safe, as
+   * long as a method is not analyzed by several threads at once.
+   */
+  void record(
+      Context& context,
+      const Registry& registry,
+      const Model& model,
+      double duration_in_seconds);
+
+  /* Write all kept snapshots in the replay output directory. */
+  void write(Context& context) const;
+
+ private:
+  ConcurrentMap<const Method*, Capture> captures_;
+};
+
+} // namespace marianatrench
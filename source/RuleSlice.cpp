@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <atomic>
+#include <vector>
+
+#include <ConcurrentContainers.h>
+#include <ControlFlow.h>
+#include <IRCode.h>
+#include <SpartaWorkQueue.h>
+
+#include <mariana-trench/CallGraph.h>
+#include <mariana-trench/Dependencies.h>
+#include <mariana-trench/Methods.h>
+#include <mariana-trench/RuleSlice.h>
+
+namespace marianatrench {
+
+namespace {
+
+bool has_taint(const Model& model) {
+  return !model.generations().is_bottom() ||
+      !model.parameter_sources().is_bottom() || !model.sinks().is_bottom();
+}
+
+bool accesses_tainted_field(
+    const Context& context,
+    const Registry& registry,
+    const Method* method) {
+  const auto* code = method->get_code();
+  if (code == nullptr || !code->cfg_built()) {
+    return false;
+  }
+
+  for (const auto* block : code->cfg().blocks()) {
+    for (const auto& entry : InstructionIterable(block)) {
+      const auto* field =
+          context.call_graph->resolved_field_access(method, entry.insn);
+      if (field != nullptr && !registry.get(field).empty()) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+std::unordered_set<const Method*> RuleSlice::slice(
+    const Context& context,
+    const Registry& registry) {
+  ConcurrentSet<const Method*> seeds;
+  auto queue = sparta::work_queue<const Method*>(
+      [&](const Method* method) {
+        if (has_taint(registry.get(method)) ||
+            accesses_tainted_field(context, registry, method)) {
+          seeds.insert(method);
+        }
+      },
+      sparta::parallel::default_num_threads());
+  for (const auto* method : *context.methods) {
+    queue.add_item(method);
+  }
+  queue.run_all();
+
+  // Taint can only reach an issue through the callers of the seeds.
+  std::unordered_set<const Method*> slice;
+  std::vector<const Method*> worklist;
+  for (const auto* method : seeds) {
+    if (slice.insert(method).second) {
+      worklist.push_back(method);
+    }
+  }
+  while (!worklist.empty()) {
+    const auto* method = worklist.back();
+    worklist.pop_back();
+    for (const auto* caller : context.dependencies->dependencies(method)) {
+      if (slice.insert(caller).second) {
+        worklist.push_back(caller);
+      }
+    }
+  }
+
+  return slice;
+}
+
+std::size_t RuleSlice::apply(Context& context, Registry& registry) {
+  auto slice = RuleSlice::slice(context, registry);
+
+  std::atomic<std::size_t> pruned = 0;
+  auto queue = sparta::work_queue<const Method*>(
+      [&](const Method* method) {
+        if (method->get_code() == nullptr || slice.count(method) != 0) {
+          return;
+        }
+        registry.update(method, [&](Model& model) {
+          if (model.skip_analysis()) {
+            return false;
+          }
+          model.add_mode(Model::Mode::SkipAnalysis, context);
+          model.add_mode(Model::Mode::TaintInTaintOut, context);
+          model.add_mode(Model::Mode::TaintInTaintThis, context);
+          pruned++;
+          return true;
+        });
+      },
+      sparta::parallel::default_num_threads());
+  for (const auto* method : *context.methods) {
+    queue.add_item(method);
+  }
+  queue.run_all();
+
+  return pruned;
+}
+
+} // namespace marianatrench
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <unordered_set>
+
+#include <mariana-trench/Context.h>
+#include <mariana-trench/Method.h>
+#include <mariana-trench/Registry.h>
+
+namespace marianatrench {
+
+/**
+ * Restrict the analysis to the methods that can carry taint for the selected
+ * rules (see `--rules-filter`).
+ *
+ * A method can only find an issue or infer a source or sink if it
+ * (transitively) calls a method with a source or sink, or accesses a field
+ * with a source or sink. All other methods are given a taint-in-taint-out
+ * model and are not analyzed.
+ */
+class RuleSlice {
+ public:
+  /* Return the set of methods that need to be analyzed. */
+  static std::unordered_set<const Method*> slice(
+      const Context& context,
+      const Registry& registry);
+
+  /* Skip the analysis of methods outside of the slice. Return their number. */
+  static std::size_t apply(Context& context, Registry& registry);
+};
+
+} // namespace marianatrench
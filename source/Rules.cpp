@@ -5,6 +5,8 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <unordered_set>
+
 #include <Show.h>
 
 #include <mariana-trench/JsonValidation.h>
@@ -34,10 +36,28 @@ Rules::Rules(Context& context, const Json::Value& rules_value) {
 Rules Rules::load(Context& context, const Options& options) {
   Rules rules;
 
+  const auto& rules_filter = options.rules_filter();
+  std::unordered_set<int> selected_codes;
+  if (rules_filter) {
+    selected_codes.insert(rules_filter->begin(), rules_filter->end());
+  }
+
   for (const auto& rules_path : options.rules_paths()) {
     auto rules_value = JsonValidation::parse_json_file(rules_path);
     for (const auto& rule_value : JsonValidation::null_or_array(rules_value)) {
-      rules.add(context, Rule::from_json(rule_value, context));
+      auto rule = Rule::from_json(rule_value, context);
+      if (rules_filter && selected_codes.count(rule->code()) == 0) {
+        continue;
+      }
+      rules.add(context, std::move(rule));
+    }
+  }
+
+  if (rules_filter) {
+    for (int code : selected_codes) {
+      if (rules.rules_.count(code) == 0) {
+        WARNING(1, "Rule code {} in `--rules-filter` does not exist.", code);
+      }
     }
   }
 
@@ -61,6 +81,12 @@ void Rules::add(Context& context, std::unique_ptr<Rule> rule) {
   const Rule* rule_pointer = result.first->second.get();
 
   if (auto* source_sink_rule = rule_pointer->as<SourceSinkRule>()) {
+    used_kinds_.insert(
+        source_sink_rule->source_kinds().begin(),
+        source_sink_rule->source_kinds().end());
+    used_kinds_.insert(
+        source_sink_rule->sink_kinds().begin(),
+        source_sink_rule->sink_kinds().end());
     for (const auto* source_kind : source_sink_rule->source_kinds()) {
       for (const auto* sink_kind : source_sink_rule->sink_kinds()) {
         source_to_sink_to_rules_[source_kind][sink_kind].push_back(
@@ -96,15 +122,50 @@ void Rules::add(Context& context, std::unique_ptr<Rule> rule) {
     // With the rule, it is clear that only the first rule applies:
     //   SourceB -> Triggered(SinkX, lblB, rule: 1000)
 
+    used_kinds_.insert(
+        multi_source_rule->partial_sink_kinds().begin(),
+        multi_source_rule->partial_sink_kinds().end());
+
+    // Precompute the triggered kinds and counterparts, so that the analysis
+    // does not need to go through the `Kinds` factory.
+    std::unordered_map<const PartialKind*, PartialKindRule*>
+        rule_partial_kinds;
+    for (const auto* sink_kind : multi_source_rule->partial_sink_kinds()) {
+      auto id = partial_kind_rules_.size();
+      partial_kind_rules_.push_back(
+          std::make_unique<PartialKindRule>(PartialKindRule{
+              /* id */ id,
+              /* counterpart_id */ id,
+              /* kind */ sink_kind,
+              /* rule */ multi_source_rule,
+              /* triggered_kind */
+              context.kinds->get_triggered(sink_kind, multi_source_rule)}));
+      auto* partial_kind_rule = partial_kind_rules_.back().get();
+      rule_partial_kinds.emplace(sink_kind, partial_kind_rule);
+      partial_kind_to_rules_[sink_kind].push_back(partial_kind_rule);
+      triggered_kind_to_rule_.emplace(
+          partial_kind_rule->triggered_kind, partial_kind_rule);
+    }
+    for (auto& [sink_kind, partial_kind_rule] : rule_partial_kinds) {
+      for (const auto& [other_sink_kind, other_partial_kind_rule] :
+           rule_partial_kinds) {
+        if (sink_kind->is_counterpart(other_sink_kind)) {
+          partial_kind_rule->counterpart_id = other_partial_kind_rule->id;
+        }
+      }
+      mt_assert(partial_kind_rule->counterpart_id != partial_kind_rule->id);
+    }
+
     for (const auto& [source_label, source_kinds] :
          multi_source_rule->multi_source_kinds()) {
+      used_kinds_.insert(source_kinds.begin(), source_kinds.end());
       for (const auto* source_kind : source_kinds) {
         for (const auto* sink_kind :
              multi_source_rule->partial_sink_kinds(source_label)) {
-          const auto* triggered =
-              context.kinds->get_triggered(sink_kind, multi_source_rule);
-          source_to_partial_sink_to_rules_[source_kind][sink_kind].push_back(
-              multi_source_rule);
+          const auto* partial_kind_rule = rule_partial_kinds.at(sink_kind);
+          const auto* triggered = partial_kind_rule->triggered_kind;
+          auto key = std::make_pair(source_kind, sink_kind);
+          source_to_partial_sink_to_rules_[key].push_back(partial_kind_rule);
           source_to_sink_to_rules_[source_kind][triggered].push_back(
               multi_source_rule);
         }
@@ -132,22 +193,42 @@ const std::vector<const Rule*>& Rules::rules(
   return rules->second;
 }
 
-const std::vector<const MultiSourceMultiSinkRule*>& Rules::partial_rules(
+const std::vector<const Rules::PartialKindRule*>& Rules::partial_rules(
     const Kind* source_kind,
     const PartialKind* sink_kind) const {
-  auto sink_to_rules = source_to_partial_sink_to_rules_.find(source_kind);
-  if (sink_to_rules == source_to_partial_sink_to_rules_.end()) {
-    return empty_multi_source_rule_set_;
+  auto rules = source_to_partial_sink_to_rules_.find(
+      std::make_pair(source_kind, sink_kind));
+  if (rules == source_to_partial_sink_to_rules_.end()) {
+    return empty_partial_kind_rule_set_;
   }
 
-  auto rules = sink_to_rules->second.find(sink_kind);
-  if (rules == sink_to_rules->second.end()) {
-    return empty_multi_source_rule_set_;
+  return rules->second;
+}
+
+const std::vector<const Rules::PartialKindRule*>& Rules::partial_kind_rules(
+    const PartialKind* kind) const {
+  auto rules = partial_kind_to_rules_.find(kind);
+  if (rules == partial_kind_to_rules_.end()) {
+    return empty_partial_kind_rule_set_;
   }
 
   return rules->second;
 }
 
+const Rules::PartialKindRule* MT_NULLABLE
+Rules::partial_kind_rule(const TriggeredPartialKind* kind) const {
+  auto rule = triggered_kind_to_rule_.find(kind);
+  if (rule == triggered_kind_to_rule_.end()) {
+    return nullptr;
+  }
+
+  return rule->second;
+}
+
+bool Rules::uses(const Kind* kind) const {
+  return used_kinds_.count(kind) != 0;
+}
+
 std::unordered_set<const Kind*> Rules::collect_unused_kinds(
     const Kinds& kinds) const {
   std::unordered_set<const Kind*> unused_kinds;
@@ -156,9 +237,7 @@ std::unordered_set<const Kind*> Rules::collect_unused_kinds(
       // Triggered kinds are never used in rules. No need to warn.
       continue;
     }
-    if (std::all_of(begin(), end(), [kind](const Rule* rule) {
-          return !rule->uses(kind);
-        })) {
+    if (!uses(kind)) {
       unused_kinds.insert(kind);
       WARNING(
           1,
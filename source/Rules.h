@@ -9,16 +9,20 @@
 
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include <boost/functional/hash.hpp>
 #include <boost/iterator/transform_iterator.hpp>
 #include <json/json.h>
 
 #include <mariana-trench/Context.h>
 #include <mariana-trench/Kind.h>
+#include <mariana-trench/Compiler.h>
 #include <mariana-trench/MultiSourceMultiSinkRule.h>
 #include <mariana-trench/PartialKind.h>
 #include <mariana-trench/Rule.h>
+#include <mariana-trench/TriggeredPartialKind.h>
 
 namespace marianatrench {
 
@@ -50,14 +54,47 @@ class Rules final {
       std::is_same_v<typename iterator::difference_type, difference_type>);
   static_assert(std::is_same_v<typename iterator::reference, const_reference>);
 
+  struct PairHash {
+    std::size_t operator()(
+        const std::pair<const Kind*, const PartialKind*>& pair) const {
+      std::size_t seed = 0;
+      boost::hash_combine(seed, pair.first);
+      boost::hash_combine(seed, pair.second);
+      return seed;
+    }
+  };
+
  public:
+  /**
+   * A partial sink kind of a multi-source/sink rule.
+   *
+   * Each pair (partial kind, rule) gets a dense identifier, so that the
+   * analysis can track fulfilled partial kinds at a call site with a flat
+   * array (see `FulfilledPartialKindState`). The counterpart and triggered
+   * kind are precomputed when the rule is added.
+   */
+  struct PartialKindRule {
+    std::size_t id;
+    /* Identifier of the counterpart partial kind under the same rule. */
+    std::size_t counterpart_id;
+    const PartialKind* kind;
+    const MultiSourceMultiSinkRule* rule;
+    /* The triggered kind created when the counterpart is fulfilled. */
+    const TriggeredPartialKind* triggered_kind;
+  };
+
   explicit Rules();
 
   explicit Rules(Context& context, std::vector<std::unique_ptr<Rule>> rules);
 
   explicit Rules(Context& context, const Json::Value& rules_value);
 
-  /* Load the rules from the json file specified in the given options. */
+  /**
+   * Load the rules from the json file specified in the given options.
+   *
+   * When `--rules-filter` is specified, only the rules with the given codes are
+   * loaded.
+   */
   static Rules load(Context& context, const Options& options);
 
   Rules(const Rules&) = delete;
@@ -84,10 +121,30 @@ class Rules final {
    * other sink in the rule still needs to be met with its corresponding source
    * for an issue to be created (also the responsibility of the caller).
    */
-  const std::vector<const MultiSourceMultiSinkRule*>& partial_rules(
+  const std::vector<const PartialKindRule*>& partial_rules(
       const Kind* source_kind,
       const PartialKind* sink_kind) const;
 
+  /* Return all multi-source/sink rules using the given partial kind. */
+  const std::vector<const PartialKindRule*>& partial_kind_rules(
+      const PartialKind* kind) const;
+
+  /* Return the partial kind and rule of the given triggered kind. */
+  const PartialKindRule* MT_NULLABLE
+  partial_kind_rule(const TriggeredPartialKind* kind) const;
+
+  const PartialKindRule& partial_kind_rule(std::size_t id) const {
+    return *partial_kind_rules_[id];
+  }
+
+  /* Number of pairs (partial kind, rule), i.e one plus the maximum id. */
+  std::size_t number_partial_kind_rules() const {
+    return partial_kind_rules_.size();
+  }
+
+  /* Return true if the given kind is used by any rule. */
+  bool uses(const Kind* kind) const;
+
   std::unordered_set<const Kind*> collect_unused_kinds(
       const Kinds& kinds) const;
 
@@ -109,14 +166,19 @@ class Rules final {
       const Kind*,
       std::unordered_map<const Kind*, std::vector<const Rule*>>>
       source_to_sink_to_rules_;
+  std::vector<std::unique_ptr<PartialKindRule>> partial_kind_rules_;
   std::unordered_map<
-      const Kind*,
-      std::unordered_map<
-          const PartialKind*,
-          std::vector<const MultiSourceMultiSinkRule*>>>
+      std::pair<const Kind*, const PartialKind*>,
+      std::vector<const PartialKindRule*>,
+      PairHash>
       source_to_partial_sink_to_rules_;
+  std::unordered_map<const PartialKind*, std::vector<const PartialKindRule*>>
+      partial_kind_to_rules_;
+  std::unordered_map<const TriggeredPartialKind*, const PartialKindRule*>
+      triggered_kind_to_rule_;
+  std::unordered_set<const Kind*> used_kinds_;
   std::vector<const Rule*> empty_rule_set_;
-  std::vector<const MultiSourceMultiSinkRule*> empty_multi_source_rule_set_;
+  std::vector<const PartialKindRule*> empty_partial_kind_rule_set_;
 };
 
 } // namespace marianatrench
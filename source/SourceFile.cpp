@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cstring>
+
+#include <boost/filesystem.hpp>
+
+#include <mariana-trench/Assert.h>
+#include <mariana-trench/Log.h>
+#include <mariana-trench/SourceFile.h>
+
+namespace marianatrench {
+
+SourceFile::SourceFile(std::string content) : buffer_(std::move(content)) {
+  content_ = buffer_;
+  index_lines();
+}
+
+std::unique_ptr<SourceFile> MT_NULLABLE
+SourceFile::open(const std::string& path) {
+  boost::system::error_code error;
+  if (!boost::filesystem::is_regular_file(path, error)) {
+    return nullptr;
+  }
+  auto size = boost::filesystem::file_size(path, error);
+  if (error) {
+    return nullptr;
+  }
+
+  // Use `new` since the default constructor is private.
+  auto file = std::unique_ptr<SourceFile>(new SourceFile());
+  if (size == 0) {
+    // Empty files cannot be mapped.
+    return file;
+  }
+
+  try {
+    file->mapping_.open(path);
+  } catch (const std::exception& exception) {
+    WARNING(1, "Unable to map file `{}`: {}", path, exception.what());
+    return nullptr;
+  }
+  if (!file->mapping_.is_open()) {
+    return nullptr;
+  }
+
+  file->content_ =
+      std::string_view(file->mapping_.data(), file->mapping_.size());
+  file->index_lines();
+  return file;
+}
+
+std::string_view SourceFile::line(std::size_t index) const {
+  mt_assert(has_line_number(index));
+
+  auto start = line_offsets_[index - 1];
+  auto end = index < line_offsets_.size() ? line_offsets_[index] - 1
+                                          : content_.size();
+  if (end > start && content_[end - 1] == '\n') {
+    // Only the last line can end with a newline here.
+    end--;
+  }
+  return content_.substr(start, end - start);
+}
+
+void SourceFile::index_lines() {
+  const char* begin = content_.data();
+  const char* end = begin + content_.size();
+  const char* current = begin;
+
+  while (current < end) {
+    line_offsets_.push_back(current - begin);
+    const auto* newline = static_cast<const char*>(
+        std::memchr(current, '\n', static_cast<std::size_t>(end - current)));
+    if (newline == nullptr) {
+      break;
+    }
+    current = newline + 1;
+  }
+}
+
+} // namespace marianatrench
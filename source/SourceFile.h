@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <mariana-trench/Compiler.h>
+
+namespace marianatrench {
+
+/**
+ * Read-only view of a source file, split into lines.
+ *
+ * Files are memory mapped and only an array of line offsets is computed, so
+ * lines are returned as views into the mapping without any copy. Lines are
+ * 1-indexed and follow the semantics of `std::getline`: a trailing newline
+ * does not start a new line.
+ */
+class SourceFile final {
+ public:
+  /* Create a source file from the given content, mostly used for testing. */
+  explicit SourceFile(std::string content);
+
+  SourceFile(const SourceFile&) = delete;
+  SourceFile(SourceFile&&) = delete;
+  SourceFile& operator=(const SourceFile&) = delete;
+  SourceFile& operator=(SourceFile&&) = delete;
+  ~SourceFile() = default;
+
+  /**
+   * Map the file at the given path in memory.
+   *
+   * Returns `nullptr` if the file does not exist or cannot be mapped.
+   */
+  static std::unique_ptr<SourceFile> MT_NULLABLE
+  open(const std::string& path);
+
+  std::string_view content() const {
+    return content_;
+  }
+
+  bool has_line_number(std::size_t index) const {
+    return index >= 1 && index <= line_offsets_.size();
+  }
+
+  std::string_view line(std::size_t index) const;
+
+  /* Number of lines in the file. */
+  std::size_t size() const {
+    return line_offsets_.size();
+  }
+
+ private:
+  SourceFile() = default;
+
+  void index_lines();
+
+ private:
+  boost::iostreams::mapped_file_source mapping_;
+  std::string buffer_;
+  std::string_view content_;
+  std::vector<std::size_t> line_offsets_;
+};
+
+} // namespace marianatrench
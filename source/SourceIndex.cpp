@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <fmt/format.h>
+
+#include <mariana-trench/JsonValidation.h>
+#include <mariana-trench/Log.h>
+#include <mariana-trench/SourceIndex.h>
+
+namespace marianatrench {
+
+namespace {
+
+// Bump this when the content of entries changes.
+constexpr int k_version = 1;
+
+std::string hash_to_string(std::uint64_t hash) {
+  return fmt::format("{:016x}", hash);
+}
+
+std::uint64_t hash_from_string(const std::string& string) {
+  return std::stoull(string, /* pos */ nullptr, /* base */ 16);
+}
+
+} // namespace
+
+SourceIndex::SourceIndex(std::string source_root_directory)
+    : source_root_directory_(std::move(source_root_directory)),
+      hits_(0),
+      misses_(0) {}
+
+void SourceIndex::load(const boost::filesystem::path& path) {
+  if (!boost::filesystem::exists(path)) {
+    LOG(1, "No source index found at `{}`.", path.string());
+    return;
+  }
+
+  try {
+    auto value = JsonValidation::parse_json_file(path);
+    JsonValidation::validate_object(value);
+    if (JsonValidation::integer(value, "version") != k_version ||
+        JsonValidation::string(value, "source_root_directory") !=
+            source_root_directory_) {
+      LOG(1, "Ignoring outdated source index at `{}`.", path.string());
+      return;
+    }
+
+    const auto& files = JsonValidation::object(value, "files");
+    for (auto iterator = files.begin(); iterator != files.end(); ++iterator) {
+      const auto& file = *iterator;
+      JsonValidation::validate_object(file);
+      Entry entry{
+          /* modification_time */ file["modification_time"].asInt64(),
+          /* size */ file["size"].asUInt64(),
+          /* hash */ hash_from_string(JsonValidation::string(file, "hash")),
+          /* classes */ {}};
+      for (const auto& class_name :
+           JsonValidation::null_or_array(file, "classes")) {
+        entry.classes.push_back(JsonValidation::string(class_name));
+      }
+      loaded_.emplace(iterator.name(), std::move(entry));
+    }
+  } catch (const std::exception& exception) {
+    WARNING(
+        1,
+        "Unable to load source index at `{}`: {}",
+        path.string(),
+        exception.what());
+    loaded_.clear();
+    return;
+  }
+
+  LOG(1,
+      "Loaded {} files from source index `{}`.",
+      loaded_.size(),
+      path.string());
+}
+
+void SourceIndex::save(const boost::filesystem::path& path) const {
+  auto files = Json::Value(Json::objectValue);
+  for (const auto& [file_path, entry] : entries_) {
+    auto file = Json::Value(Json::objectValue);
+    file["modification_time"] =
+        Json::Value(Json::Int64(entry.modification_time));
+    file["size"] = Json::Value(Json::UInt64(entry.size));
+    file["hash"] = Json::Value(hash_to_string(entry.hash));
+    auto classes = Json::Value(Json::arrayValue);
+    for (const auto& class_name : entry.classes) {
+      classes.append(Json::Value(class_name));
+    }
+    file["classes"] = std::move(classes);
+    files[file_path] = std::move(file);
+  }
+
+  auto value = Json::Value(Json::objectValue);
+  value["version"] = Json::Value(k_version);
+  value["source_root_directory"] = Json::Value(source_root_directory_);
+  value["files"] = std::move(files);
+
+  auto temporary_path = path;
+  temporary_path += boost::filesystem::unique_path(".%%%%-%%%%-%%%%.tmp");
+  try {
+    JsonValidation::write_json_file(temporary_path, value);
+    boost::filesystem::rename(temporary_path, path);
+  } catch (const std::exception& exception) {
+    WARNING(
+        1,
+        "Unable to write source index at `{}`: {}",
+        path.string(),
+        exception.what());
+    boost::system::error_code error;
+    boost::filesystem::remove(temporary_path, error);
+    return;
+  }
+
+  LOG(1,
+      "Wrote {} files to source index `{}`.",
+      entries_.size(),
+      path.string());
+}
+
+std::vector<std::string> SourceIndex::classes(
+    const std::string& path,
+    const Scanner& scanner) {
+  boost::system::error_code error;
+  auto modification_time = boost::filesystem::last_write_time(path, error);
+  if (error) {
+    return {};
+  }
+  auto size = boost::filesystem::file_size(path, error);
+  if (error) {
+    return {};
+  }
+
+  auto loaded = loaded_.find(path);
+  if (loaded != loaded_.end() &&
+      loaded->second.modification_time == modification_time &&
+      loaded->second.size == size) {
+    hits_++;
+    entries_.insert_or_assign(std::make_pair(path, loaded->second));
+    return loaded->second.classes;
+  }
+
+  auto file = SourceFile::open(path);
+  if (file == nullptr) {
+    return {};
+  }
+
+  auto entry = Entry{
+      /* modification_time */ modification_time,
+      /* size */ size,
+      /* hash */ hash(file->content()),
+      /* classes */ {}};
+  if (loaded != loaded_.end() && loaded->second.size == entry.size &&
+      loaded->second.hash == entry.hash) {
+    hits_++;
+    entry.classes = loaded->second.classes;
+  } else {
+    misses_++;
+    entry.classes = scanner(*file);
+  }
+
+  auto classes = entry.classes;
+  entries_.insert_or_assign(std::make_pair(path, std::move(entry)));
+  return classes;
+}
+
+std::uint64_t SourceIndex::hash(std::string_view content, std::uint64_t hash) {
+  // 64-bit FNV-1a, which is stable across builds and platforms.
+  for (unsigned char character : content) {
+    hash ^= character;
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+} // namespace marianatrench
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <json/json.h>
+
+#include <ConcurrentContainers.h>
+
+#include <mariana-trench/SourceFile.h>
+
+namespace marianatrench {
+
+/**
+ * Index of the top-level classes defined in each source file.
+ *
+ * The index can be persisted on disk and reloaded in a later run, in which
+ * case only files that were added or changed since are scanned again. A file
+ * is considered unchanged if its modification time and size did not change,
+ * or if its content hash did not change.
+ */
+class SourceIndex final {
+ public:
+  struct Entry {
+    std::int64_t modification_time;
+    std::uint64_t size;
+    std::uint64_t hash;
+    std::vector<std::string> classes;
+  };
+
+  using Scanner =
+      std::function<std::vector<std::string>(const SourceFile& file)>;
+
+  /* Create an empty index for the given source root directory. */
+  explicit SourceIndex(std::string source_root_directory);
+
+  SourceIndex(const SourceIndex&) = delete;
+  SourceIndex(SourceIndex&&) = delete;
+  SourceIndex& operator=(const SourceIndex&) = delete;
+  SourceIndex& operator=(SourceIndex&&) = delete;
+  ~SourceIndex() = default;
+
+  /**
+   * Load a previous index from the given path.
+   *
+   * The index is ignored if it does not exist, cannot be parsed or was built
+   * for a different source root directory.
+   */
+  void load(const boost::filesystem::path& path);
+
+  /**
+   * Atomically write the entries looked up during this run at the given path.
+   *
+   * The index is written to a temporary file which is then renamed, so that
+   * concurrent runs sharing the same index never observe a partial file.
+   */
+  void save(const boost::filesystem::path& path) const;
+
+  /**
+   * Return the classes defined in the file at the given path, relative to the
+   * current directory. The file is only scanned with `scanner` if it is not
+   * in the loaded index or if it changed since.
+   *
+   * This is thread-safe.
+   */
+  std::vector<std::string> classes(
+      const std::string& path,
+      const Scanner& scanner);
+
+  /* Number of files for which the loaded index could be reused. */
+  std::size_t hits() const {
+    return hits_.load();
+  }
+
+  /* Number of files that had to be scanned. */
+  std::size_t misses() const {
+    return misses_.load();
+  }
+
+  static constexpr std::uint64_t k_initial_hash = 0xcbf29ce484222325ULL;
+
+  /**
+   * Stable hash of the content. Large contents can be hashed in chunks by
+   * passing the hash of the previous chunks.
+   */
+  static std::uint64_t hash(
+      std::string_view content,
+      std::uint64_t hash = k_initial_hash);
+
+ private:
+  std::string source_root_directory_;
+  std::unordered_map<std::string, Entry> loaded_;
+  ConcurrentMap<std::string, Entry> entries_;
+  std::atomic<std::size_t> hits_;
+  std::atomic<std::size_t> misses_;
+};
+
+} // namespace marianatrench
@@ -0,0 +1,349 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#include <mariana-trench/SourceScanner.h>
+
+namespace marianatrench {
+
+namespace {
+
+// Characters matched by `\s` in re2.
+bool is_space(char character) {
+  return character == ' ' || character == '\t' || character == '\n' ||
+      character == '\f' || character == '\r';
+}
+
+// Characters matched by `[A-z0-9]`.
+bool is_class_name_character(char character) {
+  return (character >= 'A' && character <= 'z') ||
+      (character >= '0' && character <= '9');
+}
+
+// First characters of the keywords that can start a declaration.
+bool is_declaration_start(char character) {
+  switch (character) {
+    case 'a':
+    case 'c':
+    case 'd':
+    case 'e':
+    case 'f':
+    case 'i':
+    case 'o':
+    case 'p':
+      return true;
+    default:
+      return false;
+  }
+}
+
+std::size_t skip_spaces(std::string_view line, std::size_t position) {
+  while (position < line.size() && is_space(line[position])) {
+    position++;
+  }
+  return position;
+}
+
+template <std::size_t Size>
+std::size_t skip_keyword(
+    std::string_view line,
+    std::size_t position,
+    const std::array<std::string_view, Size>& keywords) {
+  for (auto keyword : keywords) {
+    if (line.substr(position, keyword.size()) == keyword) {
+      return position + keyword.size();
+    }
+  }
+  return position;
+}
+
+constexpr std::array<std::string_view, 3> k_visibilities = {
+    "public",
+    "internal",
+    "private",
+};
+
+constexpr std::array<std::string_view, 4> k_modifiers = {
+    "abstract",
+    "data",
+    "final",
+    "open",
+};
+
+constexpr std::array<std::string_view, 4> k_declarations = {
+    "class",
+    "enum",
+    "interface",
+    "object",
+};
+
+/**
+ * Match the part of the class pattern following the leading comment, i.e
+ * `\s*(?:public|...)?\s*(?:abstract|...)?\s*(?:class|...)\s+([A-z0-9]+)`.
+ *
+ * Optional keywords are never a prefix of the keywords that can follow them,
+ * hence matching them greedily is equivalent to backtracking.
+ */
+std::optional<std::string_view> match_declaration(
+    std::string_view line,
+    std::size_t position) {
+  position = skip_spaces(line, position);
+  // Most lines are rejected here.
+  if (position >= line.size() || !is_declaration_start(line[position])) {
+    return std::nullopt;
+  }
+  position = skip_keyword(line, position, k_visibilities);
+  position = skip_spaces(line, position);
+  position = skip_keyword(line, position, k_modifiers);
+  position = skip_spaces(line, position);
+
+  auto declaration_end = skip_keyword(line, position, k_declarations);
+  if (declaration_end == position) {
+    return std::nullopt;
+  }
+
+  position = skip_spaces(line, declaration_end);
+  if (position == declaration_end) {
+    return std::nullopt;
+  }
+
+  auto start = position;
+  while (position < line.size() && is_class_name_character(line[position])) {
+    position++;
+  }
+  if (position == start) {
+    return std::nullopt;
+  }
+  return line.substr(start, position - start);
+}
+
+enum class LexicalState {
+  Code,
+  BlockComment,
+  String,
+  Character,
+  TextBlock,
+};
+
+constexpr std::uint64_t k_low_bits = 0x0101010101010101;
+constexpr std::uint64_t k_high_bits = 0x8080808080808080;
+
+/* Return a non-zero value if one of the bytes of `word` is `byte`. */
+constexpr std::uint64_t has_byte(std::uint64_t word, char byte) {
+  auto bytes = word ^ (k_low_bits * static_cast<unsigned char>(byte));
+  return (bytes - k_low_bits) & ~bytes & k_high_bits;
+}
+
+/**
+ * Return the first of the given bytes in `[current, end)`, or `end`.
+ *
+ * This skips 8 bytes at a time as long as none of them matches, which is the
+ * common case since the bytes we look for are rare in source files.
+ */
+template <char... Bytes>
+const char* find_any(const char* current, const char* end) {
+  while (end - current >= 8) {
+    std::uint64_t word;
+    std::memcpy(&word, current, sizeof(word));
+    auto matches = (has_byte(word, Bytes) | ...);
+    if (matches != 0) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+      // The lowest match is exact, higher ones can be false positives.
+      return current + __builtin_ctzll(matches) / 8;
+#else
+      break;
+#endif
+    }
+    current += 8;
+  }
+  while (current < end && ((*current != Bytes) && ...)) {
+    current++;
+  }
+  return current;
+}
+
+const char* find_newline(const char* current, const char* end) {
+  const auto* newline = static_cast<const char*>(
+      std::memchr(current, '\n', static_cast<std::size_t>(end - current)));
+  return newline != nullptr ? newline : end;
+}
+
+bool starts_with(
+    const char* current,
+    const char* end,
+    std::string_view prefix) {
+  return static_cast<std::size_t>(end - current) >= prefix.size() &&
+      std::memcmp(current, prefix.data(), prefix.size()) == 0;
+}
+
+/**
+ * Scan the line starting at `current` and update the lexical state. Return
+ * the end of the line, i.e the newline character or `end`.
+ *
+ * String and character literals cannot span lines, they end at the end of
+ * the line if they are not terminated. Text blocks (Java) and raw strings
+ * (Kotlin) can.
+ */
+const char*
+scan_line(const char* current, const char* end, LexicalState& state) {
+  while (current < end) {
+    switch (state) {
+      case LexicalState::Code: {
+        current = find_any<'\n', '/', '"', '\''>(current, end);
+        if (current == end || *current == '\n') {
+          return current;
+        }
+        if (starts_with(current, end, "//")) {
+          return find_newline(current, end);
+        } else if (starts_with(current, end, "/*")) {
+          state = LexicalState::BlockComment;
+          current += 2;
+        } else if (starts_with(current, end, "\"\"\"")) {
+          state = LexicalState::TextBlock;
+          current += 3;
+        } else if (*current == '"') {
+          state = LexicalState::String;
+          current++;
+        } else if (*current == '\'') {
+          state = LexicalState::Character;
+          current++;
+        } else {
+          current++;
+        }
+        break;
+      }
+      case LexicalState::BlockComment: {
+        // Look for the `/` of `*/`, since most lines of documentation start
+        // with a `*`.
+        const char* body = current;
+        current = find_any<'\n', '/'>(current, end);
+        if (current == end || *current == '\n') {
+          return current;
+        }
+        if (current > body && current[-1] == '*') {
+          state = LexicalState::Code;
+        }
+        current++;
+        break;
+      }
+      case LexicalState::String:
+      case LexicalState::Character: {
+        current = state == LexicalState::String
+            ? find_any<'\n', '\\', '"'>(current, end)
+            : find_any<'\n', '\\', '\''>(current, end);
+        if (current == end || *current == '\n') {
+          state = LexicalState::Code;
+          return current;
+        }
+        if (*current == '\\') {
+          // Skip the escaped character, unless it is the end of the line.
+          current++;
+          if (current < end && *current != '\n') {
+            current++;
+          }
+        } else {
+          state = LexicalState::Code;
+          current++;
+        }
+        break;
+      }
+      case LexicalState::TextBlock: {
+        current = find_any<'\n', '"'>(current, end);
+        if (current == end || *current == '\n') {
+          return current;
+        }
+        if (starts_with(current, end, "\"\"\"")) {
+          state = LexicalState::Code;
+          current += 3;
+        } else {
+          current++;
+        }
+        break;
+      }
+    }
+  }
+  return current;
+}
+
+} // namespace
+
+std::optional<std::string_view> SourceScanner::package(std::string_view line) {
+  static constexpr std::string_view k_package = "package";
+  if (line.substr(0, k_package.size()) != k_package) {
+    return std::nullopt;
+  }
+
+  auto spaces_start = k_package.size();
+  auto spaces_end = skip_spaces(line, spaces_start);
+  if (spaces_end == spaces_start) {
+    return std::nullopt;
+  }
+
+  auto end = line.find(';', spaces_end);
+  if (end == std::string_view::npos) {
+    end = line.size();
+  }
+  if (end > spaces_end) {
+    return line.substr(spaces_end, end - spaces_end);
+  }
+
+  // `[^;]+` needs at least one character, which can be taken from the spaces
+  // when there is more than one.
+  if (spaces_end - spaces_start >= 2) {
+    return line.substr(spaces_end - 1, 1);
+  }
+  return std::nullopt;
+}
+
+std::optional<std::string_view> SourceScanner::class_name(
+    std::string_view line) {
+  auto position = skip_spaces(line, 0);
+
+  if (line.substr(position, 2) == "/*") {
+    // `/\*.*\*\/` is greedy: try the last end of comment first.
+    auto comment_start = position + 2;
+    auto comment_end = line.rfind("*/");
+    while (comment_end != std::string_view::npos &&
+           comment_end >= comment_start) {
+      if (auto match = match_declaration(line, comment_end + 2)) {
+        return match;
+      }
+      if (comment_end == 0) {
+        break;
+      }
+      comment_end = line.rfind("*/", comment_end - 1);
+    }
+  }
+
+  return match_declaration(line, position);
+}
+
+void SourceScanner::visit_code_lines(
+    std::string_view source,
+    const std::function<bool(std::string_view)>& visitor) {
+  const char* current = source.data();
+  const char* end = current + source.size();
+  auto state = LexicalState::Code;
+
+  while (current < end) {
+    const char* line_start = current;
+    bool starts_in_code = state == LexicalState::Code;
+    current = scan_line(current, end, state);
+    if (starts_in_code &&
+        !visitor(std::string_view(
+            line_start, static_cast<std::size_t>(current - line_start)))) {
+      return;
+    }
+    // Skip the newline.
+    current++;
+  }
+}
+
+} // namespace marianatrench
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <string_view>
+
+namespace marianatrench {
+
+/**
+ * Hand-written matchers for the headers of Java and Kotlin source files, used
+ * when indexing source files.
+ *
+ * These are equivalent to the following regular expressions, but avoid the
+ * cost of running a regular expression engine on every line:
+ * - package: `^package\s+([^;]+)(?:;|$)`
+ * - class: `^\s*(?:/\*.*\*\/)?\s*(?:public|internal|private)?\s*
+ *   (?:abstract|data|final|open)?\s*(?:class|enum|interface|object)\s+
+ *   ([A-z0-9]+)`
+ *
+ * Whole files are scanned in a single pass by `visit_code_lines`, which skips
+ * lines that start within a comment or a string literal.
+ */
+class SourceScanner final {
+ public:
+  /* Return the package declared on the given line, if any. */
+  static std::optional<std::string_view> package(std::string_view line);
+
+  /* Return the name of the class declared on the given line, if any. */
+  static std::optional<std::string_view> class_name(std::string_view line);
+
+  /**
+   * Call `visitor` on each line of the given source that does not start
+   * within a comment or a string literal. Stop as soon as `visitor` returns
+   * false.
+   */
+  static void visit_code_lines(
+      std::string_view source,
+      const std::function<bool(std::string_view)>& visitor);
+};
+
+} // namespace marianatrench
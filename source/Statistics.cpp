@@ -10,6 +10,7 @@
 #include <Show.h>
 #include <SpartaWorkQueue.h>
 
+#include <mariana-trench/Heuristics.h>
 #include <mariana-trench/Statistics.h>
 
 namespace marianatrench {
@@ -61,6 +62,35 @@ void Statistics::log_time(const Method* method, const Timer& timer) {
       record);
 }
 
+void Statistics::log_duplicate_methods(
+    std::size_t number_duplicate_methods,
+    std::size_t number_duplicate_analyses,
+    std::size_t number_shared_analyses) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  number_duplicate_methods_ = number_duplicate_methods;
+  number_duplicate_analyses_ = number_duplicate_analyses;
+  number_shared_analyses_ = number_shared_analyses;
+}
+
+void Statistics::log_precision_level(
+    std::size_t iteration,
+    std::size_t precision_level,
+    double resident_set_size) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  precision_degradations_.push_back(
+      PrecisionDegradation{iteration, precision_level, resident_set_size});
+}
+
+void Statistics::log_unstable_methods(
+    std::vector<const Method*> widened_methods,
+    std::vector<const Method*> obscured_methods,
+    std::vector<const Method*> stopped_methods) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  widened_methods_ = std::move(widened_methods);
+  obscured_methods_ = std::move(obscured_methods);
+  stopped_methods_ = std::move(stopped_methods);
+}
+
 namespace {
 
 double round(double x, int digits) {
@@ -77,6 +107,74 @@ Json::Value Statistics::to_json() const {
   value["rss"] = Json::Value(round(max_resident_set_size_, 6));
   value["cores"] = Json::Value(sparta::parallel::default_num_threads());
 
+  auto duplicate_methods_value = Json::Value(Json::objectValue);
+  duplicate_methods_value["methods"] =
+      Json::Value(static_cast<Json::UInt64>(number_duplicate_methods_));
+  duplicate_methods_value["candidates"] =
+      Json::Value(static_cast<Json::UInt64>(number_duplicate_analyses_));
+  duplicate_methods_value["hits"] =
+      Json::Value(static_cast<Json::UInt64>(number_shared_analyses_));
+  duplicate_methods_value["hit_rate"] = Json::Value(
+      number_duplicate_analyses_ == 0
+          ? 0.0
+          : round(
+                static_cast<double>(number_shared_analyses_) /
+                    number_duplicate_analyses_,
+                3));
+  value["duplicate_methods"] = duplicate_methods_value;
+
+  auto precision_degradations_value = Json::Value(Json::arrayValue);
+  for (const auto& degradation : precision_degradations_) {
+    const auto& limits =
+        Heuristics::kPrecisionLevels[degradation.precision_level];
+    auto degradation_value = Json::Value(Json::objectValue);
+    degradation_value["iteration"] =
+        Json::Value(static_cast<Json::UInt64>(degradation.iteration));
+    degradation_value["level"] =
+        Json::Value(static_cast<Json::UInt64>(degradation.precision_level));
+    degradation_value["rss"] =
+        Json::Value(round(degradation.resident_set_size, 6));
+    degradation_value["abstract_tree_widening_height"] = Json::Value(
+        static_cast<Json::UInt64>(limits.abstract_tree_widening_height));
+    degradation_value["model_tree_max_leaves"] =
+        Json::Value(static_cast<Json::UInt64>(limits.model_tree_max_leaves));
+    degradation_value["join_override_threshold"] =
+        limits.join_override_threshold
+        ? Json::Value(
+              static_cast<Json::UInt64>(*limits.join_override_threshold))
+        : Json::Value(Json::nullValue);
+    precision_degradations_value.append(degradation_value);
+  }
+  value["precision_degradations"] = precision_degradations_value;
+
+  // Record whether origins were collapsed, since this loses precision.
+  auto collapsed_origins_value = Json::Value(Json::objectValue);
+  auto max_number_origins = Heuristics::max_number_origins();
+  collapsed_origins_value["max_number_origins"] = max_number_origins
+      ? Json::Value(static_cast<Json::UInt64>(*max_number_origins))
+      : Json::Value(Json::nullValue);
+  collapsed_origins_value["collapsed"] = Json::Value(
+      static_cast<Json::UInt64>(Heuristics::number_collapsed_origins()));
+  value["collapsed_origins"] = collapsed_origins_value;
+
+  auto methods_to_json = [](const std::vector<const Method*>& methods) {
+    std::vector<std::string> names;
+    for (const auto* method : methods) {
+      names.push_back(show(method));
+    }
+    std::sort(names.begin(), names.end());
+    auto names_value = Json::Value(Json::arrayValue);
+    for (const auto& name : names) {
+      names_value.append(Json::Value(name));
+    }
+    return names_value;
+  };
+  auto unstable_methods_value = Json::Value(Json::objectValue);
+  unstable_methods_value["widened"] = methods_to_json(widened_methods_);
+  unstable_methods_value["obscured"] = methods_to_json(obscured_methods_);
+  unstable_methods_value["stopped"] = methods_to_json(stopped_methods_);
+  value["unstable_methods"] = unstable_methods_value;
+
   auto times_value = Json::Value(Json::objectValue);
   for (const auto& record : times_) {
     times_value[record.first] = Json::Value(round(record.second, 3));
@@ -35,6 +35,18 @@ class Statistics final {
   void log_resident_set_size(double resident_set_size);
   void log_time(const std::string& name, const Timer& timer);
   void log_time(const Method* method, const Timer& timer);
+  void log_duplicate_methods(
+      std::size_t number_duplicate_methods,
+      std::size_t number_duplicate_analyses,
+      std::size_t number_shared_analyses);
+  void log_precision_level(
+      std::size_t iteration,
+      std::size_t precision_level,
+      double resident_set_size);
+  void log_unstable_methods(
+      std::vector<const Method*> widened_methods,
+      std::vector<const Method*> obscured_methods,
+      std::vector<const Method*> stopped_methods);
 
   Json::Value to_json() const;
 
@@ -50,6 +62,29 @@ class Statistics final {
   // Maximum RSS, in GB.
   double max_resident_set_size_ = -1.0;
 
+  // Number of methods that are a duplicate of another method.
+  std::size_t number_duplicate_methods_ = 0;
+
+  // Number of times a duplicate was processed while its representative was
+  // analyzed in the same iteration, and how many times the result was reused.
+  std::size_t number_duplicate_analyses_ = 0;
+  std::size_t number_shared_analyses_ = 0;
+
+  // Precision levels reached under memory pressure, with the iteration at
+  // which they were applied and the RSS that triggered them.
+  struct PrecisionDegradation {
+    std::size_t iteration;
+    std::size_t precision_level;
+    double resident_set_size;
+  };
+  std::vector<PrecisionDegradation> precision_degradations_;
+
+  // Methods whose model kept changing during the global fixpoint, and that
+  // were widened aggressively or treated as obscure.
+  std::vector<const Method*> widened_methods_;
+  std::vector<const Method*> obscured_methods_;
+  std::vector<const Method*> stopped_methods_;
+
   // Recorded times for each step of the analysis.
   std::unordered_map<std::string, double> times_;
 
@@ -16,7 +16,7 @@
 
 #include <mariana-trench/CalleeFrames.h>
 #include <mariana-trench/Frame.h>
-#include <mariana-trench/GroupHashedSetAbstractDomain.h>
+#include <mariana-trench/PersistentGroupHashedSetAbstractDomain.h>
 
 namespace marianatrench {
 
@@ -46,7 +46,7 @@ class TaintV2 final : public sparta::AbstractDomain<TaintV2> {
     }
   };
 
-  using Set = GroupHashedSetAbstractDomain<
+  using Set = PersistentGroupHashedSetAbstractDomain<
       CalleeFrames,
       GroupHash,
       GroupEqual,
@@ -498,51 +498,47 @@ void check_multi_source_multi_sink_rules(
     MethodContext* context,
     const Kind* source_kind,
     const Taint& source,
-    const Kind* sink_kind,
     const Taint& sink,
     FulfilledPartialKindState& fulfilled_partial_sinks,
-    const MultiSourceMultiSinkRule* rule,
+    const Rules::PartialKindRule* partial_kind_rule,
     const Position* position,
     const FeatureMayAlwaysSet& extra_features) {
-  const auto* partial_sink = sink_kind->as<PartialKind>();
-  mt_assert(partial_sink != nullptr);
-
   // Features found by this branch of the multi-source-sink flow. Should be
   // reported as part of the final issue discovered.
   auto features = source.features_joined();
   features.add(sink.features_joined());
 
   auto issue_sink_frame = fulfilled_partial_sinks.fulfill_kind(
-      partial_sink, rule, features, context, sink);
+      partial_kind_rule, features, context, sink);
 
   if (issue_sink_frame) {
     create_issue(
-        context, source, *issue_sink_frame, rule, position, extra_features);
+        context,
+        source,
+        *issue_sink_frame,
+        partial_kind_rule->rule,
+        position,
+        extra_features);
   } else {
     LOG_OR_DUMP(
         context,
         4,
         "Found source kind: {} flowing into partial sink: {}, rule code: {}",
         *source_kind,
-        *partial_sink,
-        rule->code());
+        *partial_kind_rule->kind,
+        partial_kind_rule->rule->code());
   }
 }
 
 FeatureMayAlwaysSet get_fulfilled_sink_features(
+    MethodContext* context,
     const FulfilledPartialKindState& fulfilled_partial_sinks,
     const Kind* transformed_sink_kind) {
   const auto* new_kind = transformed_sink_kind->as<TriggeredPartialKind>();
   // Called only after transform_kind_with_features creates a triggered kind,
-  // so this must be a TriggeredPartialKind.
+  // so this must be a TriggeredPartialKind, and its counterpart must exist.
   mt_assert(new_kind != nullptr);
-  const auto* rule = new_kind->rule();
-  const auto* counterpart = fulfilled_partial_sinks.get_fulfilled_counterpart(
-      /* unfulfilled_kind */ new_kind->partial_kind(), rule);
-
-  // A triggered kind was created, so its counterpart must exist.
-  mt_assert(counterpart != nullptr);
-  return fulfilled_partial_sinks.get_features(counterpart, rule);
+  return fulfilled_partial_sinks.get_counterpart_features(context, new_kind);
 }
 
 void create_sinks(
@@ -582,8 +578,9 @@ void create_sinks(
           return fulfilled_partial_sinks.make_triggered_counterparts(
               context, /* unfulfilled_kind */ partial_sink);
         },
-        [&fulfilled_partial_sinks](const Kind* new_kind) {
-          return get_fulfilled_sink_features(fulfilled_partial_sinks, new_kind);
+        [context, &fulfilled_partial_sinks](const Kind* new_kind) {
+          return get_fulfilled_sink_features(
+              context, fulfilled_partial_sinks, new_kind);
         });
     new_sinks.add_inferred_features(features);
 
@@ -653,7 +650,6 @@ void check_flows(
                 context,
                 source_kind,
                 source_taint,
-                sink_kind,
                 sink_taint,
                 *fulfilled_partial_sinks,
                 partial_rule,
@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include <ConcurrentContainers.h>
+#include <ControlFlow.h>
+#include <IRCode.h>
+#include <IRInstruction.h>
+#include <SpartaWorkQueue.h>
+
+#include <mariana-trench/CallGraph.h>
+#include <mariana-trench/Features.h>
+#include <mariana-trench/Log.h>
+#include <mariana-trench/Methods.h>
+#include <mariana-trench/TrivialMethods.h>
+
+namespace marianatrench {
+
+namespace {
+
+/**
+ * The value of a register: unknown, a parameter or a field of a parameter.
+ * This is a tiny subset of the memory locations used by the analysis.
+ */
+struct Value {
+  std::optional<ParameterPosition> parameter;
+  const DexString* MT_NULLABLE field = nullptr;
+
+  static Value unknown() {
+    return Value{};
+  }
+
+  bool is_parameter() const {
+    return parameter && field == nullptr;
+  }
+
+  /* See `Transfer::analyze_load_param`. */
+  Frame artificial_source() const {
+    mt_assert(parameter);
+    auto frame = Frame::artificial_source(
+        AccessPath(Root(Root::Kind::Argument, *parameter)));
+    if (field != nullptr) {
+      frame.callee_port_append(field);
+    }
+    return frame;
+  }
+
+  /* See `infer_inline_as` in `Transfer.cpp`. */
+  AccessPathConstantDomain access_path() const {
+    if (!parameter) {
+      return AccessPathConstantDomain::top();
+    }
+    auto path = AccessPath(Root(Root::Kind::Argument, *parameter));
+    if (field != nullptr) {
+      path.append(field);
+    }
+    return AccessPathConstantDomain(path);
+  }
+};
+
+bool has_field_model(
+    const Context& context,
+    const Registry& registry,
+    const Method* method,
+    const IRInstruction* instruction) {
+  const auto* field =
+      context.call_graph->resolved_field_access(method, instruction);
+  return field != nullptr && !registry.get(field).empty();
+}
+
+/* See `infer_output_taint` in `Transfer.cpp`. */
+void add_propagation(Model& model, const Frame& source, AccessPath output) {
+  const auto& input = source.callee_port();
+  if (input.root() == output.root()) {
+    return;
+  }
+  auto features = source.features();
+  features.add_always(model.attach_to_propagations(input.root()));
+  features.add_always(model.attach_to_propagations(output.root()));
+  model.add_inferred_propagation(
+      Propagation(
+          input,
+          /* inferred_features */ features,
+          /* user_features */ FeatureSet::bottom()),
+      std::move(output));
+}
+
+} // namespace
+
+std::optional<Model> TrivialMethods::summarize(
+    Context& context,
+    const Registry& registry,
+    const Method* method) {
+  const auto* code = method->get_code();
+  if (code == nullptr || !code->cfg_built() ||
+      code->cfg().blocks().size() != 1 ||
+      !context.call_graph->artificial_callees(method).empty()) {
+    return std::nullopt;
+  }
+
+  // User-provided models can change what the analysis infers.
+  auto model = registry.get(method);
+  if (!model.empty()) {
+    return std::nullopt;
+  }
+
+  std::unordered_map<Register, Value> registers;
+  auto read = [&registers](Register register_id) {
+    auto found = registers.find(register_id);
+    return found != registers.end() ? found->second : Value::unknown();
+  };
+
+  ParameterPosition next_parameter = 0;
+  auto result = Value::unknown();
+  std::optional<Value> returned;
+  // Fields of `this` written by the method, in order.
+  std::vector<std::pair<const DexString*, Value>> writes;
+
+  for (const auto& entry : InstructionIterable(code->cfg().entry_block())) {
+    const auto* instruction = entry.insn;
+    auto opcode = instruction->opcode();
+
+    if (opcode::is_a_load_param(opcode)) {
+      registers[instruction->dest()] = Value{next_parameter++, nullptr};
+    } else if (
+        opcode == OPCODE_MOVE || opcode == OPCODE_MOVE_WIDE ||
+        opcode == OPCODE_MOVE_OBJECT) {
+      registers[instruction->dest()] = read(instruction->srcs()[0]);
+    } else if (opcode::is_move_result_any(opcode)) {
+      registers[instruction->dest()] = result;
+      result = Value::unknown();
+    } else if (opcode == OPCODE_CONST || opcode == OPCODE_CONST_WIDE) {
+      registers[instruction->dest()] = Value::unknown();
+    } else if (opcode::is_an_iget(opcode)) {
+      auto object = read(instruction->srcs()[0]);
+      const auto* field = instruction->get_field()->get_name();
+      bool written = std::any_of(
+          writes.begin(), writes.end(), [field](const auto& write) {
+            return write.first == field;
+          });
+      if (!object.is_parameter() || (*object.parameter == 0 && written) ||
+          has_field_model(context, registry, method, instruction)) {
+        return std::nullopt;
+      }
+      result = Value{object.parameter, field};
+    } else if (opcode::is_an_iput(opcode)) {
+      auto value = read(instruction->srcs()[0]);
+      auto object = read(instruction->srcs()[1]);
+      if (method->is_static() || !object.is_parameter() ||
+          *object.parameter != 0 || value.field != nullptr ||
+          (value.parameter && *value.parameter == 0) ||
+          has_field_model(context, registry, method, instruction)) {
+        return std::nullopt;
+      }
+      // This is a strong update on the field of `this`.
+      const auto* field = instruction->get_field()->get_name();
+      writes.erase(
+          std::remove_if(
+              writes.begin(),
+              writes.end(),
+              [field](const auto& write) { return write.first == field; }),
+          writes.end());
+      writes.emplace_back(field, value);
+    } else if (opcode::is_a_return_value(opcode)) {
+      returned = read(instruction->srcs()[0]);
+    } else if (opcode != OPCODE_RETURN_VOID && opcode != OPCODE_NOP) {
+      return std::nullopt;
+    }
+  }
+
+  // Fields are memory locations: reading a field after it was overwritten
+  // returns the new value.
+  if (returned && returned->parameter && returned->field != nullptr &&
+      *returned->parameter == 0 &&
+      std::any_of(writes.begin(), writes.end(), [&](const auto& write) {
+        return write.first == returned->field;
+      })) {
+    return std::nullopt;
+  }
+
+  // See `Transfer::analyze_iput` and `add_field_features`.
+  auto written_source = [&context](const DexString* field, const Value& value) {
+    auto frame = value.artificial_source();
+    if (field->str() == "this$0") {
+      frame.add_inferred_features(FeatureMayAlwaysSet::make_always(
+          {context.features->get("via-inner-class-this")}));
+    }
+    return frame;
+  };
+
+  // See `Transfer::analyze_return`.
+  if (returned) {
+    model.set_inline_as(
+        writes.empty() ? returned->access_path()
+                       : AccessPathConstantDomain::top());
+    if (returned->parameter) {
+      add_propagation(
+          model,
+          returned->artificial_source(),
+          AccessPath(Root(Root::Kind::Return)));
+    }
+    if (returned->is_parameter() && *returned->parameter == 0 &&
+        !method->is_static()) {
+      for (const auto& [field, value] : writes) {
+        if (value.parameter) {
+          add_propagation(
+              model,
+              written_source(field, value),
+              AccessPath(Root(Root::Kind::Return), Path{field}));
+        }
+      }
+    }
+  }
+  if (!method->is_static()) {
+    for (const auto& [field, value] : writes) {
+      if (value.parameter) {
+        add_propagation(
+            model,
+            written_source(field, value),
+            AccessPath(Root(Root::Kind::Argument, 0), Path{field}));
+      }
+    }
+  }
+
+  model.collapse_invalid_paths(context);
+  model.approximate();
+  return model;
+}
+
+std::unordered_set<const Method*> TrivialMethods::summarize_all(
+    Context& context,
+    Registry& registry) {
+  ConcurrentSet<const Method*> summarized;
+  auto queue = sparta::work_queue<const Method*>(
+      [&](const Method* method) {
+        auto model = summarize(context, registry, method);
+        if (model) {
+          LOG(4, "Summarized trivial method `{}`: {}", method->show(), *model);
+          registry.set(*model);
+          // The model is final, see `Interprocedural::run_analysis`.
+          registry.freeze(method);
+          summarized.insert(method);
+        }
+      },
+      sparta::parallel::default_num_threads());
+  for (const auto* method : *context.methods) {
+    queue.add_item(method);
+  }
+  queue.run_all();
+
+  return std::unordered_set<const Method*>(
+      summarized.begin(), summarized.end());
+}
+
+} // namespace marianatrench
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <optional>
+#include <unordered_set>
+
+#include <mariana-trench/Context.h>
+#include <mariana-trench/Method.h>
+#include <mariana-trench/Model.h>
+#include <mariana-trench/Registry.h>
+
+namespace marianatrench {
+
+/**
+ * Compute the models of trivial methods without running the fixpoint.
+ *
+ * A method is trivial if its code is a single basic block that only loads
+ * parameters, reads fields of parameters, writes parameters into fields of
+ * `this` and returns. This covers getters, setters and `return this` builders
+ * that only store their parameters. Their model does not depend on any other
+ * model, so it is computed once, before the global fixpoint.
+ *
+ * The model is the one `Interprocedural::analyze` would infer: propagations
+ * and `inline_as`. Methods that do anything else (e.g, call a method) are left
+ * to the fixpoint.
+ */
+class TrivialMethods final {
+ public:
+  /* Return the model of the given method if it is trivial. */
+  static std::optional<Model> summarize(
+      Context& context,
+      const Registry& registry,
+      const Method* method);
+
+  /**
+   * Store the models of all trivial methods in the registry and return the
+   * set of methods that no longer need to be analyzed.
+   */
+  static std::unordered_set<const Method*> summarize_all(
+      Context& context,
+      Registry& registry);
+};
+
+} // namespace marianatrench
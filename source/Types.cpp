@@ -8,6 +8,7 @@
 #include <algorithm>
 
 #include <Show.h>
+#include <SpartaWorkQueue.h>
 #include <Walkers.h>
 
 #include <ProguardConfiguration.h>
@@ -15,6 +16,7 @@
 #include <ProguardMatcher.h>
 #include <ProguardParser.h>
 #include <mariana-trench/Assert.h>
+#include <mariana-trench/JsonValidation.h>
 #include <mariana-trench/Log.h>
 #include <mariana-trench/Options.h>
 #include <mariana-trench/Types.h>
@@ -44,6 +46,39 @@ Types::Types(const Options& options, const DexStoresVector& stores) {
   }
 }
 
+Types::Types(
+    const Methods& methods,
+    const DexStoresVector& stores,
+    const Json::Value& snapshot)
+    : global_type_analyzer_(nullptr) {
+  JsonValidation::validate_object(snapshot);
+  for (const auto& scope : DexStoreClassesIterator(stores)) {
+    walk::parallel::code(scope, [](DexMethod*, IRCode& code) {
+      if (!code.cfg_built()) {
+        code.build_cfg();
+      }
+    });
+  }
+
+  // The global type analysis is not available when restoring, hence types
+  // are restored for all methods or none of them.
+  std::size_t methods_with_code = 0;
+  for (const auto* method : methods) {
+    if (method->get_code() == nullptr) {
+      continue;
+    }
+    methods_with_code++;
+    environments_.emplace(method, restore_types_for_method(method, snapshot));
+  }
+  if (methods_with_code != snapshot.size()) {
+    // Avoid printing the whole snapshot in the error message.
+    throw JsonValidationError(
+        Json::Value(static_cast<Json::UInt64>(snapshot.size())),
+        /* field */ std::nullopt,
+        fmt::format("types for {} methods", methods_with_code));
+  }
+}
+
 namespace {
 
 static const TypeEnvironment empty_environment;
@@ -190,6 +225,52 @@ std::unique_ptr<TypeEnvironments> Types::infer_types_for_method(
   return environments;
 }
 
+std::unique_ptr<TypeEnvironments> Types::restore_types_for_method(
+    const Method* method,
+    const Json::Value& snapshot) {
+  // Instructions are identified by their index in the control flow graph,
+  // which is deterministic for a given program.
+  auto method_name = method->show();
+  if (!snapshot.isMember(method_name)) {
+    throw JsonValidationError(
+        Json::Value(method_name),
+        /* field */ std::nullopt,
+        /* expected */ "a method in the snapshot");
+  }
+  const auto& method_value = JsonValidation::null_or_array(
+      snapshot, /* field */ method_name);
+
+  std::vector<const IRInstruction*> instructions;
+  for (const auto& entry :
+       cfg::ConstInstructionIterable(method->get_code()->cfg())) {
+    instructions.push_back(entry.insn);
+  }
+
+  auto environments = std::make_unique<TypeEnvironments>();
+  for (const auto& instruction_value : method_value) {
+    auto index = JsonValidation::integer(instruction_value, "index");
+    if (index < 0 || static_cast<std::size_t>(index) >= instructions.size() ||
+        static_cast<int>(instructions[index]->opcode()) !=
+            JsonValidation::integer(instruction_value, "opcode")) {
+      throw JsonValidationError(
+          instruction_value,
+          /* field */ std::nullopt,
+          fmt::format("an instruction of `{}`", method_name));
+    }
+
+    TypeEnvironment environment;
+    for (const auto& register_value :
+         JsonValidation::null_or_array(instruction_value, "registers")) {
+      environment.emplace(
+          static_cast<Register>(
+              JsonValidation::integer(register_value, "register")),
+          JsonValidation::dex_type(register_value, "type"));
+    }
+    environments->emplace(instructions[index], std::move(environment));
+  }
+  return environments;
+}
+
 const TypeEnvironments& Types::environments(const Method* method) const {
   auto* environments = environments_.get(method, /* default */ nullptr);
   if (environments != nullptr) {
@@ -206,7 +287,8 @@ const TypeEnvironments& Types::environments(const Method* method) const {
     return empty_environments;
   }
 
-  environments_.emplace(method, this->infer_types_for_method(method));
+  auto environments = this->infer_types_for_method(method);
+  environments_.emplace(method, std::move(environments));
   return *environments_.at(method);
 }
 
@@ -254,4 +336,53 @@ const DexType* Types::receiver_type(
   return source_type(method, instruction, /* source_position */ 0);
 }
 
+Json::Value Types::to_json(const Methods& methods) const {
+  // Infer the types of all methods first, in parallel.
+  auto queue = sparta::work_queue<const Method*>(
+      [&](const Method* method) {
+        if (method->get_code() != nullptr) {
+          environments(method);
+        }
+      },
+      sparta::parallel::default_num_threads());
+  for (const auto* method : methods) {
+    queue.add_item(method);
+  }
+  queue.run_all();
+
+  auto value = Json::Value(Json::objectValue);
+  for (const auto* method : methods) {
+    const auto* code = method->get_code();
+    if (code == nullptr) {
+      continue;
+    }
+
+    const auto& environments = this->environments(method);
+    auto method_value = Json::Value(Json::arrayValue);
+    int index = 0;
+    for (const auto& entry : cfg::ConstInstructionIterable(code->cfg())) {
+      auto environment = environments.find(entry.insn);
+      if (environment != environments.end()) {
+        auto registers_value = Json::Value(Json::arrayValue);
+        for (const auto& [register_id, type] : environment->second) {
+          auto register_value = Json::Value(Json::objectValue);
+          register_value["register"] =
+              Json::Value(static_cast<int>(register_id));
+          register_value["type"] = Json::Value(show(type));
+          registers_value.append(register_value);
+        }
+        auto instruction_value = Json::Value(Json::objectValue);
+        instruction_value["index"] = Json::Value(index);
+        instruction_value["opcode"] =
+            Json::Value(static_cast<int>(entry.insn->opcode()));
+        instruction_value["registers"] = registers_value;
+        method_value.append(instruction_value);
+      }
+      index++;
+    }
+    value[method->show()] = method_value;
+  }
+  return value;
+}
+
 } // namespace marianatrench
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <boost/container/flat_map.hpp>
+#include <json/json.h>
 
 #include <DexClass.h>
 #include <GlobalTypeAnalyzer.h>
@@ -16,6 +17,7 @@
 #include <mariana-trench/Access.h>
 #include <mariana-trench/Compiler.h>
 #include <mariana-trench/Method.h>
+#include <mariana-trench/Methods.h>
 #include <mariana-trench/Options.h>
 #include <mariana-trench/UniquePointerConcurrentMap.h>
 
@@ -30,6 +32,17 @@ class Types final {
  public:
   Types() = default;
   explicit Types(const Options& options, const DexStoresVector& stores);
+
+  /**
+   * Restore the types inferred in a previous run on the same program, see
+   * `to_json`. Throws a `JsonValidationError` if the snapshot does not match
+   * the given methods, in which case types should be inferred again. Types of
+   * methods created later are inferred locally, on demand.
+   */
+  explicit Types(
+      const Methods& methods,
+      const DexStoresVector& stores,
+      const Json::Value& snapshot);
   Types(const Types&) = delete;
   Types(Types&&) = delete;
   Types& operator=(const Types&) = delete;
@@ -68,7 +81,17 @@ class Types final {
   const DexType* MT_NULLABLE
   receiver_type(const Method* method, const IRInstruction* instruction) const;
 
+  /**
+   * Infer the types of all the given methods and return them in a format
+   * that does not depend on the current process.
+   */
+  Json::Value to_json(const Methods& methods) const;
+
  private:
+  static std::unique_ptr<TypeEnvironments> restore_types_for_method(
+      const Method* method,
+      const Json::Value& snapshot);
+
   const TypeEnvironments& environments(const Method* method) const;
   std::unique_ptr<TypeEnvironments> infer_local_types_for_method(
       const Method* method) const;
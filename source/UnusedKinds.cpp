@@ -5,29 +5,21 @@
  * LICENSE file in the root directory of this source tree.
  */
 
-#include <SpartaWorkQueue.h>
-
-#include <mariana-trench/Methods.h>
-#include <mariana-trench/Rules.h>
+#include <mariana-trench/TriggeredPartialKind.h>
 #include <mariana-trench/UnusedKinds.h>
 
 namespace marianatrench {
 
-std::unordered_set<const Kind*> UnusedKinds::remove_unused_kinds(
-    Context& context,
-    Registry& registry) {
-  auto unused_kinds = context.rules->collect_unused_kinds(*context.kinds);
-  auto queue = sparta::work_queue<const Method*>(
-      [&](const Method* method) {
-        auto model = registry.get(method);
-        model.remove_kinds(unused_kinds);
-        registry.set(model);
-      },
-      sparta::parallel::default_num_threads());
-  for (const auto* method : *context.methods) {
-    queue.add_item(method);
-  }
-  queue.run_all();
-  return unused_kinds;
+UnusedKinds::UnusedKinds(const Rules& rules) : rules_(rules) {}
+
+bool UnusedKinds::contains(const Kind* kind) const {
+  // Triggered kinds are created by rules and never appear in them.
+  return kind->as<TriggeredPartialKind>() == nullptr && !rules_.uses(kind);
 }
+
+bool UnusedKinds::should_drop(const Context& context, const Kind* kind) {
+  return context.unused_kinds != nullptr &&
+      context.unused_kinds->contains(kind);
+}
+
 } // namespace marianatrench
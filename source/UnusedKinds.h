@@ -8,20 +8,41 @@
 #pragma once
 
 #include <mariana-trench/Context.h>
-#include <mariana-trench/Registry.h>
+#include <mariana-trench/Kind.h>
+#include <mariana-trench/Rules.h>
 
 namespace marianatrench {
 
-class UnusedKinds {
+/**
+ * A context might contain Kinds that are built into the binary, or specified in
+ * a model generator, but aren't actually used in any rule. Sources and sinks
+ * with these kinds can never lead to an issue, so they are dropped while models
+ * are constructed, before any memory is allocated for them.
+ *
+ * Kinds are created lazily, so this only keeps a reference to the rules and
+ * decides on a per-kind basis.
+ */
+class UnusedKinds final {
  public:
-  /*
-   * Before the analysis begins, a context might contain Kinds that are built
-   * into the binary, or specified in a model generator, but aren't actually
-   * used in any rule. These can be removed to save memory/time.
+  explicit UnusedKinds(const Rules& rules);
+
+  UnusedKinds(const UnusedKinds&) = delete;
+  UnusedKinds(UnusedKinds&&) = delete;
+  UnusedKinds& operator=(const UnusedKinds&) = delete;
+  UnusedKinds& operator=(UnusedKinds&&) = delete;
+  ~UnusedKinds() = default;
+
+  /* Return true if the given kind is not used in any rule. */
+  bool contains(const Kind* kind) const;
+
+  /**
+   * Return true if frames with the given kind should be dropped when building
+   * models. This is always false until the rules are loaded.
    */
-  static std::unordered_set<const Kind*> remove_unused_kinds(
-      Context& context,
-      Registry& registry);
+  static bool should_drop(const Context& context, const Kind* kind);
+
+ private:
+  const Rules& rules_;
 };
 
 } // namespace marianatrench
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <boost/container_hash/hash.hpp>
+
+#include <mariana-trench/GroupHashedSetAbstractDomain.h>
+#include <mariana-trench/PersistentGroupHashedSetAbstractDomain.h>
+
+namespace marianatrench {
+
+namespace {
+
+/**
+ * An element shaped like a `Frame`: it is grouped by kind, callee port,
+ * callee and call position, and carries a small set of features.
+ */
+struct Element {
+  std::uintptr_t kind;
+  std::vector<std::uintptr_t> callee_port;
+  std::uintptr_t callee;
+  std::uintptr_t call_position;
+  std::vector<int> features;
+
+  bool is_bottom() const {
+    return features.empty();
+  }
+
+  void set_to_bottom() {
+    features.clear();
+  }
+
+  bool operator==(const Element& other) const {
+    return kind == other.kind && callee_port == other.callee_port &&
+        callee == other.callee && call_position == other.call_position &&
+        features == other.features;
+  }
+
+  bool leq(const Element& other) const {
+    return std::includes(
+        other.features.begin(),
+        other.features.end(),
+        features.begin(),
+        features.end());
+  }
+
+  void join_with(const Element& other) {
+    std::vector<int> result;
+    std::set_union(
+        features.begin(),
+        features.end(),
+        other.features.begin(),
+        other.features.end(),
+        std::back_inserter(result));
+    features = std::move(result);
+  }
+
+  struct GroupHash {
+    std::size_t operator()(const Element& element) const {
+      // Same as `Frame::GroupHash`.
+      std::size_t seed = 0;
+      boost::hash_combine(seed, element.kind);
+      boost::hash_combine(
+          seed,
+          boost::hash_range(
+              element.callee_port.begin(), element.callee_port.end()));
+      boost::hash_combine(seed, element.callee);
+      boost::hash_combine(seed, element.call_position);
+      return seed;
+    }
+  };
+
+  struct GroupEqual {
+    bool operator()(const Element& left, const Element& right) const {
+      return left.kind == right.kind && left.callee_port == right.callee_port &&
+          left.callee == right.callee &&
+          left.call_position == right.call_position;
+    }
+  };
+};
+
+using UnorderedSet = GroupHashedSetAbstractDomain<
+    Element,
+    Element::GroupHash,
+    Element::GroupEqual>;
+
+using FlatSet = FlatGroupHashedSetAbstractDomain<
+    Element,
+    Element::GroupHash,
+    Element::GroupEqual>;
+
+using PersistentSet = PersistentGroupHashedSetAbstractDomain<
+    Element,
+    Element::GroupHash,
+    Element::GroupEqual>;
+
+/* Create `size` elements in distinct groups, each with the given feature. */
+std::vector<Element> make_elements(std::size_t size, int feature) {
+  std::vector<Element> elements;
+  for (std::size_t index = 0; index < size; index++) {
+    elements.push_back(Element{
+        /* kind */ 0x1000 + (index % 4) * 8,
+        /* callee_port */ {index % 3, 0x2000 + index * 8},
+        /* callee */ 0x3000 + (index / 4) * 8,
+        /* call_position */ 0x4000 + (index % 7) * 8,
+        /* features */ {feature, 100 + static_cast<int>(index % 5)}});
+  }
+  return elements;
+}
+
+template <typename Set>
+Set make_set(std::size_t size, int feature) {
+  Set set;
+  for (const auto& element : make_elements(size, feature)) {
+    set.add(element);
+  }
+  return set;
+}
+
+template <typename Set>
+void add(benchmark::State& state) {
+  auto elements = make_elements(state.range(0), /* feature */ 1);
+  for (auto _ : state) {
+    Set set;
+    for (const auto& element : elements) {
+      set.add(element);
+    }
+    benchmark::DoNotOptimize(set);
+  }
+}
+
+template <typename Set>
+void copy(benchmark::State& state) {
+  auto set = make_set<Set>(state.range(0), /* feature */ 1);
+  for (auto _ : state) {
+    auto copy = set;
+    benchmark::DoNotOptimize(copy);
+  }
+}
+
+template <typename Set>
+void leq(benchmark::State& state) {
+  auto left = make_set<Set>(state.range(0), /* feature */ 1);
+  auto right = left;
+  right.join_with(make_set<Set>(state.range(0), /* feature */ 2));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(left.leq(right));
+  }
+}
+
+template <typename Set>
+void join_with(benchmark::State& state) {
+  auto left = make_set<Set>(state.range(0), /* feature */ 1);
+  auto right = make_set<Set>(state.range(0) * 2, /* feature */ 2);
+  for (auto _ : state) {
+    auto result = left;
+    result.join_with(right);
+    benchmark::DoNotOptimize(result);
+  }
+}
+
+// Taint on a given port usually has a handful of frames, and rarely more
+// than a few hundreds.
+void set_sizes(benchmark::internal::Benchmark* benchmark) {
+  benchmark->RangeMultiplier(4)->Range(1, 256);
+}
+
+} // namespace
+
+#define MT_GROUP_HASHED_SET_BENCHMARK(function)                \
+  BENCHMARK_TEMPLATE(function, UnorderedSet)->Apply(set_sizes); \
+  BENCHMARK_TEMPLATE(function, FlatSet)->Apply(set_sizes);      \
+  BENCHMARK_TEMPLATE(function, PersistentSet)->Apply(set_sizes)
+
+MT_GROUP_HASHED_SET_BENCHMARK(add);
+MT_GROUP_HASHED_SET_BENCHMARK(copy);
+MT_GROUP_HASHED_SET_BENCHMARK(leq);
+MT_GROUP_HASHED_SET_BENCHMARK(join_with);
+
+} // namespace marianatrench
+
+BENCHMARK_MAIN();
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <benchmark/benchmark.h>
+#include <fmt/format.h>
+
+#include <mariana-trench/SourceScanner.h>
+
+namespace marianatrench {
+
+namespace {
+
+/**
+ * A Java source shaped like the ones we index: a package, imports, and
+ * classes with documentation, comments and string literals.
+ */
+std::string make_source(std::size_t number_classes) {
+  std::string source = "package com.facebook.example;\n\n";
+  for (std::size_t index = 0; index < 20; index++) {
+    source += fmt::format("import com.facebook.example.Import{};\n", index);
+  }
+  for (std::size_t index = 0; index < number_classes; index++) {
+    source += fmt::format(
+        "\n"
+        "/**\n"
+        " * Documentation of the class, which can be long and mention the\n"
+        " * class Example{0} in the middle of a sentence.\n"
+        " */\n"
+        "public final class Example{0} extends Base {{\n"
+        "  private static final String TAG = \"Example{0} /* tag */\";\n"
+        "\n"
+        "  // Returns a value computed from the input.\n"
+        "  public int compute(int input, char separator) {{\n"
+        "    if (separator == '\\'' || separator == '\"') {{\n"
+        "      return input * {0} + TAG.length();\n"
+        "    }}\n"
+        "    return helper(input, \"value: \" + input); /* inline */\n"
+        "  }}\n"
+        "}}\n",
+        index);
+  }
+  return source;
+}
+
+/* Match every line separately, as we did before `visit_code_lines`. */
+void per_line(benchmark::State& state) {
+  auto source = make_source(state.range(0));
+  for (auto _ : state) {
+    std::optional<std::string_view> package;
+    std::size_t classes = 0;
+    const char* current = source.data();
+    const char* end = current + source.size();
+    while (current < end) {
+      const auto* newline = static_cast<const char*>(std::memchr(
+          current, '\n', static_cast<std::size_t>(end - current)));
+      if (newline == nullptr) {
+        newline = end;
+      }
+      auto line = std::string_view(
+          current, static_cast<std::size_t>(newline - current));
+      if (!package) {
+        package = SourceScanner::package(line);
+      }
+      if (SourceScanner::class_name(line)) {
+        classes++;
+      }
+      current = newline + 1;
+    }
+    benchmark::DoNotOptimize(package);
+    benchmark::DoNotOptimize(classes);
+  }
+  state.SetBytesProcessed(
+      static_cast<std::int64_t>(state.iterations() * source.size()));
+}
+
+void visit_code_lines(benchmark::State& state) {
+  auto source = make_source(state.range(0));
+  for (auto _ : state) {
+    std::optional<std::string_view> package;
+    std::size_t classes = 0;
+    SourceScanner::visit_code_lines(source, [&](std::string_view line) {
+      if (!package) {
+        package = SourceScanner::package(line);
+      }
+      if (SourceScanner::class_name(line)) {
+        classes++;
+      }
+      return true;
+    });
+    benchmark::DoNotOptimize(package);
+    benchmark::DoNotOptimize(classes);
+  }
+  state.SetBytesProcessed(
+      static_cast<std::int64_t>(state.iterations() * source.size()));
+}
+
+// Most source files define a single class, generated ones can define many.
+void source_sizes(benchmark::internal::Benchmark* benchmark) {
+  benchmark->RangeMultiplier(8)->Range(1, 512);
+}
+
+} // namespace
+
+BENCHMARK(per_line)->Apply(source_sizes);
+BENCHMARK(visit_code_lines)->Apply(source_sizes);
+
+} // namespace marianatrench
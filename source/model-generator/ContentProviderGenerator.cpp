@@ -31,29 +31,32 @@ std::unordered_set<std::string> provider_regex_strings = {
     ".*;\\.openTypedAssetFile:\\(Landroid/net/Uri;Ljava/lang/String;.*\\)Landroid/content/res/AssetFileDescriptor;"};
 
 Model create_model(const Method* method, Context& context) {
-  auto model = Model(method, context);
-  model.add_mode(Model::Mode::NoJoinVirtualOverrides, context);
+  std::vector<std::pair<AccessPath, Frame>> parameter_sources;
   for (const auto& argument : generator::get_argument_types(method)) {
-    model.add_parameter_source(
+    parameter_sources.emplace_back(
         AccessPath(Root(Root::Kind::Argument, argument.first)),
         generator::source(
             context,
             method,
             /* kind */ "ProviderUserInput"));
   }
+  std::vector<std::pair<AccessPath, Frame>> sinks;
   auto return_type = generator::get_return_type_string(method);
-  if (!return_type) {
-    return model;
-  }
-  if (!boost::equals(*return_type, "I")) {
-    model.add_sink(
+  if (return_type && !boost::equals(*return_type, "I")) {
+    sinks.emplace_back(
         AccessPath(Root(Root::Kind::Return)),
         generator::sink(
             context,
             method,
             /* kind */ "ProviderExitNode"));
   }
-  return model;
+  return Model(
+      method,
+      context,
+      Model::Mode::NoJoinVirtualOverrides,
+      /* generations */ {},
+      parameter_sources,
+      sinks);
 }
 
 } // namespace
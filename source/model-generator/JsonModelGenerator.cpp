@@ -71,6 +71,10 @@ MethodHashedSet JsonModelGeneratorItem::may_satisfy(
   return constraint_->may_satisfy(method_mappings);
 }
 
+bool JsonModelGeneratorItem::empty() const {
+  return model_template_.empty();
+}
+
 JsonFieldModelGeneratorItem::JsonFieldModelGeneratorItem(
     const std::string& name,
     Context& context,
@@ -151,6 +155,22 @@ JsonModelGenerator::JsonModelGenerator(
       ERROR(1, "Models for `{}` are not supported.", find_name);
     }
   }
+
+  // Sources and sinks with unused kinds are dropped while parsing, which can
+  // leave items with nothing to emit.
+  std::vector<JsonModelGeneratorItem> items;
+  for (auto& item : items_) {
+    if (!item.empty()) {
+      items.push_back(std::move(item));
+    }
+  }
+  if (items.size() != items_.size()) {
+    LOG(3,
+        "Pruned {} empty items from json model generator {}",
+        items_.size() - items.size(),
+        name);
+    items_ = std::move(items);
+  }
 }
 
 std::vector<Model> JsonModelGenerator::emit_method_models(
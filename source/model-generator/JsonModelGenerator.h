@@ -34,6 +34,9 @@ class JsonModelGeneratorItem final : public MethodVisitorModelGenerator {
   MethodHashedSet may_satisfy(const MethodMappings& method_mappings) const;
   std::vector<Model> visit_method(const Method* method) const override;
 
+  /* Return true if this item never emits a model. */
+  bool empty() const;
+
  private:
   std::unique_ptr<AllOfMethodConstraint> constraint_;
   ModelTemplate model_template_;
@@ -5,8 +5,11 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <algorithm>
+
 #include <mariana-trench/JsonValidation.h>
 #include <mariana-trench/Log.h>
+#include <mariana-trench/UnusedKinds.h>
 #include <mariana-trench/constraints/MethodConstraints.h>
 #include <mariana-trench/constraints/TypeConstraints.h>
 #include <mariana-trench/model-generator/ModelTemplates.h>
@@ -226,6 +229,10 @@ void SinkTemplate::instantiate(
   model.add_sink(port_.instantiate(parameter_positions), sink_);
 }
 
+const Kind* SinkTemplate::kind() const {
+  return sink_.kind();
+}
+
 ParameterSourceTemplate::ParameterSourceTemplate(
     Frame source,
     AccessPathTemplate port)
@@ -248,6 +255,10 @@ void ParameterSourceTemplate::instantiate(
   model.add_parameter_source(port_.instantiate(parameter_positions), source_);
 }
 
+const Kind* ParameterSourceTemplate::kind() const {
+  return source_.kind();
+}
+
 GenerationTemplate::GenerationTemplate(Frame source, AccessPathTemplate port)
     : source_(std::move(source)), port_(std::move(port)) {}
 
@@ -268,6 +279,10 @@ void GenerationTemplate::instantiate(
   model.add_generation(port_.instantiate(parameter_positions), source_);
 }
 
+const Kind* GenerationTemplate::kind() const {
+  return source_.kind();
+}
+
 SourceTemplate::SourceTemplate(Frame source, AccessPathTemplate port)
     : source_(std::move(source)), port_(std::move(port)) {}
 
@@ -292,6 +307,10 @@ void SourceTemplate::instantiate(
   }
 }
 
+const Kind* SourceTemplate::kind() const {
+  return source_.kind();
+}
+
 AttachToSourcesTemplate::AttachToSourcesTemplate(
     FeatureSet features,
     RootTemplate port)
@@ -477,25 +496,38 @@ ForAllParameters ForAllParameters::from_json(
 
   for (auto sink_value :
        JsonValidation::null_or_array(value, /* field */ "sinks")) {
-    sink_templates.push_back(SinkTemplate::from_json(sink_value, context));
+    auto sink_template = SinkTemplate::from_json(sink_value, context);
+    if (!UnusedKinds::should_drop(context, sink_template.kind())) {
+      sink_templates.push_back(std::move(sink_template));
+    }
   }
 
   for (auto source_value :
        JsonValidation::null_or_array(value, /* field */ "parameter_sources")) {
-    parameter_source_templates.push_back(
-        ParameterSourceTemplate::from_json(source_value, context));
+    auto parameter_source_template =
+        ParameterSourceTemplate::from_json(source_value, context);
+    if (!UnusedKinds::should_drop(
+            context, parameter_source_template.kind())) {
+      parameter_source_templates.push_back(
+          std::move(parameter_source_template));
+    }
   }
 
   for (auto source_value :
        JsonValidation::null_or_array(value, /* field */ "generations")) {
-    generation_templates.push_back(
-        GenerationTemplate::from_json(source_value, context));
+    auto generation_template =
+        GenerationTemplate::from_json(source_value, context);
+    if (!UnusedKinds::should_drop(context, generation_template.kind())) {
+      generation_templates.push_back(std::move(generation_template));
+    }
   }
 
   for (auto source_value :
        JsonValidation::null_or_array(value, /* field */ "sources")) {
-    source_templates.push_back(
-        SourceTemplate::from_json(source_value, context));
+    auto source_template = SourceTemplate::from_json(source_value, context);
+    if (!UnusedKinds::should_drop(context, source_template.kind())) {
+      source_templates.push_back(std::move(source_template));
+    }
   }
 
   for (auto propagation_value :
@@ -599,6 +631,15 @@ bool ForAllParameters::instantiate(Model& model, const Method* method) const {
   return updated;
 }
 
+bool ForAllParameters::empty() const {
+  return sink_templates_.empty() && parameter_source_templates_.empty() &&
+      generation_templates_.empty() && source_templates_.empty() &&
+      propagation_templates_.empty() && attach_to_sources_templates_.empty() &&
+      attach_to_sinks_templates_.empty() &&
+      attach_to_propagations_templates_.empty() &&
+      add_features_to_arguments_templates_.empty();
+}
+
 ModelTemplate::ModelTemplate(
     const Model& model,
     std::vector<ForAllParameters> for_all_parameters)
@@ -635,6 +676,16 @@ std::optional<Model> ModelTemplate::instantiate(
   }
 }
 
+bool ModelTemplate::empty() const {
+  return model_.empty() &&
+      std::all_of(
+             for_all_parameters_.begin(),
+             for_all_parameters_.end(),
+             [](const ForAllParameters& for_all_parameters) {
+               return for_all_parameters.empty();
+             });
+}
+
 ModelTemplate ModelTemplate::from_json(
     const Json::Value& model,
     Context& context) {
@@ -142,6 +142,8 @@ class SinkTemplate final {
       const TemplateVariableMapping& parameter_positions,
       Model& model) const;
 
+  const Kind* kind() const;
+
  private:
   Frame sink_;
   AccessPathTemplate port_;
@@ -163,6 +165,8 @@ class ParameterSourceTemplate final {
       const TemplateVariableMapping& parameter_positions,
       Model& model) const;
 
+  const Kind* kind() const;
+
  private:
   Frame source_;
   AccessPathTemplate port_;
@@ -184,6 +188,8 @@ class GenerationTemplate final {
       const TemplateVariableMapping& parameter_positions,
       Model& model) const;
 
+  const Kind* kind() const;
+
  private:
   Frame source_;
   AccessPathTemplate port_;
@@ -203,6 +209,8 @@ class SourceTemplate final {
       const TemplateVariableMapping& parameter_positions,
       Model& model) const;
 
+  const Kind* kind() const;
+
  private:
   Frame source_;
   AccessPathTemplate port_;
@@ -326,6 +334,9 @@ class ForAllParameters final {
    * instantiated with the method. Return true if the model was updated. */
   bool instantiate(Model& model, const Method* method) const;
 
+  /* Return true if this does not add anything to a model. */
+  bool empty() const;
+
  private:
   std::unique_ptr<AllOfTypeConstraint> constraints_;
   std::string variable_;
@@ -356,6 +367,10 @@ class ModelTemplate final {
    * sinks/generations/...). */
   std::optional<Model> instantiate(Context& context, const Method* method)
       const;
+
+  /* Return true if instantiating this template never produces a model. */
+  bool empty() const;
+
   static ModelTemplate from_json(
       const Json::Value& model_generator,
       Context& context);
@@ -33,15 +33,17 @@ std::unordered_set<std::string_view> service_methods = {
     "handleMessage"};
 
 Model source_first_argument(const Method* method, Context& context) {
-  auto model = Model(method, context);
-  model.add_mode(Model::Mode::NoJoinVirtualOverrides, context);
-  model.add_parameter_source(
-      AccessPath(Root(Root::Kind::Argument, 1)),
-      generator::source(
-          context,
-          method,
-          /* kind */ "ServiceUserInput"));
-  return model;
+  return Model(
+      method,
+      context,
+      Model::Mode::NoJoinVirtualOverrides,
+      /* generations */ {},
+      /* parameter_sources */
+      {{AccessPath(Root(Root::Kind::Argument, 1)),
+        generator::source(
+            context,
+            method,
+            /* kind */ "ServiceUserInput")}});
 }
 
 } // namespace
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+#include <fmt/format.h>
+
+#include <mariana-trench/JsonValidation.h>
+#include <mariana-trench/Log.h>
+#include <mariana-trench/ModelIndex.h>
+
+namespace {
+
+namespace program_options = boost::program_options;
+using marianatrench::JsonValidation;
+using marianatrench::ModelIndex;
+
+/* Open the index of the given output directory, building it if needed. */
+std::unique_ptr<ModelIndex> open_index(
+    const boost::filesystem::path& output_directory,
+    const boost::filesystem::path& index_path,
+    bool rebuild) {
+  if (!boost::filesystem::is_directory(output_directory)) {
+    throw std::invalid_argument(fmt::format(
+        "Output directory `{}` does not exist.", output_directory.string()));
+  }
+
+  auto index =
+      rebuild ? nullptr : ModelIndex::open(output_directory, index_path);
+  if (!index) {
+    ModelIndex::build(output_directory, index_path);
+    index = ModelIndex::open(output_directory, index_path);
+  }
+  if (!index) {
+    throw std::runtime_error(fmt::format(
+        "Unable to open the model index at `{}`.", index_path.string()));
+  }
+  return index;
+}
+
+boost::filesystem::path index_path(
+    const program_options::variables_map& variables,
+    const boost::filesystem::path& output_directory) {
+  if (variables.count("index")) {
+    return variables["index"].as<std::string>();
+  }
+  return output_directory / "model-index.bin";
+}
+
+Json::Value to_json(const std::vector<std::string_view>& names) {
+  auto value = Json::Value(Json::arrayValue);
+  for (auto name : names) {
+    value.append(Json::Value(std::string(name)));
+  }
+  return value;
+}
+
+Json::Value to_json(const ModelIndex::Diff& diff) {
+  auto value = Json::Value(Json::objectValue);
+  value["added"] = Json::Value(Json::arrayValue);
+  for (const auto& name : diff.added) {
+    value["added"].append(Json::Value(name));
+  }
+  value["removed"] = Json::Value(Json::arrayValue);
+  for (const auto& name : diff.removed) {
+    value["removed"].append(Json::Value(name));
+  }
+  value["changed"] = Json::Value(Json::arrayValue);
+  for (const auto& [name, fields] : diff.changed) {
+    auto changed = Json::Value(Json::objectValue);
+    changed["name"] = Json::Value(name);
+    changed["fields"] = Json::Value(Json::arrayValue);
+    for (const auto& field : fields) {
+      changed["fields"].append(Json::Value(field));
+    }
+    value["changed"].append(changed);
+  }
+  return value;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  program_options::options_description options;
+  // clang-format off
+  options.add_options()
+      ("help,h", "Show help dialog.")
+      ("output-directory",
+       program_options::value<std::string>()->required(),
+       "Directory containing the `model@*.json` and `issues@*.json` files of an analysis run.")
+      ("index",
+       program_options::value<std::string>(),
+       "Path to the model index. Defaults to `model-index.bin` in the output directory.")
+      ("build-index",
+       "Rebuild the model index, even if it is up to date.")
+      ("method",
+       program_options::value<std::string>(),
+       "Print the model of the given method or field.")
+      ("methods-matching",
+       program_options::value<std::string>(),
+       "Print all methods and fields matching the given regular expression.")
+      ("kind",
+       program_options::value<std::string>(),
+       "Print all methods and fields whose model mentions the given kind.")
+      ("rule",
+       program_options::value<int>(),
+       "Print all issues for the given rule code.")
+      ("diff",
+       program_options::value<std::string>(),
+       "Print the difference between the models of the given output directory (before) and the models of the output directory (after).")
+      ("verbosity",
+       program_options::value<int>()->default_value(0),
+       "Logging verbosity.");
+  // clang-format on
+
+  try {
+    program_options::variables_map variables;
+    program_options::store(
+        program_options::command_line_parser(argc, argv).options(options).run(),
+        variables);
+
+    if (variables.count("help")) {
+      std::cerr << options;
+      return 0;
+    }
+
+    program_options::notify(variables);
+    marianatrench::Logger::set_level(variables["verbosity"].as<int>());
+
+    auto output_directory = boost::filesystem::path(
+        variables["output-directory"].as<std::string>());
+    auto index = open_index(
+        output_directory,
+        index_path(variables, output_directory),
+        variables.count("build-index") > 0);
+
+    auto writer = JsonValidation::styled_writer();
+    if (variables.count("method")) {
+      auto model = index->model(variables["method"].as<std::string>());
+      if (!model) {
+        std::cerr << "error: no model for `"
+                  << variables["method"].as<std::string>() << "`" << std::endl;
+        return 1;
+      }
+      writer->write(
+          JsonValidation::parse_json(std::string(*model)), &std::cout);
+      std::cout << std::endl;
+    }
+    if (variables.count("methods-matching")) {
+      writer->write(
+          to_json(index->names_matching(
+              variables["methods-matching"].as<std::string>())),
+          &std::cout);
+      std::cout << std::endl;
+    }
+    if (variables.count("kind")) {
+      writer->write(
+          to_json(index->names_with_kind(variables["kind"].as<std::string>())),
+          &std::cout);
+      std::cout << std::endl;
+    }
+    if (variables.count("rule")) {
+      auto issues = Json::Value(Json::arrayValue);
+      for (auto& issue : index->issues(variables["rule"].as<int>())) {
+        issues.append(std::move(issue));
+      }
+      writer->write(issues, &std::cout);
+      std::cout << std::endl;
+    }
+    if (variables.count("diff")) {
+      auto other_directory =
+          boost::filesystem::path(variables["diff"].as<std::string>());
+      auto other_index = open_index(
+          other_directory,
+          other_directory / "model-index.bin",
+          variables.count("build-index") > 0);
+      writer->write(
+          to_json(ModelIndex::diff(*other_index, *index)), &std::cout);
+      std::cout << std::endl;
+    }
+  } catch (const std::exception& exception) {
+    std::cerr << "error: " << exception.what() << std::endl;
+    return 1;
+  }
+}
@@ -88,3 +88,27 @@ TEST_F(ClassHierarchiesTest, ClassHierarchies) {
   EXPECT_TRUE(
       class_hierarchies.extends(dex_child_one_child->get_class()).empty());
 }
+
+TEST_F(ClassHierarchiesTest, FromJson) {
+  Scope scope;
+
+  auto* dex_parent = redex::create_void_method(scope, "LParent;", "f");
+  auto* dex_child = redex::create_void_method(
+      scope,
+      "LChild;",
+      "f",
+      /* parameter_types */ "",
+      /* return_type */ "V",
+      /* super */ dex_parent->get_class());
+
+  auto context = test_class_hierarchies(scope);
+  auto class_hierarchies =
+      ClassHierarchies::from_json(context.class_hierarchies->to_json());
+
+  EXPECT_THAT(
+      class_hierarchies->extends(dex_parent->get_class()),
+      testing::UnorderedElementsAre(dex_child->get_class()));
+  EXPECT_TRUE(class_hierarchies->extends(dex_child->get_class()).empty());
+  EXPECT_EQ(
+      class_hierarchies->to_json(), context.class_hierarchies->to_json());
+}
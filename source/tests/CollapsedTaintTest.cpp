@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+
+#include <TypeUtil.h>
+
+#include <mariana-trench/CollapsedTaint.h>
+#include <mariana-trench/FeatureMayAlwaysSet.h>
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class CollapsedTaintTest : public test::Test {};
+
+TEST_F(CollapsedTaintTest, Propagate) {
+  auto context = test::make_empty_context();
+
+  Scope scope;
+  auto* one =
+      context.methods->create(redex::create_void_method(scope, "LOne;", "one"));
+  auto* two =
+      context.methods->create(redex::create_void_method(scope, "LTwo;", "two"));
+  auto* three = context.methods->create(
+      redex::create_void_method(scope, "LThree;", "three"));
+  auto* four = context.methods->create(
+      redex::create_void_method(scope, "LFour;", "four"));
+
+  auto* test_position = context.positions->get(std::nullopt, 1);
+  auto* feature_one = context.features->get("FeatureOne");
+  auto* feature_two = context.features->get("FeatureTwo");
+  auto* feature_three = context.features->get("FeatureThree");
+  auto* user_feature_one = context.features->get("UserFeatureOne");
+  auto* user_feature_two = context.features->get("UserFeatureTwo");
+
+  auto taint = Taint{
+      test::make_frame(
+          /* kind */ context.kinds->get("TestSource"),
+          test::FrameProperties{
+              .origins = MethodSet{one},
+              .user_features = FeatureSet{user_feature_one}}),
+      test::make_frame(
+          /* kind */ context.kinds->get("OtherSource"),
+          test::FrameProperties{
+              .callee_port = AccessPath(Root(Root::Kind::Argument, 1)),
+              .callee = two,
+              .call_position = test_position,
+              .distance = 2,
+              .origins = MethodSet{two},
+              .inferred_features = FeatureMayAlwaysSet{feature_one},
+              .user_features = FeatureSet{user_feature_one}}),
+      test::make_frame(
+          /* kind */ context.kinds->get("OtherSource"),
+          test::FrameProperties{
+              .callee_port = AccessPath(Root(Root::Kind::Argument, 0)),
+              .callee = three,
+              .call_position = test_position,
+              .distance = 1,
+              .origins = MethodSet{three},
+              .inferred_features = FeatureMayAlwaysSet{feature_one},
+              .locally_inferred_features = FeatureMayAlwaysSet{feature_two},
+              .user_features = FeatureSet{user_feature_one, user_feature_two}}),
+      test::make_frame(
+          /* kind */ context.kinds->get("DroppedSource"),
+          test::FrameProperties{
+              .callee_port = AccessPath(Root(Root::Kind::Argument, 0)),
+              .callee = three,
+              .call_position = test_position,
+              .distance = 100,
+              .origins = MethodSet{three}}),
+  };
+
+  auto collapsed =
+      CollapsedTaint(taint, /* maximum_source_sink_distance */ 100);
+  EXPECT_FALSE(collapsed.empty());
+  EXPECT_FALSE(collapsed.needs_materialization());
+  EXPECT_EQ(collapsed.size(), 2);
+
+  // Frozen models collapse their flat frames directly.
+  std::vector<Frame> frames;
+  for (const auto& frame : taint.frames_iterator()) {
+    frames.push_back(frame);
+  }
+  auto collapsed_frames = CollapsedTaint(
+      frames.data(),
+      frames.data() + frames.size(),
+      /* maximum_source_sink_distance */ 100);
+  EXPECT_EQ(collapsed_frames.size(), 2);
+
+  for (const auto& extra_features :
+       {FeatureMayAlwaysSet::bottom(), FeatureMayAlwaysSet{feature_three}}) {
+    EXPECT_EQ(
+        collapsed_frames.propagate(
+            /* callee */ four,
+            /* callee_port */ AccessPath(Root(Root::Kind::Argument, 2)),
+            /* call_position */ context.positions->get("Test.java", 1),
+            extra_features,
+            context,
+            /* source_register_types */ {},
+            /* source_constant_arguments */ {}),
+        collapsed.propagate(
+            /* callee */ four,
+            /* callee_port */ AccessPath(Root(Root::Kind::Argument, 2)),
+            /* call_position */ context.positions->get("Test.java", 1),
+            extra_features,
+            context,
+            /* source_register_types */ {},
+            /* source_constant_arguments */ {}));
+    EXPECT_EQ(
+        collapsed.propagate(
+            /* callee */ four,
+            /* callee_port */ AccessPath(Root(Root::Kind::Argument, 2)),
+            /* call_position */ context.positions->get("Test.java", 1),
+            extra_features,
+            context,
+            /* source_register_types */ {},
+            /* source_constant_arguments */ {}),
+        taint.propagate(
+            /* callee */ four,
+            /* callee_port */ AccessPath(Root(Root::Kind::Argument, 2)),
+            /* call_position */ context.positions->get("Test.java", 1),
+            /* maximum_source_sink_distance */ 100,
+            extra_features,
+            context,
+            /* source_register_types */ {},
+            /* source_constant_arguments */ {}));
+  }
+}
+
+TEST_F(CollapsedTaintTest, PropagateViaTypeOf) {
+  auto context = test::make_empty_context();
+
+  Scope scope;
+  auto* one =
+      context.methods->create(redex::create_void_method(scope, "LOne;", "one"));
+  auto* two =
+      context.methods->create(redex::create_void_method(scope, "LTwo;", "two"));
+
+  auto* test_position = context.positions->get(std::nullopt, 1);
+  auto* feature_one = context.features->get("FeatureOne");
+
+  auto taint = Taint{
+      test::make_frame(
+          /* kind */ context.kinds->get("TestSource"),
+          test::FrameProperties{
+              .origins = MethodSet{one},
+              .via_type_of_ports =
+                  RootSetAbstractDomain({Root(Root::Kind::Argument, 0)})}),
+      test::make_frame(
+          /* kind */ context.kinds->get("TestSource"),
+          test::FrameProperties{
+              .callee_port = AccessPath(Root(Root::Kind::Argument, 1)),
+              .callee = one,
+              .call_position = test_position,
+              .distance = 1,
+              .origins = MethodSet{one},
+              .inferred_features = FeatureMayAlwaysSet{feature_one}}),
+      test::make_frame(
+          /* kind */ context.kinds->get("OtherSource"),
+          test::FrameProperties{.origins = MethodSet{one}}),
+  };
+
+  auto collapsed =
+      CollapsedTaint(taint, /* maximum_source_sink_distance */ 100);
+  EXPECT_TRUE(collapsed.needs_materialization());
+  EXPECT_EQ(collapsed.size(), 1);
+
+  EXPECT_EQ(
+      collapsed.propagate(
+          /* callee */ two,
+          /* callee_port */ AccessPath(Root(Root::Kind::Return)),
+          /* call_position */ context.positions->get("Test.java", 1),
+          /* extra_features */ {},
+          context,
+          /* source_register_types */ {type::java_lang_Object()},
+          /* source_constant_arguments */ {}),
+      taint.propagate(
+          /* callee */ two,
+          /* callee_port */ AccessPath(Root(Root::Kind::Return)),
+          /* call_position */ context.positions->get("Test.java", 1),
+          /* maximum_source_sink_distance */ 100,
+          /* extra_features */ {},
+          context,
+          /* source_register_types */ {type::java_lang_Object()},
+          /* source_constant_arguments */ {}));
+}
+
+} // namespace marianatrench
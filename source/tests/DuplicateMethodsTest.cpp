@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <fmt/format.h>
+#include <gmock/gmock.h>
+
+#include <DexStore.h>
+
+#include <mariana-trench/DuplicateMethods.h>
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/Registry.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class DuplicateMethodsTest : public test::Test {};
+
+namespace {
+
+std::string wrapper(const std::string& class_name) {
+  return fmt::format(
+      R"(
+    (method (public) "{0}.wrap:(Ljava/lang/String;)Ljava/lang/String;"
+     (
+      (load-param-object v0)
+      (load-param-object v1)
+      (invoke-static (v1) "LUtil;.escape:(Ljava/lang/String;)Ljava/lang/String;")
+      (move-result-object v2)
+      (iput-object v2 v0 "{0}.mValue:Ljava/lang/String;")
+      (return-object v0)
+     )
+    )
+  )",
+      class_name);
+}
+
+} // namespace
+
+TEST_F(DuplicateMethodsTest, Representative) {
+  Scope scope;
+  redex::create_void_method(
+      scope,
+      /* class_name */ "LUtil;",
+      /* method_name */ "escape",
+      /* parameter_types */ "Ljava/lang/String;",
+      /* return_type */ "Ljava/lang/String;",
+      /* super */ nullptr,
+      /* is_static */ true);
+  auto* dex_one = redex::create_method(scope, "LOne;", wrapper("LOne;"));
+  auto* dex_two = redex::create_method(scope, "LTwo;", wrapper("LTwo;"));
+  auto* dex_other = redex::create_method(scope, "LOther;", R"(
+    (method (public) "LOther;.wrap:(Ljava/lang/String;)Ljava/lang/String;"
+     (
+      (load-param-object v0)
+      (load-param-object v1)
+      (return-object v1)
+     )
+    )
+  )");
+
+  DexStore store("store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  auto registry = Registry(context);
+
+  auto* one = context.methods->get(dex_one);
+  auto* two = context.methods->get(dex_two);
+  auto* other = context.methods->get(dex_other);
+
+  EXPECT_EQ(
+      DuplicateMethods::canonical_form(context, registry, one),
+      DuplicateMethods::canonical_form(context, registry, two));
+  EXPECT_NE(
+      DuplicateMethods::canonical_form(context, registry, one),
+      DuplicateMethods::canonical_form(context, registry, other));
+
+  auto duplicate_methods = DuplicateMethods(context, registry);
+  EXPECT_EQ(duplicate_methods.size(), 1);
+  const auto* representative = duplicate_methods.representative(one);
+  const auto* duplicate = representative == nullptr ? one : two;
+  representative = representative == nullptr ? two : one;
+  EXPECT_EQ(duplicate_methods.representative(duplicate), representative);
+  EXPECT_TRUE(duplicate_methods.has_duplicates(representative));
+  EXPECT_EQ(duplicate_methods.representative(representative), nullptr);
+  EXPECT_EQ(duplicate_methods.representative(other), nullptr);
+}
+
+TEST_F(DuplicateMethodsTest, SelfCast) {
+  Scope scope;
+  auto self_cast = [](const std::string& class_name) {
+    return fmt::format(
+        R"(
+      (method (public) "{0}.cast:(Ljava/lang/Object;)Ljava/lang/Object;"
+       (
+        (load-param-object v0)
+        (load-param-object v1)
+        (check-cast v1 "{0}")
+        (move-result-pseudo-object v2)
+        (return-object v2)
+       )
+      )
+    )",
+        class_name);
+  };
+  auto* dex_one = redex::create_method(scope, "LOne;", self_cast("LOne;"));
+  auto* dex_two = redex::create_method(scope, "LTwo;", self_cast("LTwo;"));
+
+  DexStore store("store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  auto registry = Registry(context);
+
+  auto* one = context.methods->get(dex_one);
+  auto* two = context.methods->get(dex_two);
+
+  // Casts add a `via-cast` feature with the exact type.
+  EXPECT_NE(
+      DuplicateMethods::canonical_form(context, registry, one),
+      DuplicateMethods::canonical_form(context, registry, two));
+  auto duplicate_methods = DuplicateMethods(context, registry);
+  EXPECT_EQ(duplicate_methods.size(), 0);
+}
+
+TEST_F(DuplicateMethodsTest, VirtualCallOnThis) {
+  Scope scope;
+  auto* dex_base_get = redex::create_void_method(
+      scope,
+      /* class_name */ "LBase;",
+      /* method_name */ "get",
+      /* parameter_types */ "",
+      /* return_type */ "Ljava/lang/Object;");
+  const auto* base = dex_base_get->get_class();
+  auto call_get = [](const std::string& class_name) {
+    return fmt::format(
+        R"(
+      (method (public) "{0}.call:()Ljava/lang/Object;"
+       (
+        (load-param-object v0)
+        (invoke-virtual (v0) "LBase;.get:()Ljava/lang/Object;")
+        (move-result-object v1)
+        (return-object v1)
+       )
+      )
+    )",
+        class_name);
+  };
+  auto one_methods = redex::create_methods(
+      scope,
+      "LOne;",
+      std::vector<std::string>{
+          R"(
+      (method (public) "LOne;.get:()Ljava/lang/Object;"
+       (
+        (load-param-object v0)
+        (return-object v0)
+       )
+      )
+    )",
+          call_get("LOne;")},
+      /* super */ base);
+  auto* dex_one = one_methods[1];
+  auto* dex_two =
+      redex::create_method(scope, "LTwo;", call_get("LTwo;"), /* super */ base);
+
+  DexStore store("store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  auto registry = Registry(context);
+
+  auto* one = context.methods->get(dex_one);
+  auto* two = context.methods->get(dex_two);
+
+  // Overrides of the callee are filtered by the receiver type, which is the
+  // declaring class here: `LOne;.get` is only a callee of `LOne;.call`.
+  EXPECT_NE(
+      DuplicateMethods::canonical_form(context, registry, one),
+      DuplicateMethods::canonical_form(context, registry, two));
+  auto duplicate_methods = DuplicateMethods(context, registry);
+  EXPECT_EQ(duplicate_methods.size(), 0);
+}
+
+TEST_F(DuplicateMethodsTest, Share) {
+  Scope scope;
+  auto* dex_one = redex::create_void_method(scope, "LOne;", "one");
+  auto* dex_two = redex::create_void_method(scope, "LTwo;", "two");
+
+  DexStore store("store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+
+  auto* one = context.methods->get(dex_one);
+  auto* two = context.methods->get(dex_two);
+
+  auto propagation = std::make_pair(
+      Propagation(
+          /* input */ AccessPath(Root(Root::Kind::Argument, 0)),
+          /* inferred_features */ FeatureMayAlwaysSet::bottom(),
+          /* user_features */ FeatureSet::bottom()),
+      /* output */ AccessPath(Root(Root::Kind::Return)));
+  auto with_propagation = Model(
+      one,
+      context,
+      Model::Mode::Normal,
+      /* generations */ {},
+      /* parameter_sources */ {},
+      /* sinks */ {},
+      /* propagations */ {propagation});
+  auto shared = DuplicateMethods::share(
+      context,
+      two,
+      /* old_model */ Model(two, context),
+      /* representative_old_model */ Model(one, context),
+      /* representative_new_model */ with_propagation);
+  ASSERT_TRUE(shared);
+  EXPECT_EQ(shared->method(), two);
+  EXPECT_EQ(*shared, with_propagation);
+
+  // Different previous models.
+  EXPECT_FALSE(DuplicateMethods::share(
+      context,
+      two,
+      /* old_model */ Model(two, context),
+      /* representative_old_model */ with_propagation,
+      /* representative_new_model */ with_propagation));
+
+  // Taint contains positions within the representative.
+  auto with_generation = Model(
+      one,
+      context,
+      Model::Mode::Normal,
+      /* generations */
+      {{AccessPath(Root(Root::Kind::Return)),
+        Frame::leaf(context.kinds->get("TestSource"))}});
+  EXPECT_FALSE(DuplicateMethods::share(
+      context,
+      two,
+      /* old_model */ Model(two, context),
+      /* representative_old_model */ Model(one, context),
+      /* representative_new_model */ with_generation));
+}
+
+} // namespace marianatrench
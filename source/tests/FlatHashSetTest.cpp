@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <string>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include <mariana-trench/FlatHashSet.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class FlatHashSetTest : public test::Test {};
+
+namespace {
+
+using IntSet = FlatHashSet<int, std::hash<int>, std::equal_to<int>>;
+
+/* Hash everything to the same value, to exercise probing. */
+struct ConstantHash {
+  std::size_t operator()(int /* value */) const {
+    return 42;
+  }
+};
+
+using CollidingIntSet = FlatHashSet<int, ConstantHash, std::equal_to<int>>;
+
+using StringSet = FlatHashSet<
+    std::string,
+    std::hash<std::string>,
+    std::equal_to<std::string>>;
+
+template <typename Set>
+std::vector<int> elements(const Set& set) {
+  return std::vector<int>(set.begin(), set.end());
+}
+
+} // namespace
+
+TEST_F(FlatHashSetTest, Empty) {
+  IntSet set;
+  EXPECT_TRUE(set.empty());
+  EXPECT_EQ(set.size(), 0);
+  EXPECT_EQ(set.begin(), set.end());
+  EXPECT_EQ(set.find(1), set.end());
+}
+
+TEST_F(FlatHashSetTest, Insert) {
+  IntSet set;
+  auto [iterator, inserted] = set.insert(1);
+  EXPECT_TRUE(inserted);
+  EXPECT_EQ(*iterator, 1);
+  EXPECT_EQ(set.size(), 1);
+
+  std::tie(iterator, inserted) = set.insert(1);
+  EXPECT_FALSE(inserted);
+  EXPECT_EQ(*iterator, 1);
+  EXPECT_EQ(set.size(), 1);
+
+  set.emplace(2);
+  EXPECT_EQ(set.size(), 2);
+  EXPECT_THAT(elements(set), testing::UnorderedElementsAre(1, 2));
+  EXPECT_NE(set.find(2), set.end());
+  EXPECT_EQ(set.find(3), set.end());
+}
+
+TEST_F(FlatHashSetTest, Grow) {
+  // Grow from a small set, within a single group, to multiple groups.
+  IntSet set;
+  std::unordered_set<int> expected;
+  for (int value = 0; value < 1000; value++) {
+    set.insert(value * 7);
+    expected.insert(value * 7);
+    ASSERT_EQ(set.size(), expected.size());
+  }
+  for (int value = 0; value < 7000; value++) {
+    EXPECT_EQ(set.find(value) != set.end(), expected.count(value) > 0);
+  }
+  EXPECT_THAT(
+      elements(set),
+      testing::UnorderedElementsAreArray(expected.begin(), expected.end()));
+}
+
+TEST_F(FlatHashSetTest, Erase) {
+  IntSet set;
+  for (int value = 0; value < 100; value++) {
+    set.insert(value);
+  }
+
+  for (int value = 0; value < 100; value += 2) {
+    set.erase(set.find(value));
+  }
+  EXPECT_EQ(set.size(), 50);
+  for (int value = 0; value < 100; value++) {
+    EXPECT_EQ(set.find(value) != set.end(), value % 2 == 1);
+  }
+
+  // Erasing while iterating.
+  for (auto iterator = set.begin(); iterator != set.end();) {
+    if (*iterator % 3 == 0) {
+      iterator = set.erase(iterator);
+    } else {
+      ++iterator;
+    }
+  }
+  for (int value = 0; value < 100; value++) {
+    EXPECT_EQ(
+        set.find(value) != set.end(), value % 2 == 1 && value % 3 != 0);
+  }
+
+  set.clear();
+  EXPECT_TRUE(set.empty());
+  EXPECT_EQ(set.begin(), set.end());
+}
+
+TEST_F(FlatHashSetTest, Collisions) {
+  // All values share the same probing sequence, which fills multiple groups
+  // and leaves deleted slots in full groups.
+  CollidingIntSet set;
+  for (int value = 0; value < 64; value++) {
+    set.insert(value);
+  }
+  EXPECT_EQ(set.size(), 64);
+  for (int value = 0; value < 64; value++) {
+    EXPECT_NE(set.find(value), set.end());
+  }
+
+  for (int value = 0; value < 64; value += 4) {
+    set.erase(set.find(value));
+  }
+  EXPECT_EQ(set.size(), 48);
+  for (int value = 0; value < 64; value++) {
+    EXPECT_EQ(set.find(value) != set.end(), value % 4 != 0);
+  }
+
+  // Deleted slots are reused, and do not hide later values.
+  for (int value = 0; value < 64; value += 4) {
+    EXPECT_TRUE(set.insert(value).second);
+  }
+  EXPECT_EQ(set.size(), 64);
+  for (int value = 0; value < 64; value++) {
+    EXPECT_FALSE(set.insert(value).second);
+  }
+  EXPECT_EQ(set.size(), 64);
+}
+
+TEST_F(FlatHashSetTest, DeletedSlotsReuse) {
+  // Inserting and erasing repeatedly must not grow the set forever.
+  IntSet set;
+  for (int value = 0; value < 10000; value++) {
+    set.insert(value);
+    set.insert(value + 1);
+    set.erase(set.find(value));
+    set.erase(set.find(value + 1));
+    ASSERT_TRUE(set.empty());
+  }
+  set.insert(1);
+  EXPECT_THAT(elements(set), testing::ElementsAre(1));
+}
+
+TEST_F(FlatHashSetTest, CopyAndMove) {
+  StringSet set;
+  for (int value = 0; value < 50; value++) {
+    set.insert(std::to_string(value));
+  }
+
+  auto copy = set;
+  EXPECT_EQ(copy.size(), 50);
+  copy.erase(copy.find("0"));
+  copy.insert("new");
+  EXPECT_NE(set.find("0"), set.end());
+  EXPECT_EQ(set.find("new"), set.end());
+
+  auto moved = std::move(copy);
+  EXPECT_EQ(moved.size(), 50);
+  EXPECT_NE(moved.find("new"), moved.end());
+  EXPECT_TRUE(copy.empty()); // NOLINT(bugprone-use-after-move)
+
+  copy = moved;
+  EXPECT_EQ(copy.size(), 50);
+  copy = StringSet();
+  EXPECT_TRUE(copy.empty());
+  copy = std::move(moved);
+  EXPECT_EQ(copy.size(), 50);
+
+  StringSet small;
+  small.insert("one");
+  copy = small;
+  EXPECT_EQ(copy.size(), 1);
+  EXPECT_NE(copy.find("one"), copy.end());
+}
+
+} // namespace marianatrench
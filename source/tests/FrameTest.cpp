@@ -638,4 +638,136 @@ TEST_F(FrameTest, FrameWithKind) {
   EXPECT_EQ(frame2.kind(), kind_b);
 }
 
+TEST_F(FrameTest, FrameCopies) {
+  auto context = test::make_empty_context();
+
+  Scope scope;
+  auto* one = context.methods->create(
+      redex::create_void_method(scope, "LClass;", "one"));
+  auto* two = context.methods->create(
+      redex::create_void_method(scope, "LOther;", "two"));
+  auto* feature_one = context.features->get("FeatureOne");
+
+  auto frame = test::make_frame(
+      /* kind */ context.kinds->get("TestSource"),
+      test::FrameProperties{
+          .callee = one,
+          .call_position = context.positions->unknown(),
+          .distance = 1,
+          .origins = MethodSet{one}});
+
+  // Copies are identical.
+  auto copy = frame;
+  EXPECT_TRUE(copy.leq(frame));
+  EXPECT_TRUE(frame.leq(copy));
+  EXPECT_TRUE(copy.equals(frame));
+  copy.join_with(frame);
+  EXPECT_EQ(copy, frame);
+
+  // Modifying a copy does not affect the comparison.
+  copy.add_inferred_features(FeatureMayAlwaysSet{feature_one});
+  EXPECT_TRUE(frame.leq(copy));
+  EXPECT_FALSE(copy.leq(frame));
+  EXPECT_FALSE(copy.equals(frame));
+
+  copy = frame;
+  copy.set_origins(MethodSet{one, two});
+  EXPECT_TRUE(frame.leq(copy));
+  EXPECT_FALSE(copy.leq(frame));
+
+  copy = frame;
+  copy.add_local_position(context.positions->get("Test.java", 1));
+  EXPECT_TRUE(frame.leq(copy));
+  EXPECT_FALSE(copy.leq(frame));
+
+  // Joining with a smaller frame is a no-op.
+  auto joined = frame;
+  joined.join_with(copy);
+  EXPECT_EQ(joined, copy);
+  auto previous = joined;
+  joined.join_with(frame);
+  EXPECT_EQ(joined, previous);
+  EXPECT_TRUE(joined.leq(previous));
+  EXPECT_TRUE(previous.leq(joined));
+
+  // Frames built separately with the same content are equal.
+  auto other = test::make_frame(
+      /* kind */ context.kinds->get("TestSource"),
+      test::FrameProperties{
+          .callee = one,
+          .call_position = context.positions->unknown(),
+          .distance = 1,
+          .origins = MethodSet{one}});
+  EXPECT_TRUE(other.equals(frame));
+  EXPECT_TRUE(other.leq(frame));
+}
+
+TEST_F(FrameTest, FrameExtension) {
+  auto context = test::make_empty_context();
+
+  Scope scope;
+  auto* one = context.methods->create(
+      redex::create_void_method(scope, "LClass;", "one"));
+  auto* user_feature_one = context.features->get("UserFeatureOne");
+  auto* user_feature_two = context.features->get("UserFeatureTwo");
+
+  auto frame = test::make_frame(
+      /* kind */ context.kinds->get("TestSource"),
+      test::FrameProperties{.origins = MethodSet{one}});
+  EXPECT_TRUE(frame.field_origins().empty());
+  EXPECT_TRUE(frame.user_features().is_bottom());
+  EXPECT_EQ(frame.via_type_of_ports(), RootSetAbstractDomain());
+  EXPECT_EQ(frame.via_value_of_ports(), RootSetAbstractDomain());
+  EXPECT_EQ(frame.canonical_names(), CanonicalNameSetAbstractDomain());
+
+  // Clearing the rarely set fields gives back the original frame.
+  auto copy = frame;
+  copy.set_field_origins(FieldSet::bottom());
+  EXPECT_EQ(copy, frame);
+
+  auto with_features = test::make_frame(
+      /* kind */ context.kinds->get("TestSource"),
+      test::FrameProperties{
+          .origins = MethodSet{one},
+          .user_features = FeatureSet{user_feature_one},
+          .via_type_of_ports =
+              RootSetAbstractDomain({Root(Root::Kind::Argument, 0)})});
+  EXPECT_TRUE(frame.leq(with_features));
+  EXPECT_FALSE(with_features.leq(frame));
+  EXPECT_FALSE(with_features.equals(frame));
+
+  // Joining with a frame without rarely set fields keeps them.
+  auto joined = frame;
+  joined.join_with(with_features);
+  EXPECT_EQ(joined, with_features);
+  joined.join_with(frame);
+  EXPECT_EQ(joined, with_features);
+
+  auto with_other_features = test::make_frame(
+      /* kind */ context.kinds->get("TestSource"),
+      test::FrameProperties{
+          .origins = MethodSet{one},
+          .user_features = FeatureSet{user_feature_two},
+          .via_value_of_ports =
+              RootSetAbstractDomain({Root(Root::Kind::Argument, 1)})});
+  joined.join_with(with_other_features);
+  EXPECT_EQ(
+      joined,
+      test::make_frame(
+          /* kind */ context.kinds->get("TestSource"),
+          test::FrameProperties{
+              .origins = MethodSet{one},
+              .user_features = FeatureSet{user_feature_one, user_feature_two},
+              .via_type_of_ports =
+                  RootSetAbstractDomain({Root(Root::Kind::Argument, 0)}),
+              .via_value_of_ports =
+                  RootSetAbstractDomain({Root(Root::Kind::Argument, 1)})}));
+
+  // Copies share the rarely set fields without affecting each other.
+  copy = with_features;
+  copy.set_field_origins(FieldSet::bottom());
+  EXPECT_EQ(copy, with_features);
+  EXPECT_EQ(with_features.user_features(), FeatureSet{user_feature_one});
+}
+
 } // namespace marianatrench
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+
+#include <mariana-trench/FrozenModel.h>
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/Registry.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class FrozenModelTest : public test::Test {};
+
+TEST_F(FrozenModelTest, Thaw) {
+  auto context = test::make_empty_context();
+
+  Scope scope;
+  auto* method = context.methods->create(redex::create_void_method(
+      scope,
+      /* class_name */ "LOne;",
+      /* method_name */ "one",
+      /* parameter_types */ "II",
+      /* return_type */ "LData;"));
+  auto* callee = context.methods->create(redex::create_void_method(
+      scope,
+      /* class_name */ "LTwo;",
+      /* method_name */ "two",
+      /* parameter_types */ "",
+      /* return_type */ "LData;"));
+
+  const auto* x = DexString::make_string("x");
+  auto* source_kind = context.kinds->get("TestSource");
+  auto* sink_kind = context.kinds->get("TestSink");
+  auto* feature = context.features->get("Feature");
+
+  auto model = Model(
+      method,
+      context,
+      Model::Mode::SkipAnalysis,
+      /* generations */
+      {{AccessPath(Root(Root::Kind::Return)), Frame::leaf(source_kind)},
+       {AccessPath(Root(Root::Kind::Return), Path{x}),
+        test::make_frame(
+            source_kind,
+            test::FrameProperties{
+                .callee_port = AccessPath(Root(Root::Kind::Return)),
+                .callee = callee,
+                .call_position = context.positions->get("One.java", 1),
+                .distance = 1,
+                .origins = MethodSet{callee},
+                .inferred_features = FeatureMayAlwaysSet{feature}})}},
+      /* parameter_sources */
+      {{AccessPath(Root(Root::Kind::Argument, 1)), Frame::leaf(source_kind)}},
+      /* sinks */
+      {{AccessPath(Root(Root::Kind::Argument, 1)), Frame::leaf(sink_kind)},
+       {AccessPath(Root(Root::Kind::Argument, 2)), Frame::leaf(sink_kind)}},
+      /* propagations */
+      {{Propagation(
+            /* input */ AccessPath(Root(Root::Kind::Argument, 1)),
+            /* inferred_features */ FeatureMayAlwaysSet::bottom(),
+            /* user_features */ FeatureSet::bottom()),
+        /* output */ AccessPath(Root(Root::Kind::Return))}});
+
+  auto frozen = FrozenModel(model);
+  EXPECT_EQ(frozen.method(), method);
+  EXPECT_TRUE(frozen.skip_analysis());
+  EXPECT_EQ(frozen.frames_size(), 5);
+  EXPECT_EQ(frozen.thaw(), model);
+  EXPECT_EQ(frozen.to_json(context), model.to_json(context));
+
+  auto empty = Model(method, context);
+  EXPECT_EQ(FrozenModel(empty).frames_size(), 0);
+  EXPECT_EQ(FrozenModel(empty).thaw(), empty);
+}
+
+TEST_F(FrozenModelTest, RegistryThawOnWrite) {
+  auto context = test::make_empty_context();
+
+  Scope scope;
+  auto* method = context.methods->create(redex::create_void_method(
+      scope,
+      /* class_name */ "LOne;",
+      /* method_name */ "one",
+      /* parameter_types */ "I",
+      /* return_type */ "V"));
+  auto* sink_kind = context.kinds->get("TestSink");
+
+  auto model = Model(
+      method,
+      context,
+      Model::Mode::Normal,
+      /* generations */ {},
+      /* parameter_sources */ {},
+      /* sinks */
+      {{AccessPath(Root(Root::Kind::Argument, 0)), Frame::leaf(sink_kind)}});
+
+  auto registry = Registry(
+      context,
+      std::vector<Model>{model},
+      /* field_models */ std::vector<FieldModel>{});
+  registry.freeze(method);
+  EXPECT_EQ(registry.get(method), model);
+  EXPECT_EQ(registry.models_size(), 1);
+
+  registry.update(method, [&](Model& model) {
+    model.add_sink(
+        AccessPath(Root(Root::Kind::Argument, 1)), Frame::leaf(sink_kind));
+    return true;
+  });
+  model.add_sink(
+      AccessPath(Root(Root::Kind::Argument, 1)), Frame::leaf(sink_kind));
+  EXPECT_EQ(registry.get(method), model);
+
+  registry.freeze_all();
+  EXPECT_EQ(registry.get(method), model);
+  EXPECT_EQ(registry.models_to_json()["models"][0], model.to_json(context));
+}
+
+} // namespace marianatrench
@@ -10,6 +10,7 @@
 #include <mariana-trench/FulfilledPartialKindState.h>
 #include <mariana-trench/MultiSourceMultiSinkRule.h>
 #include <mariana-trench/Redex.h>
+#include <mariana-trench/Rules.h>
 #include <mariana-trench/tests/Test.h>
 
 namespace marianatrench {
@@ -21,8 +22,8 @@ TEST_F(FulfilledPartialKindStateTest, Basic) {
   DexStore store("stores");
   store.add_classes(scope);
   auto context = test::make_context(store);
+  context.rules = std::make_unique<Rules>();
 
-  // Make method context.
   auto registry = Registry(context);
   auto* dex_method = redex::create_void_method(
       scope,
@@ -33,9 +34,6 @@ TEST_F(FulfilledPartialKindStateTest, Basic) {
       /* super */ nullptr);
   auto* method = context.methods->create(dex_method);
   auto model = Model(/* method */ method, context);
-  auto method_context = MethodContext(context, registry, model);
-
-  auto state = FulfilledPartialKindState();
 
   const auto feature_1 = context.features->get("Feature1");
   const auto feature_2 = context.features->get("Feature2");
@@ -53,6 +51,8 @@ TEST_F(FulfilledPartialKindStateTest, Basic) {
           {"a", Rule::KindSet{source_1}}, {"b", Rule::KindSet{source_2}}},
       /* partial_sink_kinds */
       MultiSourceMultiSinkRule::PartialKindSet{fulfilled, unfulfilled});
+  const auto* rule_1_pointer = rule_1.get();
+  context.rules->add(context, std::move(rule_1));
 
   // Exactly the same rule, but different code.
   auto rule_2 = std::make_unique<MultiSourceMultiSinkRule>(
@@ -64,6 +64,34 @@ TEST_F(FulfilledPartialKindStateTest, Basic) {
           {"a", Rule::KindSet{source_1}}, {"b", Rule::KindSet{source_2}}},
       /* partial_sink_kinds */
       MultiSourceMultiSinkRule::PartialKindSet{fulfilled, unfulfilled});
+  const auto* rule_2_pointer = rule_2.get();
+  context.rules->add(context, std::move(rule_2));
+
+  auto partial_kind_rule = [&](const PartialKind* kind,
+                               const MultiSourceMultiSinkRule* rule) {
+    for (const auto* partial_kind_rule :
+         context.rules->partial_kind_rules(kind)) {
+      if (partial_kind_rule->rule == rule) {
+        return partial_kind_rule;
+      }
+    }
+    mt_unreachable();
+  };
+  const auto* fulfilled_rule_1 = partial_kind_rule(fulfilled, rule_1_pointer);
+  const auto* fulfilled_rule_2 = partial_kind_rule(fulfilled, rule_2_pointer);
+  const auto* unfulfilled_rule_1 =
+      partial_kind_rule(unfulfilled, rule_1_pointer);
+  const auto* unfulfilled_rule_2 =
+      partial_kind_rule(unfulfilled, rule_2_pointer);
+  EXPECT_EQ(
+      unfulfilled_rule_1->triggered_kind,
+      context.kinds->get_triggered(unfulfilled, rule_1_pointer));
+  EXPECT_EQ(unfulfilled_rule_1->counterpart_id, fulfilled_rule_1->id);
+  EXPECT_EQ(fulfilled_rule_1->counterpart_id, unfulfilled_rule_1->id);
+
+  // Make method context.
+  auto method_context = MethodContext(context, registry, model);
+  auto state = FulfilledPartialKindState();
 
   auto sink_frame = test::make_frame(
       /* kind */ fulfilled, test::FrameProperties{});
@@ -73,44 +101,48 @@ TEST_F(FulfilledPartialKindStateTest, Basic) {
   EXPECT_EQ(
       std::nullopt,
       state.fulfill_kind(
-          /* kind */ fulfilled,
-          /* rule */ rule_1.get(),
+          /* partial_kind_rule */ fulfilled_rule_1,
           /* features */ FeatureMayAlwaysSet{feature_1},
           /* context */ &method_context,
           /* sink */ Taint{sink_frame}));
   EXPECT_EQ(
-      FeatureMayAlwaysSet{feature_1},
-      state.get_features(fulfilled, rule_1.get()));
+      FeatureMayAlwaysSet{feature_1}, state.get_features(fulfilled_rule_1));
   EXPECT_EQ(
-      fulfilled, state.get_fulfilled_counterpart(unfulfilled, rule_1.get()));
+      fulfilled_rule_1,
+      state.get_fulfilled_counterpart(&method_context, unfulfilled_rule_1));
   EXPECT_EQ(
-      nullptr, state.get_fulfilled_counterpart(unfulfilled, rule_2.get()));
+      nullptr,
+      state.get_fulfilled_counterpart(&method_context, unfulfilled_rule_2));
 
   // Get triggered counterparts for the unfulfilled kind in rule_1.
   EXPECT_THAT(
       state.make_triggered_counterparts(&method_context, unfulfilled),
       testing::UnorderedElementsAre(
-          context.kinds->get_triggered(unfulfilled, rule_1.get())));
+          context.kinds->get_triggered(unfulfilled, rule_1_pointer)));
+  EXPECT_EQ(
+      FeatureMayAlwaysSet{feature_1},
+      state.get_counterpart_features(
+          &method_context, unfulfilled_rule_1->triggered_kind));
 
   // Fulfill `fulfilled` under rule_2 as well.
   EXPECT_EQ(
       std::nullopt,
       state.fulfill_kind(
-          /* kind */ fulfilled,
-          /* rule */ rule_2.get(),
+          /* partial_kind_rule */ fulfilled_rule_2,
           /* features */ FeatureMayAlwaysSet{},
           /* context */ &method_context,
           /* sink */ Taint{sink_frame}));
-  EXPECT_EQ(FeatureMayAlwaysSet{}, state.get_features(fulfilled, rule_2.get()));
+  EXPECT_EQ(FeatureMayAlwaysSet{}, state.get_features(fulfilled_rule_2));
   EXPECT_EQ(
-      fulfilled, state.get_fulfilled_counterpart(unfulfilled, rule_2.get()));
+      fulfilled_rule_2,
+      state.get_fulfilled_counterpart(&method_context, unfulfilled_rule_2));
 
   // Triggered counterparts now includes rule_2
   EXPECT_THAT(
       state.make_triggered_counterparts(&method_context, unfulfilled),
       testing::UnorderedElementsAre(
-          context.kinds->get_triggered(unfulfilled, rule_1.get()),
-          context.kinds->get_triggered(unfulfilled, rule_2.get())));
+          context.kinds->get_triggered(unfulfilled, rule_1_pointer),
+          context.kinds->get_triggered(unfulfilled, rule_2_pointer)));
 
   // Fulfill the other part of rule_1.
   auto unfulfilled_sink_frame = test::make_frame(
@@ -120,14 +152,13 @@ TEST_F(FulfilledPartialKindStateTest, Basic) {
   EXPECT_EQ(
       state
           .fulfill_kind(
-              /* kind */ unfulfilled,
-              /* rule */ rule_1.get(),
+              /* partial_kind_rule */ unfulfilled_rule_1,
               /* features */ FeatureMayAlwaysSet{},
               /* context */ &method_context,
               /* sink */ Taint{unfulfilled_sink_frame})
           .value(),
       Taint{test::make_frame(
-          /* kind */ context.kinds->get_triggered(unfulfilled, rule_1.get()),
+          /* kind */ context.kinds->get_triggered(unfulfilled, rule_1_pointer),
           test::FrameProperties{
               .inferred_features = FeatureMayAlwaysSet{feature_2},
               .locally_inferred_features = FeatureMayAlwaysSet{feature_1}})});
@@ -136,7 +167,7 @@ TEST_F(FulfilledPartialKindStateTest, Basic) {
   EXPECT_THAT(
       state.make_triggered_counterparts(&method_context, unfulfilled),
       testing::UnorderedElementsAre(
-          context.kinds->get_triggered(unfulfilled, rule_2.get())));
+          context.kinds->get_triggered(unfulfilled, rule_2_pointer)));
 }
 
 } // namespace marianatrench
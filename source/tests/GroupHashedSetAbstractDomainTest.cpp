@@ -7,75 +7,54 @@
 
 #include <gtest/gtest.h>
 
-#include <PatriciaTreeSet.h>
-
 #include <mariana-trench/GroupHashedSetAbstractDomain.h>
+#include <mariana-trench/PersistentGroupHashedSetAbstractDomain.h>
+#include <mariana-trench/tests/GroupHashedSetElement.h>
 #include <mariana-trench/tests/Test.h>
 
 namespace marianatrench {
 
-class GroupHashedSetAbstractDomainTest : public test::Test {};
-
 namespace {
 
-using IntSet = sparta::PatriciaTreeSet<unsigned>;
-
-struct Element {
-  int group;
-  IntSet values;
-
-  bool is_bottom() const {
-    return values.empty();
-  }
-
-  void set_to_bottom() {
-    values.clear();
-  }
-
-  bool operator==(const Element& other) const {
-    return group == other.group && values == other.values;
-  }
-
-  bool leq(const Element& other) const {
-    return group == other.group && values.is_subset_of(other.values);
-  }
-
-  void join_with(const Element& other) {
-    values.union_with(other.values);
-  }
-
-  struct GroupHash {
-    std::size_t operator()(const Element& element) const {
-      return element.group;
-    }
-  };
+using Element = test::GroupHashedSetElement;
+using IntSet = Element::IntSet;
 
-  struct GroupEqual {
-    bool operator()(const Element& left, const Element& right) const {
-      return left.group == right.group;
-    }
-  };
+using GroupHashedSetT = GroupHashedSetAbstractDomain<
+    Element,
+    Element::GroupHash,
+    Element::GroupEqual>;
 
-  friend std::ostream& operator<<(std::ostream& o, const Element& element) {
-    return o << "Element(group=" << element.group
-             << ", values=" << element.values << ")";
-  }
-};
+using PersistentGroupHashedSetT = PersistentGroupHashedSetAbstractDomain<
+    Element,
+    Element::GroupHash,
+    Element::GroupEqual>;
 
-using AbstractDomainT = GroupHashedSetAbstractDomain<
+using FlatAbstractDomainT = FlatGroupHashedSetAbstractDomain<
     Element,
     Element::GroupHash,
     Element::GroupEqual>;
 
 } // namespace
 
-TEST_F(GroupHashedSetAbstractDomainTest, DefaultConstructor) {
+/* Both domains implement the same abstract domain. */
+template <typename AbstractDomain>
+class GroupHashedSetAbstractDomainTest : public test::Test {};
+
+using GroupHashedSetAbstractDomains =
+    testing::Types<GroupHashedSetT, PersistentGroupHashedSetT>;
+TYPED_TEST_SUITE(
+    GroupHashedSetAbstractDomainTest,
+    GroupHashedSetAbstractDomains);
+
+TYPED_TEST(GroupHashedSetAbstractDomainTest, DefaultConstructor) {
+  using AbstractDomainT = TypeParam;
   EXPECT_TRUE(AbstractDomainT().is_bottom());
   EXPECT_TRUE(AbstractDomainT().empty());
   EXPECT_TRUE(AbstractDomainT().size() == 0);
 }
 
-TEST_F(GroupHashedSetAbstractDomainTest, Add) {
+TYPED_TEST(GroupHashedSetAbstractDomainTest, Add) {
+  using AbstractDomainT = TypeParam;
   auto domain =
       AbstractDomainT{Element{/* group */ 1, /* values */ IntSet{10}}};
 
@@ -123,7 +102,8 @@ TEST_F(GroupHashedSetAbstractDomainTest, Add) {
           Element{/* group */ 3, /* values */ IntSet{30}})));
 }
 
-TEST_F(GroupHashedSetAbstractDomainTest, LessOrEqual) {
+TYPED_TEST(GroupHashedSetAbstractDomainTest, LessOrEqual) {
+  using AbstractDomainT = TypeParam;
   EXPECT_TRUE(AbstractDomainT::bottom().leq(AbstractDomainT::bottom()));
   EXPECT_TRUE(AbstractDomainT().leq(AbstractDomainT::bottom()));
 
@@ -247,7 +227,8 @@ TEST_F(GroupHashedSetAbstractDomainTest, LessOrEqual) {
                    }));
 }
 
-TEST_F(GroupHashedSetAbstractDomainTest, Equals) {
+TYPED_TEST(GroupHashedSetAbstractDomainTest, Equals) {
+  using AbstractDomainT = TypeParam;
   EXPECT_TRUE(AbstractDomainT::bottom().equals(AbstractDomainT::bottom()));
   EXPECT_TRUE(AbstractDomainT().equals(AbstractDomainT::bottom()));
 
@@ -367,7 +348,8 @@ TEST_F(GroupHashedSetAbstractDomainTest, Equals) {
                    }));
 }
 
-TEST_F(GroupHashedSetAbstractDomainTest, JoinWith) {
+TYPED_TEST(GroupHashedSetAbstractDomainTest, JoinWith) {
+  using AbstractDomainT = TypeParam;
   auto domain =
       AbstractDomainT{Element{/* group */ 1, /* values */ IntSet{10}}};
 
@@ -459,7 +441,8 @@ TEST_F(GroupHashedSetAbstractDomainTest, JoinWith) {
           Element{/* group */ 3, /* values */ IntSet{20, 22}})));
 }
 
-TEST_F(GroupHashedSetAbstractDomainTest, Contains) {
+TYPED_TEST(GroupHashedSetAbstractDomainTest, Contains) {
+  using AbstractDomainT = TypeParam;
   EXPECT_TRUE(AbstractDomainT{}.contains(
       Element{/* group */ 1, /* values */ IntSet{}}));
   EXPECT_FALSE(AbstractDomainT{}.contains(
@@ -495,7 +478,8 @@ TEST_F(GroupHashedSetAbstractDomainTest, Contains) {
                    .contains(Element{/* group */ 2, /* values */ IntSet{11}}));
 }
 
-TEST_F(GroupHashedSetAbstractDomainTest, Remove) {
+TYPED_TEST(GroupHashedSetAbstractDomainTest, Remove) {
+  using AbstractDomainT = TypeParam;
   auto domain = AbstractDomainT{};
 
   domain.remove(Element{/* group */ 1, /* values */ IntSet{}});
@@ -549,7 +533,8 @@ TEST_F(GroupHashedSetAbstractDomainTest, Remove) {
           Element{/* group */ 3, /* values */ IntSet{11}}}));
 }
 
-TEST_F(GroupHashedSetAbstractDomainTest, Difference) {
+TYPED_TEST(GroupHashedSetAbstractDomainTest, Difference) {
+  using AbstractDomainT = TypeParam;
   auto domain = AbstractDomainT{};
   domain.difference_with(
       AbstractDomainT{Element{/* group */ 1, /* values */ IntSet{}}});
@@ -621,7 +606,8 @@ TEST_F(GroupHashedSetAbstractDomainTest, Difference) {
   EXPECT_EQ(domain, AbstractDomainT{});
 }
 
-TEST_F(GroupHashedSetAbstractDomainTest, Map) {
+TYPED_TEST(GroupHashedSetAbstractDomainTest, Map) {
+  using AbstractDomainT = TypeParam;
   auto domain = AbstractDomainT{};
 
   domain.map([](Element& element) { element.values.insert(20); });
@@ -656,7 +642,8 @@ TEST_F(GroupHashedSetAbstractDomainTest, Map) {
           Element{/* group */ 2, /* values */ IntSet{}}}));
 }
 
-TEST_F(GroupHashedSetAbstractDomainTest, Filter) {
+TYPED_TEST(GroupHashedSetAbstractDomainTest, Filter) {
+  using AbstractDomainT = TypeParam;
   auto domain = AbstractDomainT{};
 
   domain.filter([](const Element& element) { return element.group == 1; });
@@ -691,4 +678,96 @@ TEST_F(GroupHashedSetAbstractDomainTest, Filter) {
   EXPECT_EQ(domain, AbstractDomainT{});
 }
 
+class FlatGroupHashedSetAbstractDomainTest : public test::Test {};
+
+TEST_F(FlatGroupHashedSetAbstractDomainTest, AddRemove) {
+  auto domain = FlatAbstractDomainT{};
+  EXPECT_TRUE(domain.is_bottom());
+
+  domain.add(Element{/* group */ 1, /* values */ IntSet{}});
+  EXPECT_TRUE(domain.is_bottom());
+
+  domain.add(Element{/* group */ 1, /* values */ IntSet{10}});
+  domain.add(Element{/* group */ 2, /* values */ IntSet{20}});
+  domain.add(Element{/* group */ 1, /* values */ IntSet{12}});
+  EXPECT_THAT(
+      domain,
+      (testing::UnorderedElementsAre(
+          Element{/* group */ 1, /* values */ IntSet{10, 12}},
+          Element{/* group */ 2, /* values */ IntSet{20}})));
+  EXPECT_TRUE(domain.contains(Element{/* group */ 1, /* values */ IntSet{10}}));
+  EXPECT_FALSE(
+      domain.contains(Element{/* group */ 1, /* values */ IntSet{11}}));
+
+  domain.remove(Element{/* group */ 1, /* values */ IntSet{10, 12}});
+  EXPECT_THAT(
+      domain,
+      (testing::UnorderedElementsAre(
+          Element{/* group */ 2, /* values */ IntSet{20}})));
+}
+
+TEST_F(FlatGroupHashedSetAbstractDomainTest, LessOrEqualAndJoin) {
+  auto domain1 = FlatAbstractDomainT{
+      Element{/* group */ 1, /* values */ IntSet{11}},
+      Element{/* group */ 2, /* values */ IntSet{21}}};
+  auto domain2 = FlatAbstractDomainT{
+      Element{/* group */ 1, /* values */ IntSet{10, 11}},
+      Element{/* group */ 3, /* values */ IntSet{30}}};
+  EXPECT_TRUE(FlatAbstractDomainT::bottom().leq(domain1));
+  EXPECT_FALSE(domain1.leq(domain2));
+  EXPECT_FALSE(domain2.leq(domain1));
+
+  auto joined = domain1;
+  joined.join_with(domain2);
+  EXPECT_TRUE(domain1.leq(joined));
+  EXPECT_TRUE(domain2.leq(joined));
+  EXPECT_EQ(
+      joined,
+      (FlatAbstractDomainT{
+          Element{/* group */ 1, /* values */ IntSet{10, 11}},
+          Element{/* group */ 2, /* values */ IntSet{21}},
+          Element{/* group */ 3, /* values */ IntSet{30}}}));
+
+  // The copy is not affected by the join.
+  EXPECT_EQ(
+      domain1,
+      (FlatAbstractDomainT{
+          Element{/* group */ 1, /* values */ IntSet{11}},
+          Element{/* group */ 2, /* values */ IntSet{21}}}));
+
+  joined.difference_with(domain1);
+  EXPECT_EQ(
+      joined,
+      (FlatAbstractDomainT{
+          Element{/* group */ 1, /* values */ IntSet{10, 11}},
+          Element{/* group */ 3, /* values */ IntSet{30}}}));
+}
+
+TEST_F(FlatGroupHashedSetAbstractDomainTest, ManyGroups) {
+  // Grow past a single group of slots, then filter out most groups.
+  auto domain = FlatAbstractDomainT{};
+  auto expected = GroupHashedSetT{};
+  for (int group = 0; group < 200; group++) {
+    domain.add(Element{group, IntSet{static_cast<unsigned>(group)}});
+    expected.add(Element{group, IntSet{static_cast<unsigned>(group)}});
+  }
+  EXPECT_EQ(domain.size(), 200);
+  for (const auto& element : expected) {
+    EXPECT_TRUE(domain.contains(element));
+  }
+
+  domain.filter([](const Element& element) { return element.group % 10 == 0; });
+  EXPECT_EQ(domain.size(), 20);
+  for (int group = 0; group < 200; group++) {
+    EXPECT_EQ(
+        domain.contains(Element{group, IntSet{static_cast<unsigned>(group)}}),
+        group % 10 == 0);
+  }
+
+  domain.map([](Element& element) { element.values.insert(1000); });
+  domain.add(Element{/* group */ 5, /* values */ IntSet{5}});
+  EXPECT_EQ(domain.size(), 21);
+  EXPECT_TRUE(domain.contains(Element{/* group */ 10, IntSet{10, 1000}}));
+}
+
 } // namespace marianatrench
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+
+#include <PatriciaTreeSet.h>
+
+namespace marianatrench {
+namespace test {
+
+/**
+ * Element of the group hashed set domains in tests: a set of values that are
+ * joined when they belong to the same group.
+ */
+struct GroupHashedSetElement {
+  using IntSet = sparta::PatriciaTreeSet<unsigned>;
+
+  int group;
+  IntSet values;
+
+  bool is_bottom() const {
+    return values.empty();
+  }
+
+  void set_to_bottom() {
+    values.clear();
+  }
+
+  bool operator==(const GroupHashedSetElement& other) const {
+    return group == other.group && values == other.values;
+  }
+
+  bool leq(const GroupHashedSetElement& other) const {
+    return group == other.group && values.is_subset_of(other.values);
+  }
+
+  void join_with(const GroupHashedSetElement& other) {
+    values.union_with(other.values);
+  }
+
+  struct GroupHash {
+    std::size_t operator()(const GroupHashedSetElement& element) const {
+      return element.group;
+    }
+  };
+
+  struct GroupEqual {
+    bool operator()(
+        const GroupHashedSetElement& left,
+        const GroupHashedSetElement& right) const {
+      return left.group == right.group;
+    }
+  };
+
+  friend std::ostream& operator<<(
+      std::ostream& o,
+      const GroupHashedSetElement& element) {
+    return o << "Element(group=" << element.group
+             << ", values=" << element.values << ")";
+  }
+};
+
+} // namespace test
+} // namespace marianatrench
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <mariana-trench/Heuristics.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class HeuristicsTest : public test::Test {};
+
+TEST_F(HeuristicsTest, PrecisionLevelForMemoryUsage) {
+  EXPECT_EQ(Heuristics::precision_level_for_memory_usage(0.0), 0);
+  EXPECT_EQ(Heuristics::precision_level_for_memory_usage(0.5), 0);
+  EXPECT_EQ(Heuristics::precision_level_for_memory_usage(0.75), 1);
+  EXPECT_EQ(Heuristics::precision_level_for_memory_usage(0.85), 2);
+  EXPECT_EQ(Heuristics::precision_level_for_memory_usage(0.95), 3);
+  EXPECT_EQ(Heuristics::precision_level_for_memory_usage(2.0), 3);
+}
+
+TEST_F(HeuristicsTest, PrecisionLimits) {
+  EXPECT_EQ(Heuristics::precision_level(), 0);
+  EXPECT_EQ(
+      Heuristics::abstract_tree_widening_height(),
+      Heuristics::kAbstractTreeWideningHeight);
+  EXPECT_EQ(
+      Heuristics::model_tree_max_leaves(), Heuristics::kModelTreeMaxLeaves);
+  EXPECT_EQ(Heuristics::join_override_threshold(), std::nullopt);
+
+  // Limits only get tighter.
+  for (std::size_t level = 1; level < Heuristics::kPrecisionLevels.size();
+       level++) {
+    const auto& previous = Heuristics::kPrecisionLevels[level - 1];
+    Heuristics::set_precision_level(level);
+    EXPECT_LT(
+        Heuristics::abstract_tree_widening_height(),
+        previous.abstract_tree_widening_height);
+    EXPECT_LT(
+        Heuristics::model_tree_max_leaves(), previous.model_tree_max_leaves);
+    EXPECT_TRUE(Heuristics::join_override_threshold().has_value());
+    if (previous.join_override_threshold) {
+      EXPECT_LT(
+          *Heuristics::join_override_threshold(),
+          *previous.join_override_threshold);
+    }
+  }
+
+  Heuristics::set_precision_level(0);
+}
+
+} // namespace marianatrench
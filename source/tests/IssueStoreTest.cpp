@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <boost/filesystem.hpp>
+#include <gmock/gmock.h>
+
+#include <mariana-trench/IssueStore.h>
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/SourceSinkRule.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class IssueStoreTest : public test::Test {};
+
+TEST_F(IssueStoreTest, AppendAndSet) {
+  auto context = test::make_empty_context();
+
+  const auto* source_kind = context.kinds->get("TestSource");
+  const auto* sink_kind = context.kinds->get("TestSink");
+  const auto* other_sink_kind = context.kinds->get("OtherSink");
+  const auto* feature = context.features->get("FeatureOne");
+  const auto* other_feature = context.features->get("FeatureTwo");
+  const auto* user_feature = context.features->get("UserFeature");
+
+  SourceSinkRule rule_1("rule 1", 1, "description", {source_kind}, {sink_kind});
+  SourceSinkRule rule_2(
+      "rule 2", 2, "description", {source_kind}, {other_sink_kind});
+
+  const auto* position_1 = context.positions->get(std::nullopt, 1);
+  const auto* position_2 = context.positions->get(std::nullopt, 2);
+
+  Scope scope;
+  auto* one = context.methods->create(
+      redex::create_void_method(scope, "LClass;", "one"));
+  auto* two = context.methods->create(
+      redex::create_void_method(scope, "LOther;", "two"));
+  auto* three = context.methods->create(
+      redex::create_void_method(scope, "LThird;", "three"));
+
+  auto issue_1 = Issue(
+      /* source */ Taint{test::make_frame(
+          source_kind,
+          test::FrameProperties{
+              .callee_port = AccessPath(
+                  Root(Root::Kind::Argument, 1),
+                  Path{DexString::make_string("field")}),
+              .callee = two,
+              .call_position = position_2,
+              .distance = 2,
+              .origins = MethodSet{one, two},
+              .inferred_features = FeatureMayAlwaysSet(
+                  /* may */ FeatureSet{feature, other_feature},
+                  /* always */ FeatureSet{feature}),
+              .locally_inferred_features =
+                  FeatureMayAlwaysSet::make_may({other_feature}),
+              .user_features = FeatureSet{user_feature},
+              .via_type_of_ports =
+                  RootSetAbstractDomain{Root(Root::Kind::Argument, 0)},
+              .local_positions = LocalPositionSet{position_1, position_2},
+              .canonical_names = CanonicalNameSetAbstractDomain{CanonicalName(
+                  CanonicalName::TemplateValue{"%programmatic_leaf_name%"})},
+          })},
+      /* sink */ Taint{Frame::leaf(sink_kind)},
+      &rule_1,
+      position_1);
+  auto issue_2 = Issue(
+      /* source */ Taint{test::make_frame(
+          source_kind,
+          test::FrameProperties{
+              .origins = MethodSet::top(),
+              .field_origins = FieldSet::top(),
+              .local_positions = LocalPositionSet::top(),
+          })},
+      /* sink */
+      Taint{test::make_frame(
+          other_sink_kind,
+          test::FrameProperties{
+              .callee_port = AccessPath(Root(Root::Kind::Return)),
+              .callee = three,
+              .call_position = position_2,
+              .distance = 1,
+              .origins = MethodSet{three},
+              .via_value_of_ports =
+                  RootSetAbstractDomain{Root(Root::Kind::Argument, 2)},
+              .canonical_names = CanonicalNameSetAbstractDomain{CanonicalName(
+                  CanonicalName::InstantiatedValue{"LThird;.three"})},
+          })},
+      &rule_2,
+      position_2);
+
+  auto directory = boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path();
+  boost::filesystem::create_directories(directory);
+  {
+    auto store = IssueStore(directory / "issue-store.bin");
+    EXPECT_EQ(store.get(one), IssueSet{});
+    EXPECT_TRUE(store.methods().empty());
+
+    // Issues round-trip through the store.
+    store.append(one, IssueSet{issue_1});
+    EXPECT_EQ(store.get(one), IssueSet{issue_1});
+    EXPECT_EQ(store.get(two), IssueSet{});
+
+    // The issues of a method are the join of its records.
+    store.append(one, IssueSet{issue_2});
+    store.append(two, IssueSet{issue_2});
+    EXPECT_EQ(store.get(one), (IssueSet{issue_1, issue_2}));
+    EXPECT_EQ(store.get(two), IssueSet{issue_2});
+    EXPECT_THAT(store.methods(), testing::UnorderedElementsAre(one, two));
+    EXPECT_EQ(store.records_size(), 3);
+
+    // Setting the issues replaces all the records of the method.
+    store.set(one, IssueSet{issue_2});
+    EXPECT_EQ(store.get(one), IssueSet{issue_2});
+    EXPECT_EQ(store.get(two), IssueSet{issue_2});
+
+    store.set(two, IssueSet{});
+    EXPECT_EQ(store.get(two), IssueSet{});
+    EXPECT_THAT(store.methods(), testing::UnorderedElementsAre(one));
+
+    // Appending nothing does not write a record.
+    store.append(three, IssueSet{});
+    EXPECT_EQ(store.records_size(), 4);
+  }
+  EXPECT_TRUE(boost::filesystem::is_empty(directory));
+  boost::filesystem::remove_all(directory);
+}
+
+} // namespace marianatrench
@@ -846,6 +846,29 @@ TEST_F(JsonTest, Frame) {
               .inferred_features = FeatureMayAlwaysSet::bottom(),
               .locally_inferred_features = FeatureMayAlwaysSet::bottom()}),
       context);
+  EXPECT_JSON_EQ(
+      Frame,
+      R"({
+        "kind": "TestSource",
+        "callee_port": "Leaf",
+        "origins": [],
+        "collapsed_origins": true
+      })",
+      test::make_frame(
+          /* kind */ context.kinds->get("TestSource"),
+          test::FrameProperties{
+              .origins = MethodSet::top(),
+              .inferred_features = FeatureMayAlwaysSet::bottom(),
+              .locally_inferred_features = FeatureMayAlwaysSet::bottom()}),
+      context);
+  EXPECT_THROW(
+      Frame::from_json(
+          test::parse_json(R"({
+            "kind": "TestSource",
+            "collapsed_origins": "true"
+          })"),
+          context),
+      JsonValidationError);
 
   // Parse the field origins
   EXPECT_THROW(
@@ -1670,6 +1693,24 @@ TEST_F(JsonTest, Model) {
         ]
       })#"));
 
+  // Models with collapsed origins can be read back.
+  auto model_with_collapsed_origins = Model(
+      method,
+      context,
+      Model::Mode::Normal,
+      /* generations */
+      {{AccessPath(Root(Root::Kind::Return)),
+        test::make_frame(
+            /* kind */ context.kinds->get("source_kind"),
+            test::FrameProperties{
+                .origins = MethodSet::top(),
+                .inferred_features = FeatureMayAlwaysSet::bottom(),
+                .locally_inferred_features =
+                    FeatureMayAlwaysSet::bottom()})}});
+  EXPECT_EQ(
+      Model::from_json(method, model_with_collapsed_origins.to_json(), context),
+      model_with_collapsed_origins);
+
   EXPECT_THROW(
       Model::from_json(
           method, test::parse_json(R"({"parameter_sources": {}})"), context),
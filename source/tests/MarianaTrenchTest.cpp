@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+#include <gtest/gtest.h>
+
+#include <mariana-trench/MarianaTrench.h>
+#include <mariana-trench/Options.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class MarianaTrenchTest : public test::Test {};
+
+namespace program_options = boost::program_options;
+
+namespace {
+
+program_options::options_description test_description() {
+  program_options::options_description description;
+  description.add_options()(
+      "rules-paths", program_options::value<std::string>())(
+      "verbosity", program_options::value<int>()->default_value(1))(
+      "sequential", program_options::bool_switch());
+  return description;
+}
+
+program_options::variables_map parse(
+    const program_options::options_description& description,
+    const std::vector<std::string>& arguments) {
+  program_options::variables_map variables;
+  program_options::store(
+      program_options::command_line_parser(arguments)
+          .options(description)
+          .run(),
+      variables);
+  program_options::notify(variables);
+  return variables;
+}
+
+std::unique_ptr<Options> make_options(
+    const std::vector<std::string>& lifecycles_paths,
+    bool remove_unreachable_code,
+    const std::string& source_root_directory) {
+  return std::make_unique<Options>(
+      /* models_paths */ std::vector<std::string>{},
+      /* field_models_path */ std::vector<std::string>{},
+      /* rules_paths */ std::vector<std::string>{},
+      lifecycles_paths,
+      /* proguard_configuration_paths */ std::vector<std::string>{},
+      /* sequential */ false,
+      /* skip_source_indexing */ true,
+      /* skip_model_generation */ true,
+      /* model_generators_configuration */
+      std::vector<ModelGeneratorConfiguration>{},
+      /* model_generators_search_path */ std::vector<std::string>{},
+      remove_unreachable_code,
+      source_root_directory);
+}
+
+} // namespace
+
+TEST_F(MarianaTrenchTest, ParseRequestArguments) {
+  auto description = test_description();
+  auto initial_variables = parse(
+      description,
+      {"--rules-paths", "initial.json", "--verbosity", "3", "--sequential"});
+
+  // Options that are not given keep their initial value.
+  auto variables = MarianaTrench::parse_request_arguments(
+      description, initial_variables, /* arguments */ {});
+  EXPECT_EQ(variables["rules-paths"].as<std::string>(), "initial.json");
+  EXPECT_EQ(variables["verbosity"].as<int>(), 3);
+  EXPECT_FALSE(variables["verbosity"].defaulted());
+  EXPECT_TRUE(variables["sequential"].as<bool>());
+
+  // Options given in the request override the initial value.
+  variables = MarianaTrench::parse_request_arguments(
+      description,
+      initial_variables,
+      {"--rules-paths", "request.json", "--verbosity", "2"});
+  EXPECT_EQ(variables["rules-paths"].as<std::string>(), "request.json");
+  EXPECT_EQ(variables["verbosity"].as<int>(), 2);
+  EXPECT_TRUE(variables["sequential"].as<bool>());
+
+  // Default values do not override values given when starting the daemon.
+  auto default_variables = parse(description, {});
+  EXPECT_TRUE(default_variables["verbosity"].defaulted());
+  variables = MarianaTrench::parse_request_arguments(
+      description, default_variables, {"--verbosity", "4"});
+  EXPECT_EQ(variables["verbosity"].as<int>(), 4);
+  EXPECT_EQ(variables.count("rules-paths"), 0);
+  EXPECT_FALSE(variables["sequential"].as<bool>());
+
+  EXPECT_THROW(
+      MarianaTrench::parse_request_arguments(
+          description, initial_variables, {"--unknown-option"}),
+      program_options::error);
+}
+
+TEST_F(MarianaTrenchTest, ChangedProgramOption) {
+  auto initial = make_options(
+      /* lifecycles_paths */ {"lifecycles.json"},
+      /* remove_unreachable_code */ false,
+      /* source_root_directory */ ".");
+
+  EXPECT_EQ(
+      MarianaTrench::changed_program_option(
+          *initial,
+          *make_options(
+              /* lifecycles_paths */ {"lifecycles.json"},
+              /* remove_unreachable_code */ false,
+              /* source_root_directory */ ".")),
+      std::nullopt);
+  EXPECT_EQ(
+      MarianaTrench::changed_program_option(
+          *initial,
+          *make_options(
+              /* lifecycles_paths */ {},
+              /* remove_unreachable_code */ false,
+              /* source_root_directory */ ".")),
+      "lifecycles-paths");
+  EXPECT_EQ(
+      MarianaTrench::changed_program_option(
+          *initial,
+          *make_options(
+              /* lifecycles_paths */ {"lifecycles.json"},
+              /* remove_unreachable_code */ true,
+              /* source_root_directory */ ".")),
+      "remove-unreachable-code");
+  EXPECT_EQ(
+      MarianaTrench::changed_program_option(
+          *initial,
+          *make_options(
+              /* lifecycles_paths */ {"lifecycles.json"},
+              /* remove_unreachable_code */ false,
+              /* source_root_directory */ "other")),
+      "source-root-directory");
+}
+
+} // namespace marianatrench
@@ -5,11 +5,13 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <fmt/format.h>
 #include <gmock/gmock.h>
 
 #include <Show.h>
 #include <json/json.h>
 
+#include <mariana-trench/Heuristics.h>
 #include <mariana-trench/MethodSet.h>
 #include <mariana-trench/Redex.h>
 #include <mariana-trench/TaintTree.h>
@@ -169,4 +171,52 @@ TEST_F(MethodSetTest, Difference) {
   EXPECT_EQ(methods_top, MethodSet());
 }
 
+TEST_F(MethodSetTest, Collapse) {
+  Scope scope;
+  auto context = test::make_empty_context();
+  Heuristics::set_max_number_origins(Heuristics::kMaxNumberOrigins);
+
+  auto methods = MethodSet();
+  for (std::size_t i = 0; i < Heuristics::kMaxNumberOrigins; i++) {
+    methods.add(context.methods->create(redex::create_void_method(
+        scope, fmt::format("LClass{};", i), "method")));
+  }
+  EXPECT_FALSE(methods.is_top());
+
+  auto* last = context.methods->create(
+      redex::create_void_method(scope, "LLast;", "method"));
+  auto joined = methods;
+  joined.join_with(MethodSet{last});
+  EXPECT_TRUE(joined.is_top());
+
+  methods.add(last);
+  EXPECT_TRUE(methods.is_top());
+  EXPECT_EQ(Heuristics::number_collapsed_origins(), 2);
+
+  // Without a maximum, sets are never collapsed.
+  Heuristics::set_max_number_origins(std::nullopt);
+  auto uncapped = MethodSet{last};
+  for (std::size_t i = 0; i < Heuristics::kMaxNumberOrigins; i++) {
+    uncapped.add(context.methods->create(redex::create_void_method(
+        scope, fmt::format("LClass{};", i), "method")));
+  }
+  EXPECT_FALSE(uncapped.is_top());
+  EXPECT_EQ(
+      std::distance(uncapped.begin(), uncapped.end()),
+      Heuristics::kMaxNumberOrigins + 1);
+  EXPECT_EQ(Heuristics::number_collapsed_origins(), 0);
+}
+
+TEST_F(MethodSetTest, Json) {
+  Scope scope;
+  auto context = test::make_empty_context();
+  auto* one = context.methods->create(
+      redex::create_void_method(scope, "LOne;", "one"));
+
+  EXPECT_EQ(
+      MethodSet::from_json(MethodSet{one}.to_json(), context),
+      MethodSet{one});
+  EXPECT_EQ(MethodSet::top().to_json(), Json::Value(Json::arrayValue));
+}
+
 } // namespace marianatrench
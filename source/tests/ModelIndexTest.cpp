@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+#include <gmock/gmock.h>
+
+#include <mariana-trench/JsonValidation.h>
+#include <mariana-trench/ModelIndex.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class ModelIndexTest : public test::Test {};
+
+namespace {
+
+void write_file(
+    const boost::filesystem::path& path,
+    const std::string& content) {
+  std::ofstream stream(path.string());
+  stream << content;
+}
+
+boost::filesystem::path make_output_directory() {
+  auto directory = boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path();
+  boost::filesystem::create_directories(directory);
+  return directory;
+}
+
+} // namespace
+
+TEST_F(ModelIndexTest, Queries) {
+  auto directory = make_output_directory();
+  auto index_path = directory / "model-index.bin";
+  write_file(
+      directory / "model@00000-of-00002.json",
+      "// @generated\n"
+      R"({"method": "LOne;.one:()V", "sinks": [{"port": "Argument(0)", "taint": [{"kind": "TestSink"}]}]})"
+      "\n"
+      R"({"method": {"name": "LTwo;.two:(LData;)V", "parameter_type_overrides": [{"parameter": 0, "type": "LOther;"}]}, "generations": [{"port": "Return", "taint": [{"kind": "TestSource"}]}]})"
+      "\n");
+  write_file(
+      directory / "model@00001-of-00002.json",
+      "// @generated\n"
+      R"({"method": "LOne;.three:()V", "issues": [{"rule": 1, "sinks": [{"kind": "TestSink"}]}], "sinks": [{"port": "Argument(1)", "taint": [{"kind": "TestSink"}]}]})"
+      "\n");
+  write_file(
+      directory / "issues@00000-of-00001.json",
+      "// @generated\n"
+      R"({"method": "LOne;.four:()V", "issues": [{"rule": 2}, {"rule": 1}]})"
+      "\n");
+
+  EXPECT_EQ(ModelIndex::open(directory, index_path), nullptr);
+  ModelIndex::build(directory, index_path);
+  auto index = ModelIndex::open(directory, index_path);
+  ASSERT_NE(index, nullptr);
+
+  EXPECT_EQ(index->size(), 3);
+  EXPECT_EQ(index->name(0), "LOne;.one:()V");
+  EXPECT_EQ(index->name(1), "LOne;.three:()V");
+  EXPECT_EQ(index->name(2), "LTwo;.two:(LData;)V[0: LOther;]");
+
+  auto model = index->model("LOne;.one:()V");
+  ASSERT_TRUE(model.has_value());
+  EXPECT_EQ(
+      JsonValidation::parse_json(std::string(*model))["method"].asString(),
+      "LOne;.one:()V");
+  EXPECT_FALSE(index->model("LOne;.four:()V").has_value());
+
+  EXPECT_THAT(
+      index->names_matching("LOne;"),
+      testing::ElementsAre("LOne;.one:()V", "LOne;.three:()V"));
+  EXPECT_THROW(index->names_matching("("), std::invalid_argument);
+
+  EXPECT_THAT(
+      index->names_with_kind("TestSink"),
+      testing::ElementsAre("LOne;.one:()V", "LOne;.three:()V"));
+  EXPECT_THAT(
+      index->names_with_kind("TestSource"),
+      testing::ElementsAre("LTwo;.two:(LData;)V[0: LOther;]"));
+  EXPECT_TRUE(index->names_with_kind("OtherSource").empty());
+
+  auto issues = index->issues(1);
+  ASSERT_EQ(issues.size(), 2);
+  EXPECT_EQ(issues[0]["method"].asString(), "LOne;.four:()V");
+  EXPECT_EQ(issues[1]["method"].asString(), "LOne;.three:()V");
+  EXPECT_EQ(index->issues(2).size(), 1);
+  EXPECT_TRUE(index->issues(3).empty());
+
+  // The index is outdated once a shard changes.
+  index = nullptr;
+  write_file(
+      directory / "issues@00000-of-00001.json",
+      "// @generated\n"
+      R"({"method": "LOne;.four:()V", "issues": [{"rule": 2}]})"
+      "\n");
+  EXPECT_EQ(ModelIndex::open(directory, index_path), nullptr);
+
+  // Only the size and modification time of shards are checked.
+  ModelIndex::build(directory, index_path);
+  auto shard_path = directory / "issues@00000-of-00001.json";
+  EXPECT_NE(ModelIndex::open(directory, index_path), nullptr);
+  auto modification_time = boost::filesystem::last_write_time(shard_path);
+  boost::filesystem::last_write_time(shard_path, modification_time - 10);
+  EXPECT_EQ(ModelIndex::open(directory, index_path), nullptr);
+
+  // Shards are only mapped when a line is read.
+  ModelIndex::build(directory, index_path);
+  index = ModelIndex::open(directory, index_path);
+  ASSERT_NE(index, nullptr);
+  boost::filesystem::remove(directory / "model@00001-of-00002.json");
+  EXPECT_EQ(index->issues(2).size(), 1);
+
+  boost::filesystem::remove_all(directory);
+}
+
+TEST_F(ModelIndexTest, Diff) {
+  auto left_directory = make_output_directory();
+  write_file(
+      left_directory / "model@00000-of-00001.json",
+      "// @generated\n"
+      R"({"method": "LOne;.one:()V", "sinks": [{"port": "Argument(0)", "taint": [{"kind": "A"}, {"kind": "B"}]}]})"
+      "\n"
+      R"({"method": "LOne;.two:()V", "modes": ["skip-analysis"]})"
+      "\n"
+      R"({"method": "LOne;.three:()V", "sinks": [{"port": "Argument(0)", "taint": [{"kind": "A"}]}]})"
+      "\n");
+  auto right_directory = make_output_directory();
+  write_file(
+      right_directory / "model@00000-of-00001.json",
+      "// @generated\n"
+      R"({"sinks": [{"taint": [{"kind": "B"}, {"kind": "A"}], "port": "Argument(0)"}], "method": "LOne;.one:()V"})"
+      "\n"
+      R"({"method": "LOne;.three:()V", "sinks": [{"port": "Argument(0)", "taint": [{"kind": "C"}]}], "modes": ["no-join-virtual-overrides"]})"
+      "\n"
+      R"({"method": "LOne;.four:()V"})"
+      "\n");
+
+  ModelIndex::build(left_directory, left_directory / "model-index.bin");
+  ModelIndex::build(right_directory, right_directory / "model-index.bin");
+  auto left =
+      ModelIndex::open(left_directory, left_directory / "model-index.bin");
+  auto right =
+      ModelIndex::open(right_directory, right_directory / "model-index.bin");
+  ASSERT_NE(left, nullptr);
+  ASSERT_NE(right, nullptr);
+
+  auto diff = ModelIndex::diff(*left, *right);
+  EXPECT_THAT(diff.added, testing::ElementsAre("LOne;.four:()V"));
+  EXPECT_THAT(diff.removed, testing::ElementsAre("LOne;.two:()V"));
+  ASSERT_EQ(diff.changed.size(), 1);
+  EXPECT_EQ(diff.changed[0].first, "LOne;.three:()V");
+  EXPECT_THAT(diff.changed[0].second, testing::ElementsAre("modes", "sinks"));
+
+  boost::filesystem::remove_all(left_directory);
+  boost::filesystem::remove_all(right_directory);
+}
+
+TEST_F(ModelIndexTest, Canonicalize) {
+  EXPECT_EQ(
+      ModelIndex::canonicalize(
+          test::parse_json(R"([{"b": [2, 1]}, {"a": 1}])")),
+      test::parse_json(R"([{"a": 1}, {"b": [1, 2]}])"));
+}
+
+} // namespace marianatrench
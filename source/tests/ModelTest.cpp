@@ -847,4 +847,33 @@ TEST_F(ModelTest, Join) {
                 SanitizerKind::Sinks, KindSetAbstractDomain::top()))}}));
 }
 
+TEST_F(ModelTest, ApproximateUnstable) {
+  auto context = test::make_empty_context();
+  const auto* source_kind = context.kinds->get("TestSource");
+  const auto* other_source_kind = context.kinds->get("OtherTestSource");
+  const auto* x = DexString::make_string("x");
+  const auto* y = DexString::make_string("y");
+
+  Model model(
+      /* method */ nullptr,
+      context,
+      /* modes */ Model::Mode::Normal,
+      /* generations */
+      {{AccessPath(Root(Root::Kind::Return), Path{x}),
+        Frame::leaf(source_kind)},
+       {AccessPath(Root(Root::Kind::Return), Path{y}),
+        Frame::leaf(other_source_kind)}});
+  auto previous = model;
+
+  model.approximate_unstable();
+  EXPECT_TRUE(previous.leq(model));
+
+  auto generations = model.generations().elements();
+  ASSERT_EQ(generations.size(), 1);
+  EXPECT_EQ(generations[0].first, AccessPath(Root(Root::Kind::Return)));
+  EXPECT_EQ(generations[0].second.num_frames(), 2);
+  EXPECT_TRUE(generations[0].second.local_positions().is_top());
+  EXPECT_TRUE(model.sinks().is_bottom());
+}
+
 } // namespace marianatrench
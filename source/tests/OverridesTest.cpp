@@ -7,6 +7,7 @@
 
 #include <gtest/gtest.h>
 
+#include <mariana-trench/JsonValidation.h>
 #include <mariana-trench/Overrides.h>
 #include <mariana-trench/Redex.h>
 #include <mariana-trench/tests/Test.h>
@@ -91,3 +92,32 @@ TEST_F(OverridesTest, Overrides) {
       testing::UnorderedElementsAre(indirect_override));
   EXPECT_TRUE(overrides.get(indirect_override).empty());
 }
+
+TEST_F(OverridesTest, FromJson) {
+  Scope scope;
+
+  auto* dex_callee = redex::create_void_method(scope, "LCallee;", "callee");
+  auto* dex_override = redex::create_void_method(
+      scope,
+      "LSubclass;",
+      "callee",
+      /* parameter_types */ "",
+      /* return_type */ "V",
+      /* super */ dex_callee->get_class());
+
+  auto context = test_overrides(scope);
+  auto* callee = context.methods->get(dex_callee);
+  auto* override = context.methods->get(dex_override);
+
+  auto overrides =
+      Overrides::from_json(context.overrides->to_json(), *context.methods);
+  EXPECT_THAT(
+      overrides->get(callee), testing::UnorderedElementsAre(override));
+  EXPECT_TRUE(overrides->get(override).empty());
+  EXPECT_EQ(overrides->to_json(), context.overrides->to_json());
+
+  EXPECT_THROW(
+      Overrides::from_json(
+          test::parse_json(R"({"LUnknown;.f:()V": []})"), *context.methods),
+      JsonValidationError);
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gtest/gtest.h>
+
+#include <mariana-trench/PersistentGroupHashedSetAbstractDomain.h>
+#include <mariana-trench/tests/GroupHashedSetElement.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+/**
+ * Tests of the persistent representation. The abstract domain operations are
+ * tested for all group hashed sets in `GroupHashedSetAbstractDomainTest`.
+ */
+class PersistentGroupHashedSetAbstractDomainTest : public test::Test {};
+
+namespace {
+
+using Element = test::GroupHashedSetElement;
+using IntSet = Element::IntSet;
+
+using AbstractDomainT = PersistentGroupHashedSetAbstractDomain<
+    Element,
+    Element::GroupHash,
+    Element::GroupEqual>;
+
+/* Groups with the same parity have the same hash. */
+struct CollidingGroupHash {
+  std::size_t operator()(const Element& element) const {
+    return element.group % 2;
+  }
+};
+
+using CollidingAbstractDomainT = PersistentGroupHashedSetAbstractDomain<
+    Element,
+    CollidingGroupHash,
+    Element::GroupEqual>;
+
+/* Hashes only differ in their highest bits, which creates deep tries. */
+struct HighBitsGroupHash {
+  std::size_t operator()(const Element& element) const {
+    return static_cast<std::size_t>(element.group) << 59;
+  }
+};
+
+using DeepAbstractDomainT = PersistentGroupHashedSetAbstractDomain<
+    Element,
+    HighBitsGroupHash,
+    Element::GroupEqual>;
+
+} // namespace
+
+TEST_F(PersistentGroupHashedSetAbstractDomainTest, Sharing) {
+  auto domain = AbstractDomainT{};
+  for (int group = 0; group < 100; group++) {
+    domain.add(Element{group, IntSet{static_cast<unsigned>(group)}});
+  }
+  EXPECT_EQ(domain.size(), 100);
+
+  auto copy = domain;
+  copy.add(Element{/* group */ 1, /* values */ IntSet{2}});
+  copy.add(Element{/* group */ 100, /* values */ IntSet{100}});
+  copy.remove(Element{/* group */ 2, /* values */ IntSet{2}});
+  EXPECT_EQ(copy.size(), 100);
+  EXPECT_TRUE(copy.contains(Element{/* group */ 1, /* values */ IntSet{1, 2}}));
+  EXPECT_FALSE(copy.contains(Element{/* group */ 2, /* values */ IntSet{2}}));
+
+  // The original set is not modified.
+  EXPECT_EQ(domain.size(), 100);
+  EXPECT_FALSE(
+      domain.contains(Element{/* group */ 1, /* values */ IntSet{1, 2}}));
+  EXPECT_TRUE(domain.contains(Element{/* group */ 2, /* values */ IntSet{2}}));
+  EXPECT_FALSE(
+      domain.contains(Element{/* group */ 100, /* values */ IntSet{100}}));
+
+  EXPECT_FALSE(copy.leq(domain));
+  EXPECT_FALSE(domain.leq(copy));
+  copy.join_with(domain);
+  EXPECT_TRUE(domain.leq(copy));
+  EXPECT_EQ(copy.size(), 101);
+
+  copy.difference_with(domain);
+  EXPECT_EQ(
+      copy,
+      (AbstractDomainT{
+          Element{/* group */ 1, /* values */ IntSet{1, 2}},
+          Element{/* group */ 100, /* values */ IntSet{100}}}));
+
+  // Building the same set in a different order gives an equal set.
+  auto reversed = AbstractDomainT{};
+  for (int group = 99; group >= 0; group--) {
+    reversed.add(Element{group, IntSet{static_cast<unsigned>(group)}});
+  }
+  EXPECT_EQ(reversed, domain);
+  EXPECT_TRUE(reversed.leq(domain));
+}
+
+TEST_F(PersistentGroupHashedSetAbstractDomainTest, Collisions) {
+  auto domain = CollidingAbstractDomainT{
+      Element{/* group */ 1, /* values */ IntSet{10}},
+      Element{/* group */ 2, /* values */ IntSet{20}},
+      Element{/* group */ 3, /* values */ IntSet{30}}};
+  EXPECT_EQ(domain.size(), 3);
+  EXPECT_THAT(
+      domain,
+      (testing::UnorderedElementsAre(
+          Element{/* group */ 1, /* values */ IntSet{10}},
+          Element{/* group */ 2, /* values */ IntSet{20}},
+          Element{/* group */ 3, /* values */ IntSet{30}})));
+
+  domain.add(Element{/* group */ 3, /* values */ IntSet{31}});
+  EXPECT_EQ(domain.size(), 3);
+  EXPECT_TRUE(
+      domain.contains(Element{/* group */ 3, /* values */ IntSet{30, 31}}));
+  EXPECT_FALSE(
+      domain.contains(Element{/* group */ 5, /* values */ IntSet{50}}));
+
+  domain.remove(Element{/* group */ 1, /* values */ IntSet{10}});
+  EXPECT_EQ(
+      domain,
+      (CollidingAbstractDomainT{
+          Element{/* group */ 2, /* values */ IntSet{20}},
+          Element{/* group */ 3, /* values */ IntSet{30, 31}}}));
+
+  domain.difference_with(CollidingAbstractDomainT{
+      Element{/* group */ 3, /* values */ IntSet{30, 31, 32}},
+      Element{/* group */ 5, /* values */ IntSet{50}}});
+  EXPECT_EQ(
+      domain,
+      (CollidingAbstractDomainT{
+          Element{/* group */ 2, /* values */ IntSet{20}}}));
+}
+
+TEST_F(PersistentGroupHashedSetAbstractDomainTest, DeepTrie) {
+  auto domain = DeepAbstractDomainT{};
+  for (int group = 0; group < 32; group++) {
+    domain.add(Element{group, IntSet{static_cast<unsigned>(group)}});
+  }
+  EXPECT_EQ(domain.size(), 32);
+
+  std::size_t size = 0;
+  for (const auto& element : domain) {
+    EXPECT_EQ(element.values, IntSet{static_cast<unsigned>(element.group)});
+    size++;
+  }
+  EXPECT_EQ(size, 32);
+
+  domain.filter([](const Element& element) { return element.group == 7; });
+  EXPECT_EQ(
+      domain,
+      (DeepAbstractDomainT{Element{/* group */ 7, /* values */ IntSet{7}}}));
+}
+
+} // namespace marianatrench
@@ -5,6 +5,9 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <fstream>
+
+#include <boost/filesystem.hpp>
 #include <gmock/gmock.h>
 
 #include <json/value.h>
@@ -15,7 +18,9 @@
 #include <mariana-trench/Fields.h>
 #include <mariana-trench/Model.h>
 #include <mariana-trench/Redex.h>
+#include <mariana-trench/JsonValidation.h>
 #include <mariana-trench/Registry.h>
+#include <mariana-trench/SourceSinkRule.h>
 #include <mariana-trench/Types.h>
 #include <mariana-trench/UnusedKinds.h>
 #include <mariana-trench/tests/Test.h>
@@ -41,10 +46,14 @@ TEST_F(RegistryTest, remove_kinds) {
       context.artificial_methods->models(
           context), // used to make sure we get ArrayAllocation
       /* generated_field_models */ {});
-  context.rules =
-      std::make_unique<Rules>(Rules::load(context, *context.options));
   auto old_model_json = JsonValidation::null_or_array(
       registry.models_to_json(), /* field */ "models");
+  EXPECT_TRUE(old_model_json[0].isMember("sinks"));
+  EXPECT_EQ(old_model_json[0]["sinks"][0]["kind"], "ArrayAllocation");
+
+  context.rules =
+      std::make_unique<Rules>(Rules::load(context, *context.options));
+  context.unused_kinds = std::make_unique<UnusedKinds>(*context.rules);
   auto unused_kinds = context.rules->collect_unused_kinds(*context.kinds);
   auto is_array_allocation = [](const Kind* kind) -> bool {
     const auto* named_kind = kind->as<NamedKind>();
@@ -54,13 +63,25 @@ TEST_F(RegistryTest, remove_kinds) {
       std::find_if(
           unused_kinds.begin(), unused_kinds.end(), is_array_allocation),
       unused_kinds.end());
-  EXPECT_TRUE(old_model_json[0].isMember("sinks"));
-  EXPECT_EQ(old_model_json[0]["sinks"][0]["kind"], "ArrayAllocation");
-  UnusedKinds::remove_unused_kinds(context, registry);
+
+  // Unused kinds are dropped when the models are created.
+  auto pruned_registry = Registry::load(
+      context,
+      *context.options,
+      /* generated_models */ context.artificial_methods->models(context),
+      /* generated_field_models */ {});
   auto new_model_json = JsonValidation::null_or_array(
-      registry.models_to_json(), /* field */ "models");
+      pruned_registry.models_to_json(), /* field */ "models");
   EXPECT_NE(new_model_json, old_model_json);
   EXPECT_FALSE(new_model_json[0].isMember("sinks"));
+
+  auto model = Model::from_json(
+      /* method */ nullptr,
+      test::parse_json(R"({
+        "sinks": [{"kind": "ArrayAllocation", "port": "Argument(0)"}]
+      })"),
+      context);
+  EXPECT_TRUE(model.sinks().is_bottom());
 }
 
 TEST_F(RegistryTest, JoinWith) {
@@ -246,4 +267,145 @@ TEST_F(RegistryTest, ConstructorUseJoin) {
                    .user_features = FeatureSet::bottom()})}));
 }
 
+TEST_F(RegistryTest, UpdateFrozen) {
+  auto context = test::make_empty_context();
+
+  Scope scope;
+  auto* method = context.methods->create(
+      redex::create_void_method(scope, "LClass;", "method"));
+  const auto* source_kind = context.kinds->get("TestSource");
+
+  auto registry = Registry(
+      context,
+      std::vector<Model>{Model(method, context)},
+      /* field_models */ std::vector<FieldModel>{});
+  registry.freeze(method);
+  EXPECT_TRUE(registry.is_frozen(method));
+
+  // Models are only thawed when they change.
+  EXPECT_FALSE(registry.update(method, [](Model& /* model */) {
+    return false;
+  }));
+  EXPECT_TRUE(registry.is_frozen(method));
+  EXPECT_EQ(registry.get(method), Model(method, context));
+
+  EXPECT_TRUE(registry.update(method, [&](Model& model) {
+    model.add_generation(
+        AccessPath(Root(Root::Kind::Return)), Frame::leaf(source_kind));
+    return true;
+  }));
+  EXPECT_FALSE(registry.is_frozen(method));
+  EXPECT_EQ(
+      registry.get(method),
+      Model(
+          method,
+          context,
+          Model::Mode::Normal,
+          /* generations */
+          {{AccessPath(Root(Root::Kind::Return)), Frame::leaf(source_kind)}}));
+}
+
+TEST_F(RegistryTest, ExportSummary) {
+  auto context = test::make_empty_context();
+
+  Scope scope;
+  auto* method = context.methods->create(
+      redex::create_void_method(scope, "LClass;", "method"));
+  const auto* source_kind = context.kinds->get("TestSource");
+
+  auto registry = Registry(
+      context,
+      std::vector<Model>{Model(method, context)},
+      /* field_models */ std::vector<FieldModel>{});
+
+  // The summary is computed once per version of the model.
+  auto summary = registry.export_summary(method);
+  EXPECT_EQ(summary->method(), method);
+  EXPECT_EQ(registry.export_summary(method), summary);
+
+  EXPECT_FALSE(registry.update(method, [](Model& /* model */) {
+    return false;
+  }));
+  EXPECT_EQ(registry.export_summary(method), summary);
+
+  EXPECT_TRUE(registry.update(method, [&](Model& model) {
+    model.add_generation(
+        AccessPath(Root(Root::Kind::Return)), Frame::leaf(source_kind));
+    return true;
+  }));
+  EXPECT_NE(registry.export_summary(method), summary);
+
+  summary = registry.export_summary(method);
+  registry.set(Model(method, context));
+  EXPECT_NE(registry.export_summary(method), summary);
+
+  summary = registry.export_summary(method);
+  registry.join_with(Model(method, context, Model::Mode::SkipAnalysis));
+  EXPECT_NE(registry.export_summary(method), summary);
+
+  // Frozen models do not keep a summary.
+  EXPECT_NE(registry.export_summary(method), nullptr);
+  registry.freeze(method);
+  EXPECT_EQ(registry.export_summary(method), nullptr);
+
+  EXPECT_TRUE(registry.update(method, [&](Model& model) {
+    model.add_generation(
+        AccessPath(Root(Root::Kind::Return)), Frame::leaf(source_kind));
+    return true;
+  }));
+  EXPECT_NE(registry.export_summary(method), nullptr);
+}
+
+TEST_F(RegistryTest, DumpIssues) {
+  auto context = test::make_empty_context();
+
+  Scope scope;
+  auto* method = context.methods->create(
+      redex::create_void_method(scope, "LClass;", "method"));
+  auto* other_method = context.methods->create(
+      redex::create_void_method(scope, "LOther;", "method"));
+
+  const auto* source_kind = context.kinds->get("TestSource");
+  const auto* sink_kind = context.kinds->get("TestSink");
+  SourceSinkRule rule("rule", 1, "description", {source_kind}, {sink_kind});
+
+  auto model = Model(method, context);
+  model.set_issues(IssueSet{Issue(
+      /* source */ Taint{Frame::leaf(source_kind)},
+      /* sink */ Taint{Frame::leaf(sink_kind)},
+      &rule,
+      context.positions->get(std::nullopt, 1))});
+  auto registry = Registry(
+      context,
+      std::vector<Model>{model, Model(other_method, context)},
+      /* field_models */ std::vector<FieldModel>{});
+  registry.freeze(method);
+  EXPECT_EQ(registry.issues_size(), 1);
+
+  auto directory = boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path();
+  boost::filesystem::create_directories(directory);
+  registry.dump_issues(directory);
+
+  EXPECT_EQ(registry.issues_size(), 1);
+  EXPECT_TRUE(registry.get(method).issues().is_bottom());
+  for (const auto& value : registry.models_to_json()["models"]) {
+    EXPECT_FALSE(value.isMember("issues"));
+  }
+
+  std::ifstream stream((directory / "issues@00000-of-00001.json").native());
+  ASSERT_TRUE(stream.is_open());
+  std::vector<std::string> lines;
+  for (std::string line; std::getline(stream, line);) {
+    lines.push_back(line);
+  }
+  ASSERT_EQ(lines.size(), 2);
+  EXPECT_EQ(lines[0], "// @" "generated");
+  auto value = JsonValidation::parse_json(lines[1]);
+  EXPECT_EQ(value["method"], method->to_json());
+  EXPECT_EQ(value["issues"], model.to_json()["issues"]);
+
+  boost::filesystem::remove_all(directory);
+}
+
 } // namespace marianatrench
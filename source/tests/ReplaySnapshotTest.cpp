@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+
+#include <mariana-trench/ClassProperties.h>
+#include <mariana-trench/Dependencies.h>
+#include <mariana-trench/Interprocedural.h>
+#include <mariana-trench/JsonValidation.h>
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/Registry.h>
+#include <mariana-trench/ReplaySnapshot.h>
+#include <mariana-trench/Rules.h>
+#include <mariana-trench/Scheduler.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class ReplaySnapshotTest : public test::Test {};
+
+TEST_F(ReplaySnapshotTest, CaptureAndReplay) {
+  Scope scope;
+  redex::create_method(scope, "LCallee;", R"(
+    (method (public static) "LCallee;.source:()Ljava/lang/Object;"
+     (
+      (const v0 0)
+      (return-object v0)
+     )
+    )
+  )");
+  auto* dex_caller = redex::create_method(scope, "LCaller;", R"(
+    (method (public static) "LCaller;.caller:()Ljava/lang/Object;"
+     (
+      (invoke-static () "LCallee;.source:()Ljava/lang/Object;")
+      (move-result-object v0)
+      (return-object v0)
+     )
+    )
+  )");
+
+  DexStore store("test_store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  context.rules = std::make_unique<Rules>();
+  context.class_properties = std::make_unique<ClassProperties>(
+      *context.options,
+      context.stores,
+      *context.features,
+      *context.dependencies);
+  context.scheduler =
+      std::make_unique<Scheduler>(*context.methods, *context.dependencies);
+
+  auto registry = Registry(
+      context,
+      /* models_value */ test::parse_json(R"([
+        {
+          "method": "LCallee;.source:()Ljava/lang/Object;",
+          "generations": [
+            {"port": "Return", "taint": [{"kind": "TestSource"}]}
+          ]
+        }
+      ])"),
+      /* field_models_value */ test::parse_json("[]"));
+  registry.add_default_models();
+
+  auto* caller = context.methods->get(dex_caller);
+  auto model = Model(caller, context);
+  auto expected_model = Interprocedural::analyze(context, registry, model);
+  EXPECT_FALSE(expected_model.generations().is_bottom());
+
+  auto snapshot = ReplaySnapshot::capture(context, registry, model);
+  EXPECT_EQ(
+      snapshot["method"].asString(), "LCaller;.caller:()Ljava/lang/Object;");
+  ASSERT_EQ(snapshot["callee_models"].size(), 1);
+  EXPECT_EQ(
+      snapshot["callee_models"][0]["method"].asString(),
+      "LCallee;.source:()Ljava/lang/Object;");
+
+  // Go through a string, as when the snapshot is written to disk.
+  auto replayed_model = ReplaySnapshot::replay(
+      context,
+      JsonValidation::parse_json(JsonValidation::to_styled_string(snapshot)));
+  EXPECT_EQ(replayed_model, expected_model);
+}
+
+} // namespace marianatrench
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+
+#include <DexStore.h>
+
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/Registry.h>
+#include <mariana-trench/RuleSlice.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class RuleSliceTest : public test::Test {};
+
+TEST_F(RuleSliceTest, CallersOfSinks) {
+  Scope scope;
+
+  auto* dex_sink = redex::create_void_method(scope, "LSink;", "sink");
+  auto* dex_caller = redex::create_method(scope, "LCaller;", R"(
+    (method (public) "LCaller;.caller:()V"
+     (
+      (load-param-object v0)
+      (new-instance "LSink;")
+      (move-result-pseudo-object v1)
+      (invoke-virtual (v1) "LSink;.sink:()V")
+      (return-void)
+     )
+    )
+  )");
+  auto* dex_caller_caller = redex::create_method(scope, "LCallerCaller;", R"(
+    (method (public) "LCallerCaller;.caller_caller:()V"
+     (
+      (load-param-object v0)
+      (new-instance "LCaller;")
+      (move-result-pseudo-object v1)
+      (invoke-virtual (v1) "LCaller;.caller:()V")
+      (return-void)
+     )
+    )
+  )");
+  auto* dex_unrelated =
+      redex::create_void_method(scope, "LUnrelated;", "unrelated");
+
+  DexStore store("store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+
+  auto* sink = context.methods->get(dex_sink);
+  auto* caller = context.methods->get(dex_caller);
+  auto* caller_caller = context.methods->get(dex_caller_caller);
+  auto* unrelated = context.methods->get(dex_unrelated);
+
+  auto registry = Registry(context);
+  registry.set(Model(
+      sink,
+      context,
+      Model::Mode::Normal,
+      /* generations */ {},
+      /* parameter_sources */ {},
+      /* sinks */
+      {{AccessPath(Root(Root::Kind::Argument, 0)),
+        Frame::leaf(context.kinds->get("TestSink"))}}));
+
+  EXPECT_THAT(
+      RuleSlice::slice(context, registry),
+      testing::UnorderedElementsAre(sink, caller, caller_caller));
+
+  EXPECT_EQ(RuleSlice::apply(context, registry), 1);
+  EXPECT_TRUE(registry.get(unrelated).skip_analysis());
+  EXPECT_FALSE(registry.get(caller).skip_analysis());
+  EXPECT_FALSE(registry.get(sink).skip_analysis());
+}
+
+} // namespace marianatrench
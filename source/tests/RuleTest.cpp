@@ -28,6 +28,15 @@ std::vector<int> to_codes(const std::vector<const RuleType*>& rules) {
   return codes;
 }
 
+std::vector<int> to_codes(
+    const std::vector<const Rules::PartialKindRule*>& partial_kind_rules) {
+  std::vector<int> codes;
+  for (const auto* partial_kind_rule : partial_kind_rules) {
+    codes.push_back(partial_kind_rule->rule->code());
+  }
+  return codes;
+}
+
 } // namespace
 
 TEST_F(RuleTest, Rules) {
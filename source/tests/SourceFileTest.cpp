@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+#include <gmock/gmock.h>
+
+#include <mariana-trench/SourceFile.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class SourceFileTest : public test::Test {};
+
+TEST_F(SourceFileTest, Lines) {
+  {
+    auto file = SourceFile("");
+    EXPECT_EQ(file.size(), 0);
+    EXPECT_FALSE(file.has_line_number(1));
+  }
+  {
+    auto file = SourceFile("package com.facebook;\n\nclass Foo {}");
+    EXPECT_EQ(file.size(), 3);
+    EXPECT_FALSE(file.has_line_number(0));
+    EXPECT_EQ(file.line(1), "package com.facebook;");
+    EXPECT_EQ(file.line(2), "");
+    EXPECT_EQ(file.line(3), "class Foo {}");
+    EXPECT_FALSE(file.has_line_number(4));
+  }
+  {
+    // A trailing newline does not start a new line, as with `std::getline`.
+    auto file = SourceFile("a\n\n");
+    EXPECT_EQ(file.size(), 2);
+    EXPECT_EQ(file.line(1), "a");
+    EXPECT_EQ(file.line(2), "");
+  }
+}
+
+TEST_F(SourceFileTest, Open) {
+  auto directory = boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path();
+  boost::filesystem::create_directories(directory);
+
+  auto path = (directory / "Foo.java").string();
+  {
+    std::ofstream stream(path);
+    stream << "package com.facebook;\nclass Foo {\n}\n";
+  }
+  auto file = SourceFile::open(path);
+  ASSERT_NE(file, nullptr);
+  EXPECT_EQ(file->size(), 3);
+  EXPECT_EQ(file->line(1), "package com.facebook;");
+  EXPECT_EQ(file->line(2), "class Foo {");
+  EXPECT_EQ(file->line(3), "}");
+
+  auto empty_path = (directory / "Empty.java").string();
+  { std::ofstream stream(empty_path); }
+  auto empty_file = SourceFile::open(empty_path);
+  ASSERT_NE(empty_file, nullptr);
+  EXPECT_EQ(empty_file->size(), 0);
+
+  EXPECT_EQ(SourceFile::open((directory / "Missing.java").string()), nullptr);
+
+  boost::filesystem::remove_all(directory);
+}
+
+} // namespace marianatrench
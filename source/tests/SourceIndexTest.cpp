@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+#include <gmock/gmock.h>
+
+#include <mariana-trench/SourceIndex.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class SourceIndexTest : public test::Test {};
+
+namespace {
+
+void write_file(const std::string& path, const std::string& content) {
+  std::ofstream stream(path);
+  stream << content;
+}
+
+} // namespace
+
+TEST_F(SourceIndexTest, ReuseEntries) {
+  auto directory = boost::filesystem::temp_directory_path() /
+      boost::filesystem::unique_path();
+  boost::filesystem::create_directories(directory);
+  auto index_path = directory / "index.json";
+  auto foo_path = (directory / "Foo.java").string();
+  auto bar_path = (directory / "Bar.java").string();
+  write_file(foo_path, "class Foo {}\n");
+  write_file(bar_path, "class Bar {}\n");
+
+  std::size_t scanned = 0;
+  auto scanner = [&](const SourceFile& file) {
+    scanned++;
+    return std::vector<std::string>{std::string(file.line(1))};
+  };
+
+  {
+    SourceIndex index("root");
+    index.load(index_path);
+    EXPECT_THAT(
+        index.classes(foo_path, scanner),
+        testing::ElementsAre("class Foo {}"));
+    EXPECT_THAT(
+        index.classes(bar_path, scanner),
+        testing::ElementsAre("class Bar {}"));
+    EXPECT_EQ(index.hits(), 0);
+    EXPECT_EQ(index.misses(), 2);
+    index.save(index_path);
+  }
+  EXPECT_EQ(scanned, 2);
+
+  // Modify one of the files.
+  write_file(bar_path, "class Baz {}\n");
+  boost::filesystem::last_write_time(
+      bar_path, boost::filesystem::last_write_time(bar_path) + 10);
+
+  {
+    SourceIndex index("root");
+    index.load(index_path);
+    EXPECT_THAT(
+        index.classes(foo_path, scanner),
+        testing::ElementsAre("class Foo {}"));
+    EXPECT_THAT(
+        index.classes(bar_path, scanner),
+        testing::ElementsAre("class Baz {}"));
+    EXPECT_EQ(index.hits(), 1);
+    EXPECT_EQ(index.misses(), 1);
+  }
+  EXPECT_EQ(scanned, 3);
+
+  // An index for a different source root is ignored.
+  {
+    SourceIndex index("other_root");
+    index.load(index_path);
+    EXPECT_THAT(
+        index.classes(foo_path, scanner),
+        testing::ElementsAre("class Foo {}"));
+    EXPECT_EQ(index.hits(), 0);
+  }
+  EXPECT_EQ(scanned, 4);
+
+  boost::filesystem::remove_all(directory);
+}
+
+TEST_F(SourceIndexTest, Hash) {
+  EXPECT_EQ(SourceIndex::hash(""), 0xcbf29ce484222325ULL);
+  EXPECT_EQ(SourceIndex::hash("a"), 0xaf63dc4c8601ec8cULL);
+  EXPECT_NE(
+      SourceIndex::hash("class Foo {}"), SourceIndex::hash("class Bar {}"));
+}
+
+} // namespace marianatrench
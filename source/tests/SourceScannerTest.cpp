@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+#include <re2/re2.h>
+
+#include <mariana-trench/SourceScanner.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class SourceScannerTest : public test::Test {};
+
+namespace {
+
+std::optional<std::string> regex_match(
+    const std::string& line,
+    const re2::RE2& regex) {
+  re2::StringPiece match;
+  if (!re2::RE2::PartialMatch(line, regex, &match)) {
+    return std::nullopt;
+  }
+  return match.as_string();
+}
+
+std::optional<std::string> to_string(
+    const std::optional<std::string_view>& value) {
+  if (!value) {
+    return std::nullopt;
+  }
+  return std::string(*value);
+}
+
+} // namespace
+
+TEST_F(SourceScannerTest, Package) {
+  EXPECT_EQ(
+      SourceScanner::package("package com.facebook;"),
+      std::make_optional("com.facebook"));
+  EXPECT_EQ(
+      SourceScanner::package("package com.facebook"),
+      std::make_optional("com.facebook"));
+  EXPECT_EQ(
+      SourceScanner::package("package\tcom.facebook ; // Comment"),
+      std::make_optional("com.facebook "));
+  EXPECT_EQ(SourceScanner::package(" package com.facebook;"), std::nullopt);
+  EXPECT_EQ(SourceScanner::package("packagecom.facebook;"), std::nullopt);
+  EXPECT_EQ(SourceScanner::package("package ;"), std::nullopt);
+  EXPECT_EQ(SourceScanner::package("import com.facebook.Foo;"), std::nullopt);
+}
+
+TEST_F(SourceScannerTest, ClassName) {
+  EXPECT_EQ(
+      SourceScanner::class_name("public class Foo {"),
+      std::make_optional("Foo"));
+  EXPECT_EQ(
+      SourceScanner::class_name("  abstract class Foo<T> {"),
+      std::make_optional("Foo"));
+  EXPECT_EQ(
+      SourceScanner::class_name("internal data class Foo(val x: Int)"),
+      std::make_optional("Foo"));
+  EXPECT_EQ(
+      SourceScanner::class_name("/* Comment */ interface Foo"),
+      std::make_optional("Foo"));
+  EXPECT_EQ(
+      SourceScanner::class_name("object Foo : Bar()"),
+      std::make_optional("Foo"));
+  EXPECT_EQ(
+      SourceScanner::class_name("private enum Foo {"),
+      std::make_optional("Foo"));
+  EXPECT_EQ(SourceScanner::class_name("// class Foo"), std::nullopt);
+  EXPECT_EQ(SourceScanner::class_name("public static class"), std::nullopt);
+  EXPECT_EQ(SourceScanner::class_name("classFoo"), std::nullopt);
+  EXPECT_EQ(SourceScanner::class_name("Foo.class.getName();"), std::nullopt);
+}
+
+TEST_F(SourceScannerTest, VisitCodeLines) {
+  auto visit = [](std::string_view source) {
+    std::vector<std::string> lines;
+    SourceScanner::visit_code_lines(source, [&](std::string_view line) {
+      lines.emplace_back(line);
+      return true;
+    });
+    return lines;
+  };
+
+  EXPECT_THAT(visit(""), testing::ElementsAre());
+  EXPECT_THAT(visit("class Foo"), testing::ElementsAre("class Foo"));
+  EXPECT_THAT(
+      visit("package a;\n\nclass Foo {\n}\n"),
+      testing::ElementsAre("package a;", "", "class Foo {", "}"));
+
+  // Lines starting within a comment are skipped.
+  EXPECT_THAT(
+      visit("/* class A\nclass B */ class C\n// class D */\nclass E"),
+      testing::ElementsAre("/* class A", "// class D */", "class E"));
+  EXPECT_THAT(
+      visit("/** Javadoc\n * class A\n */\nclass B"),
+      testing::ElementsAre("/** Javadoc", "class B"));
+
+  // Comment delimiters within literals are ignored.
+  EXPECT_THAT(
+      visit("String a = \"/* class A\";\nclass B\nchar c = '\"';\nclass C"),
+      testing::ElementsAre(
+          "String a = \"/* class A\";",
+          "class B",
+          "char c = '\"';",
+          "class C"));
+  EXPECT_THAT(
+      visit("String a = \"\\\" /*\";\nchar b = '\\'';\nclass C"),
+      testing::ElementsAre(
+          "String a = \"\\\" /*\";", "char b = '\\'';", "class C"));
+
+  // String literals end at the end of the line, text blocks do not.
+  EXPECT_THAT(
+      visit("String a = \"/*\nclass B"),
+      testing::ElementsAre("String a = \"/*", "class B"));
+  EXPECT_THAT(
+      visit("String a = \"\"\"\nclass B\n\"\"\";\nclass C"),
+      testing::ElementsAre("String a = \"\"\"", "class C"));
+
+  // The visitor can stop the scan.
+  std::size_t visited = 0;
+  SourceScanner::visit_code_lines("a\nb\nc", [&](std::string_view /* line */) {
+    return ++visited < 2;
+  });
+  EXPECT_EQ(visited, 2);
+}
+
+TEST_F(SourceScannerTest, EquivalentToRegex) {
+  re2::RE2 package_regex("^package\\s+([^;]+)(?:;|$)");
+  re2::RE2 class_regex(
+      "^\\s*(?:/\\*.*\\*/)?\\s*(?:public|internal|private)?\\s*(?:abstract|data|final|open)?\\s*(?:class|enum|interface|object)\\s+([A-z0-9]+)");
+
+  std::vector<std::string> lines = {
+      "",
+      "package",
+      "package ",
+      "package  ",
+      "package  ;",
+      "package\t\tcom.facebook;;",
+      "package com.facebook\r",
+      "package com.facebook; class Foo",
+      "class Foo",
+      "classFoo Bar",
+      "class  Foo_Bar$Baz",
+      "publicclass Foo",
+      "public public class Foo",
+      "public final class Foo",
+      "final public class Foo",
+      "internal interface Foo",
+      "interface[Foo]",
+      "open object Foo",
+      "enumeration Foo",
+      "/**/class Foo",
+      "/*/ class Foo",
+      "/* a */ class Foo /* b */ class Bar",
+      "/* a */ class Foo /* b */",
+      "/* a */ /* b */ class Foo",
+      "/* class Foo */",
+      "  /* a */  public   abstract   class   Foo  ",
+      " * class Foo",
+      "\tclass\tFoo",
+      "class",
+      "class ",
+      "class {",
+  };
+
+  for (const auto& line : lines) {
+    EXPECT_EQ(
+        to_string(SourceScanner::package(line)),
+        regex_match(line, package_regex))
+        << "line: `" << line << "`";
+    EXPECT_EQ(
+        to_string(SourceScanner::class_name(line)),
+        regex_match(line, class_regex))
+        << "line: `" << line << "`";
+  }
+}
+
+} // namespace marianatrench
@@ -40,6 +40,20 @@ ContextGuard::~ContextGuard() {
 
 Context make_empty_context() {
   Context context;
+  // Export summaries of models read the options.
+  context.options = std::make_unique<Options>(
+      /* models_paths */ std::vector<std::string>{},
+      /* field_models_path */ std::vector<std::string>{},
+      /* rules_paths */ std::vector<std::string>{},
+      /* lifecycles_paths */ std::vector<std::string>{},
+      /* proguard_configuration_paths */ std::vector<std::string>{},
+      /* sequential */ false,
+      /* skip_source_indexing */ true,
+      /* skip_model_generation */ true,
+      /* model_generators_configuration */
+      std::vector<ModelGeneratorConfiguration>{},
+      /* model_generators_search_path */ std::vector<std::string>{},
+      /* remove_unreachable_code */ false);
   context.methods = std::make_unique<Methods>();
   context.positions = std::make_unique<Positions>();
   return context;
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <gmock/gmock.h>
+
+#include <DexStore.h>
+
+#include <mariana-trench/Redex.h>
+#include <mariana-trench/Registry.h>
+#include <mariana-trench/TrivialMethods.h>
+#include <mariana-trench/tests/Test.h>
+
+namespace marianatrench {
+
+class TrivialMethodsTest : public test::Test {};
+
+TEST_F(TrivialMethodsTest, Getter) {
+  Scope scope;
+  auto* dex_getter = redex::create_method(scope, "LData;", R"(
+    (method (public) "LData;.getValue:()Ljava/lang/String;"
+     (
+      (load-param-object v0)
+      (iget-object v0 "LData;.mValue:Ljava/lang/String;")
+      (move-result-pseudo-object v1)
+      (return-object v1)
+     )
+    )
+  )");
+
+  DexStore store("store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  auto* getter = context.methods->get(dex_getter);
+  auto registry = Registry(context);
+
+  auto model = TrivialMethods::summarize(context, registry, getter);
+  ASSERT_TRUE(model);
+
+  const auto* field = DexString::make_string("mValue");
+  auto input = AccessPath(Root(Root::Kind::Argument, 0), Path{field});
+  EXPECT_EQ(model->inline_as(), AccessPathConstantDomain(input));
+  EXPECT_EQ(
+      model->propagations(),
+      (PropagationAccessPathTree{
+          {/* output */ AccessPath(Root(Root::Kind::Return)),
+           PropagationSet{Propagation(
+               input,
+               /* inferred_features */
+               Frame::artificial_source(input).features(),
+               /* user_features */ FeatureSet::bottom())}},
+      }));
+}
+
+TEST_F(TrivialMethodsTest, Setter) {
+  Scope scope;
+  auto* dex_setter = redex::create_method(scope, "LData;", R"(
+    (method (public) "LData;.setValue:(Ljava/lang/String;)V"
+     (
+      (load-param-object v0)
+      (load-param-object v1)
+      (iput-object v1 v0 "LData;.mValue:Ljava/lang/String;")
+      (return-void)
+     )
+    )
+  )");
+
+  DexStore store("store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  auto* setter = context.methods->get(dex_setter);
+  auto registry = Registry(context);
+
+  auto model = TrivialMethods::summarize(context, registry, setter);
+  ASSERT_TRUE(model);
+
+  const auto* field = DexString::make_string("mValue");
+  auto input = AccessPath(Root(Root::Kind::Argument, 1));
+  EXPECT_TRUE(model->inline_as().is_bottom());
+  EXPECT_EQ(
+      model->propagations(),
+      (PropagationAccessPathTree{
+          {/* output */ AccessPath(Root(Root::Kind::Argument, 0), Path{field}),
+           PropagationSet{Propagation(
+               input,
+               /* inferred_features */
+               Frame::artificial_source(input).features(),
+               /* user_features */ FeatureSet::bottom())}},
+      }));
+}
+
+TEST_F(TrivialMethodsTest, NotTrivial) {
+  Scope scope;
+  auto* dex_callee = redex::create_void_method(scope, "LCallee;", "callee");
+  auto* dex_caller = redex::create_method(scope, "LCaller;", R"(
+    (method (public) "LCaller;.caller:()V"
+     (
+      (load-param-object v0)
+      (new-instance "LCallee;")
+      (move-result-pseudo-object v1)
+      (invoke-virtual (v1) "LCallee;.callee:()V")
+      (return-void)
+     )
+    )
+  )");
+  auto* dex_overwrite = redex::create_method(scope, "LData;", R"(
+    (method (public) "LData;.swap:(Ljava/lang/String;)Ljava/lang/String;"
+     (
+      (load-param-object v0)
+      (load-param-object v1)
+      (iput-object v1 v0 "LData;.mValue:Ljava/lang/String;")
+      (iget-object v0 "LData;.mValue:Ljava/lang/String;")
+      (move-result-pseudo-object v2)
+      (return-object v2)
+     )
+    )
+  )");
+
+  DexStore store("store");
+  store.add_classes(scope);
+  auto context = test::make_context(store);
+  auto registry = Registry(context);
+
+  // The callee itself only returns.
+  EXPECT_TRUE(TrivialMethods::summarize(
+      context, registry, context.methods->get(dex_callee)));
+  EXPECT_FALSE(TrivialMethods::summarize(
+      context, registry, context.methods->get(dex_caller)));
+  EXPECT_FALSE(TrivialMethods::summarize(
+      context, registry, context.methods->get(dex_overwrite)));
+}
+
+} // namespace marianatrench
@@ -18,6 +18,7 @@
 #include <RedexContext.h>
 
 #include <mariana-trench/Dependencies.h>
+#include <mariana-trench/JsonValidation.h>
 #include <mariana-trench/Redex.h>
 #include <mariana-trench/tests/Test.h>
 
@@ -302,3 +303,67 @@ TEST_F(TypesTest, GlobalInvokeVirtualTypes) {
       entry_register_types.at(1),
       DexType::make_type(DexString::make_string("LCaller;")));
 }
+
+TEST_F(TypesTest, Snapshot) {
+  Scope scope;
+
+  auto* dex_method = redex::create_method(scope, "LClass;", R"(
+    (method (public) "LClass;.foo:()V"
+     (
+      (new-instance "Ljava/lang/Object;")
+      (move-result-pseudo-object v0)
+
+      (load-param v1)
+      (iput-object v1 v0 "LClass;.field:Ljava/lang/Object;")
+
+      (return-void)
+     )
+    )
+  )");
+
+  auto context = test_types(scope);
+  auto* method = context.methods->get(dex_method);
+  auto register_types = register_types_for_method(context, method);
+  auto snapshot = context.types->to_json(*context.methods);
+
+  context.types =
+      std::make_unique<Types>(*context.methods, context.stores, snapshot);
+  EXPECT_EQ(register_types_for_method(context, method), register_types);
+  EXPECT_EQ(context.types->to_json(*context.methods), snapshot);
+
+  // Methods created after the snapshot, such as life-cycle methods, are not
+  // part of it and their types are inferred on demand.
+  auto* dex_synthetic = redex::create_method(scope, "LSynthetic;", R"(
+    (method (public) "LSynthetic;.bar:()V"
+     (
+      (new-instance "Ljava/lang/Object;")
+      (move-result-pseudo-object v0)
+
+      (load-param v1)
+      (iput-object v1 v0 "LSynthetic;.field:Ljava/lang/Object;")
+
+      (return-void)
+     )
+    )
+  )");
+  dex_synthetic->get_code()->build_cfg();
+  auto* synthetic = context.methods->create(dex_synthetic);
+  EXPECT_EQ(
+      register_types_for_method(context, synthetic).at(0),
+      DexType::make_type(DexString::make_string("Ljava/lang/Object;")));
+
+  // A stale snapshot is rejected as a whole.
+  auto missing_method = snapshot;
+  missing_method.removeMember(method->show());
+  EXPECT_THROW(
+      std::make_unique<Types>(
+          *context.methods, context.stores, missing_method),
+      JsonValidationError);
+
+  auto mismatched_instruction = snapshot;
+  mismatched_instruction[method->show()][0]["opcode"] = Json::Value(-1);
+  EXPECT_THROW(
+      std::make_unique<Types>(
+          *context.methods, context.stores, mismatched_instruction),
+      JsonValidationError);
+}